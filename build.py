@@ -301,6 +301,7 @@ class WindowsProject(Project):
         shutil.copy(f"{self.dir_name}/{release_config}/{game_name}.pdb", appdir)
         shutil.copy(f"{self.dir_name}/{release_config}/SDL3.dll", appdir)
         shutil.copytree("Data", f"{appdir}/Data")
+        call([sys.executable, "packaging/make_data_pack.py", "--remove-packed", f"{appdir}/Data"])
         for dll in windows_dlls:
             shutil.copy(f"{cache_dir}/install/bin/{dll}", appdir)
 
@@ -413,6 +414,7 @@ class LinuxProject(Project):
         # Copy executable and assets
         shutil.copy(f"{self.dir_name}/{game_name}", f"{appdir}/usr/bin")  # executable
         shutil.copytree("Data", f"{appdir}/Data")
+        call([sys.executable, "packaging/make_data_pack.py", "--remove-packed", f"{appdir}/Data"])
         self.copy_documentation(appdir, everything=False)
 
         # Copy XDG stuff
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+
+"""
+Builds Data.pack, the packed asset archive that the game reads before falling back
+to the loose files in the Data folder (see src/System/Pack.c).
+
+Usage: make_data_pack.py [--no-compress] [--remove-packed] DATA_DIR
+
+Only file types that the game reads through the pack are packed (see PACKED_GLOBS).
+By default, loose files stay in place so a dev tree keeps working without the pack;
+if you edit one, rebuild the pack or delete it, otherwise the game keeps using the packed copy.
+--remove-packed deletes the loose copies of the packed files (and any folders left empty),
+so that shipped builds don't carry every packed file twice. Only use it on a copy of the Data folder.
+"""
+
+import argparse
+import glob
+import os
+import struct
+import sys
+
+PACK_MAGIC = b"BPak"
+PACK_FORMAT_VERSION = 1     # must match PACK_FORMAT_VERSION in Pack.c
+PACK_MAX_PATH = 64
+PACK_ALIGNMENT = 16
+PACK_FLAG_LZ4 = 1 << 0
+
+HEADER_FORMAT = "<4sIII"
+ENTRY_FORMAT = f"<{PACK_MAX_PATH}sQIIII"
+
+PACKED_GLOBS = [
+    "Images/**/*.tga",
+]
+
+#----------------------------------------------------------------
+# LZ4 block compressor (greedy, single-entry hash table)
+
+LZ4_MIN_MATCH = 4
+LZ4_MFLIMIT = 12            # last match must start at least this many bytes before the end of the block
+LZ4_LAST_LITERALS = 5       # last bytes of the block are always literals
+LZ4_MAX_OFFSET = 65535
+
+def lz4_write_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+def lz4_write_sequence(out, literals, offset, match_length):
+    lit_len = len(literals)
+    token = min(lit_len, 15) << 4
+    if match_length:
+        token |= min(match_length - LZ4_MIN_MATCH, 15)
+    out.append(token)
+    if lit_len >= 15:
+        lz4_write_length(out, lit_len - 15)
+    out += literals
+    if match_length:
+        out += struct.pack("<H", offset)
+        if match_length - LZ4_MIN_MATCH >= 15:
+            lz4_write_length(out, match_length - LZ4_MIN_MATCH - 15)
+
+def lz4_compress(src):
+    n = len(src)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    i = 0
+
+    while i + LZ4_MFLIMIT <= n:
+        key = src[i : i + LZ4_MIN_MATCH]
+        candidate = table.get(key)
+        table[key] = i
+
+        if candidate is None or i - candidate > LZ4_MAX_OFFSET:
+            i += 1
+            continue
+
+        match_length = LZ4_MIN_MATCH
+        while i + match_length < n - LZ4_LAST_LITERALS and src[candidate + match_length] == src[i + match_length]:
+            match_length += 1
+
+        lz4_write_sequence(out, src[anchor:i], i - candidate, match_length)
+        i += match_length
+        anchor = i
+
+    lz4_write_sequence(out, src[anchor:], 0, 0)
+    return bytes(out)
+
+#----------------------------------------------------------------
+
+def remove_packed_files(data_dir, paths):
+    dirs = set()
+    for path in paths:
+        os.remove(os.path.join(data_dir, path))
+        dirs.add(os.path.dirname(path))
+
+    # Prune folders that are now empty, deepest first
+    for d in sorted(dirs, key=lambda d: d.count(os.sep), reverse=True):
+        while d:
+            full = os.path.join(data_dir, d)
+            if not os.path.isdir(full) or os.listdir(full):
+                break
+            os.rmdir(full)
+            d = os.path.dirname(d)
+
+    print(f"Removed {len(paths)} loose files that are now in the pack")
+
+def make_pack(data_dir, compress=True, remove_packed=False):
+    paths = set()
+    for pattern in PACKED_GLOBS:
+        paths.update(glob.glob(pattern, root_dir=data_dir, recursive=True))
+
+    # Mac-style path relative to the Data folder, as passed to FSMakeFSSpec by the game
+    entries = []
+    for path in paths:
+        mac_path = ":" + path.replace(os.sep, ":").replace("/", ":")
+        encoded = mac_path.encode("ascii")
+        if len(encoded) >= PACK_MAX_PATH:
+            sys.exit(f"Path too long for the pack: {mac_path}")
+        entries.append((encoded, path))
+
+    # The game does a case-insensitive binary search in the index
+    entries.sort(key=lambda e: e[0].lower())
+
+    data_offset = struct.calcsize(HEADER_FORMAT) + len(entries) * struct.calcsize(ENTRY_FORMAT)
+    index = bytearray()
+    blob = bytearray()
+
+    for mac_path, path in entries:
+        with open(os.path.join(data_dir, path), "rb") as f:
+            raw = f.read()
+
+        stored = raw
+        flags = 0
+        if compress:
+            packed = lz4_compress(raw)
+            if len(packed) < len(raw):
+                stored = packed
+                flags |= PACK_FLAG_LZ4
+
+        padding = -(data_offset + len(blob)) % PACK_ALIGNMENT
+        blob += b"\0" * padding
+
+        index += struct.pack(ENTRY_FORMAT, mac_path, data_offset + len(blob), len(raw), len(stored), flags, 0)
+        blob += stored
+
+    pack_path = os.path.join(data_dir, "Data.pack")
+    with open(pack_path, "wb") as f:
+        f.write(struct.pack(HEADER_FORMAT, PACK_MAGIC, PACK_FORMAT_VERSION, len(entries), 0))
+        f.write(index)
+        f.write(blob)
+
+    print(f"Wrote {pack_path}: {len(entries)} files, {os.path.getsize(pack_path)} bytes")
+
+    if remove_packed:
+        remove_packed_files(data_dir, [path for _, path in entries])
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Build the packed asset archive for Bugdom")
+    parser.add_argument("data_dir", help="path to the game's Data folder")
+    parser.add_argument("--no-compress", action="store_true", help="store files without LZ4 compression")
+    parser.add_argument("--remove-packed", action="store_true", help="delete the loose copies of the packed files (for packaged builds only)")
+    args = parser.parse_args()
+
+    make_pack(args.data_dir, compress=not args.no_compress, remove_packed=args.remove_packed)
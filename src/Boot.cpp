@@ -152,6 +152,12 @@ retryVideo:
 	// Find path to game data folder
 	fs::path dataPath = FindGameData(executablePath);
 
+	// Open packed asset archive, if any
+	{
+		auto packPath8 = (dataPath / "Data.pack").u8string();
+		Pack_Open((const char*)packPath8.c_str());
+	}
+
 	// Init joystick subsystem
 	{
 		SDL_Init(SDL_INIT_GAMEPAD);
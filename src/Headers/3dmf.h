@@ -4,5 +4,8 @@
 
 extern	void Init3DMFManager(void);
 extern	void LoadGrouped3DMF(FSSpec *spec, Byte groupNum);
+Job* QueueGrouped3DMFLoad(const FSSpec *spec, Byte groupNum);
 extern	void Free3DMFGroup(Byte groupNum);
 extern	void DeleteAll3DMFGroups(void);
+TQ3MetaFile* Load3DMFWithFlatCache(const FSSpec* spec, Ptr* outFlatPayload);
+void Dispose3DMFWithFlatCache(TQ3MetaFile* metaFile, Ptr flatPayload);
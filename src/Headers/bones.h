@@ -5,7 +5,8 @@
 
 
 
-extern	void LoadBonesReferenceModel(const FSSpec	*inSpec, SkeletonDefType *skeleton);
+extern	void LoadBonesReferenceModel(const FSSpec	*inSpec, SkeletonDefType *skeleton, Boolean decompose);
+extern	void UploadBonesReferenceModelTextures(SkeletonDefType *skeleton, Boolean forceClampUVs);
 extern	void UpdateSkinnedGeometry(ObjNode *theNode);
 extern	void PrimeBoneData(SkeletonDefType *skeleton);
 
@@ -0,0 +1,30 @@
+#pragma once
+
+// Best-effort on-disk cache for data that is expensive to rebuild from the game's source files.
+// Cache files live in the prefs folder. Each one is tagged with a payload version and with
+// the hashes of the source files it was built from; it is ignored if either doesn't match.
+
+#define CACHE_MAX_SOURCE_HASHES 4
+
+// Hashes the contents of a file's data fork (or its resource fork).
+// Returns 0 if the file can't be read.
+uint64_t Cache_HashFile(const FSSpec* spec, bool resourceFork);
+
+// Cheap stand-in for Cache_HashFile: hashes the file's size and a few small blocks sampled from it.
+// Use it for big sources where reading the whole file would cost about as much as rebuilding from it.
+// Edits that keep the file size and miss the sampled blocks go unnoticed.
+// Returns 0 if the file can't be read.
+uint64_t Cache_StampFile(const FSSpec* spec, bool resourceFork);
+
+// Reads a cache file's payload in a single block.
+// Returns nil if the cache file is missing, corrupt, or stale.
+// The caller owns the returned pointer (dispose with DisposePtr).
+Ptr Cache_Load(const char* name, uint32_t payloadVersion, const uint64_t* sourceHashes, int numSourceHashes, long* outPayloadSize);
+
+// Like Cache_Load, but reads the payload straight into a new Handle that the caller can keep as is.
+// The first prefixSize bytes of the payload (a multiple of 8) go to outPrefix instead.
+// Returns nil if the cache file is missing, corrupt, or stale.
+Handle Cache_LoadHandle(const char* name, uint32_t payloadVersion, const uint64_t* sourceHashes, int numSourceHashes, void* outPrefix, long prefixSize);
+
+// Writes a cache file. Failures are silent: the data will simply be rebuilt next time.
+void Cache_Save(const char* name, uint32_t payloadVersion, const uint64_t* sourceHashes, int numSourceHashes, const void* payload, long payloadSize);
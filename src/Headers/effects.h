@@ -32,8 +32,21 @@ enum
 };
 
 
+enum
+{
+	EFFECT_POOL_RIPPLE,
+	EFFECT_POOL_SHOCKWAVE,
+	NUM_EFFECT_POOLS
+};
+
+
 #define	FULL_ALPHA	1.0f
 
+void InitEffectPools(void);
+void DisposeEffectPools(void);
+ObjNode *MakePooledEffect(int kind, NewObjectDefinitionType *newObjDef);
+void ReleasePooledEffect(int kind, ObjNode *theNode);
+
 ObjNode *MakeRipple(float x, float y, float z, float startScale);
 
 void InitParticleSystem(void);
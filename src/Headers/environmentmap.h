@@ -2,5 +2,5 @@
 // environmentmap.h
 //
 
-void EnvironmentMapTriMesh(const TQ3TriMeshData *triMeshDataPtr, const TQ3Matrix4x4* transform);
+const TQ3Param2D* EnvironmentMapTriMesh(const TQ3TriMeshData *triMeshDataPtr, const TQ3Matrix4x4* transform);
 
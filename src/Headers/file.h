@@ -82,6 +82,8 @@ extern	OSErr DeleteSavedGame(int slot);
 void LoadPlayfield(FSSpec *specPtr);
 
 void LoadLevelArt(void);
+void StartPreloadingLevelArt(void);
+Boolean IsPreloadingLevelArt(void);
 
 
 
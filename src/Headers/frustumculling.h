@@ -15,3 +15,5 @@ void UpdateFrustumPlanes(const struct TQ3Matrix4x4* worldToFrustum);
 bool IsSphereInFrustum_XZ(const TQ3Point3D* sphereWorldOrigin, float sphereRadius);
 
 bool IsSphereInFrustum_XYZ(const TQ3Point3D* sphereWorldOrigin, float sphereRadius);
+
+bool IsSphereBeyondNearPlaneDepth(const TQ3Point3D* sphereWorldOrigin, float sphereRadius, float depth);
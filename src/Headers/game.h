@@ -16,6 +16,7 @@ extern "C"
 
 #include "version.h"
 #include "pool.h"
+#include "jobs.h"
 #include "globals.h"
 #include "renderer.h"
 #include "structs.h"
@@ -60,12 +61,13 @@ extern "C"
 #include "mousesmoothing.h"
 #include "frustumculling.h"
 #include "structformats.h"
+#include "cache.h"
+#include "pack.h"
 
 extern	Boolean						gAreaCompleted;
 extern	Boolean						gBatExists;
 extern	Boolean						gDetonatorBlown[];
 extern	Boolean						gDisableAnimSounds;
-extern	Boolean						gDisableHiccupTimer;
 extern	Boolean						gDoAutoFade;
 extern	Boolean						gDoCeiling;
 extern	Boolean						gDrawLensFlare;
@@ -79,6 +81,7 @@ extern	Boolean						gPlayerCanMove;
 extern	Boolean						gPlayerGotKilledFlag;
 extern	Boolean						gPlayerKnockOnButt;
 extern	Boolean						gPlayerUsingKeyControl;
+extern	Boolean						gPrimingTerrain;
 extern	Boolean						gRestoringSavedGame;
 extern	Boolean						gSongPlayingFlag;
 extern	Boolean						gSuperTileMemoryListExists;
@@ -124,7 +127,6 @@ extern	TQ3Matrix4x4				gCameraWorldToFrustumMatrix;
 extern	TQ3Matrix4x4				gCameraWorldToViewMatrix;
 extern	TQ3Matrix4x4				gWindowToFrustum;
 extern	TQ3Matrix4x4				gWindowToFrustumCorrectAspect;
-extern	TQ3Param2D					gEnvMapUVs[];
 extern	TQ3Point3D					gCoord;
 extern	TQ3Point3D					gMostRecentCheckPointCoord;
 extern	TQ3Point3D					gMyCoord;
@@ -151,6 +153,7 @@ extern	const float					gLiquidCollisionTopOffset[NUM_LIQUID_TYPES];
 extern	float						gAutoFadeStartDist;
 extern	float						gBallTimer;
 extern	float						gCheckPointRot;
+extern	float						gCurrentYon;
 extern	float						gCycScale;
 extern	float						gFramesPerSecond;
 extern	float						gFramesPerSecondFrac;
@@ -0,0 +1,49 @@
+#pragma once
+
+// Runs batches of loading jobs on a pool of worker threads.
+// Each job has an optional work proc, which runs on a worker thread,
+// and an optional finish proc, which runs on the main thread once the work is done
+// (use it for anything that touches OpenGL or game state shared with the main thread).
+
+typedef struct Job Job;
+typedef void (*JobProc)(void* userData);
+
+#define MAX_JOB_DEPENDENCIES 4
+
+// Creates the locks. Call once at boot, from the main thread.
+void Jobs_Init(void);
+
+// Queues up a job. It won't start until all of its dependencies are finished
+// (i.e. their finish procs have returned). Main thread only.
+Job* Jobs_Add(JobProc workProc, JobProc finishProc, void* userData, int numDependencies, Job* const* dependencies);
+
+// Starts running the queued jobs in the background and returns right away. Main thread only.
+void Jobs_Start(void);
+
+// Runs the finish procs of any jobs whose work is done, for up to timeBudgetMS.
+// Call once per frame after Jobs_Start. Main thread only.
+void Jobs_Pump(float timeBudgetMS);
+
+// Blocks until all the jobs started by Jobs_Start are finished. Main thread only.
+void Jobs_WaitAll(void);
+
+// Skips the jobs that haven't started yet and waits for the others to finish.
+// Call before tearing down anything the jobs touch (e.g. when quitting mid-preload). Main thread only.
+void Jobs_Cancel(void);
+
+// Same as Jobs_Start followed by Jobs_WaitAll.
+void Jobs_RunAll(void);
+
+// Returns true from Jobs_Start until all jobs are finished.
+bool Jobs_IsRunning(void);
+
+// Pomme's file & resource managers aren't thread-safe.
+// Wrap any file access that may run on a worker thread with these. The lock is recursive.
+void Jobs_LockFiles(void);
+void Jobs_UnlockFiles(void);
+
+// Called by DoAlert & DoFatalAlert. On a worker thread, stores the message in the current job so that
+// the main thread shows it before running the job's finish proc (SDL video calls must stay on the main thread),
+// and returns true. A fatal alert abandons the work proc and doesn't return.
+// Returns false on the main thread, where the caller should show the alert itself.
+bool Jobs_ReportAlert(const char* message, bool fatal);
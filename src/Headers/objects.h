@@ -57,6 +57,8 @@ extern	void CreateBaseGroup(ObjNode *theNode);
 extern	void UpdateObjectTransforms(ObjNode *theNode);
 extern	void MakeObjectTransparent(ObjNode *theNode, float transPercent);
 void AttachObject(ObjNode *theNode);
+void ParkDisplayGroupObject(ObjNode *theNode);
+ObjNode *ReviveDisplayGroupObject(ObjNode *theNode, NewObjectDefinitionType *newObjDef);
 
 extern	void MoveStaticObject(ObjNode *theNode);
 
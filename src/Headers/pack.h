@@ -0,0 +1,18 @@
+#pragma once
+
+// Packed asset archive (Data/Data.pack).
+// Lets the game read many small data files out of a single file, with one lookup
+// in a sorted index instead of a path lookup + open/close per file.
+// Files that aren't in the pack (or if there's no pack at all) are read from the Data folder as usual.
+// Build the pack with packaging/make_data_pack.py.
+
+// Opens the pack at the given host path and reads in its index. Silently does nothing if there's no pack.
+void Pack_Open(const char* hostPath);
+
+// Returns true if the pack has a file at this path (relative to the Data folder, e.g. ":Images:Textures:1000.tga").
+bool Pack_HasFile(const char* path);
+
+// Reads (and decompresses) a file out of the pack in a single block.
+// Returns nil if the file isn't in the pack.
+// The caller owns the returned pointer (dispose with DisposePtr).
+Ptr Pack_LoadFile(const char* path, long* outSize);
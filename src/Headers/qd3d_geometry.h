@@ -12,7 +12,7 @@ enum
 	SHARD_MODE_NULLSHADER		= (1 << 3)
 };
 
-#define	MAX_SHARDS			80
+#define	MAX_SHARDS			400
 
 typedef struct
 {
@@ -20,8 +20,14 @@ typedef struct
 	TQ3Point3D				coord,coordDelta;
 	float					decaySpeed,scale;
 	Byte					mode;
+	bool					isTranslucent;
 	TQ3Matrix4x4			matrix;
-	TQ3TriMeshData			*mesh;
+	TQ3TexturingMode		texturingMode;
+	uint32_t				glTextureName;
+	TQ3Point3D				points[3];				// local coords around shard center
+	TQ3Vector3D				normals[3];
+	TQ3Param2D				uvs[3];
+	TQ3ColorRGBA			colors[3];				// per-vertex colors, or the source mesh's diffuse color
 }ShardType;
 
 void QD3D_CalcObjectBoundingBox(int numMeshes, TQ3TriMeshData** meshList, TQ3BoundingBox* boundingBox);
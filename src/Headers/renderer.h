@@ -23,6 +23,20 @@ typedef struct RenderStats
 	int			meshesPass2;
 } RenderStats;
 
+// Static geometry uploaded to GPU memory once.
+// Meshes drawn with a RenderVertexBuffer must be views into the backing mesh,
+// i.e. their array pointers must point somewhere inside the backing mesh's arrays.
+typedef struct RenderVertexBuffer
+{
+	const TQ3TriMeshData*	backingMesh;		// client-side copy of the geometry (must outlive the buffer)
+	GLuint					bufferName;			// vertex arrays; 0 if VBOs are unsupported (client arrays are used instead)
+	GLuint					indexBufferName;	// triangle indices; 0 if VBOs are unsupported
+	size_t					pointsOffset;
+	size_t					normalsOffset;
+	size_t					uvsOffset;
+	size_t					colorsOffset;
+} RenderVertexBuffer;
+
 typedef struct RenderModifiers
 {
 	// Copy of the status bits from ObjNode.
@@ -41,6 +55,14 @@ typedef struct RenderModifiers
 	// Note that opaque meshes within the same draw order group are drawn front-to-back,
 	// and transparent meshes are drawn back-to-front.
 	int						drawOrder;
+
+	// If non-NULL, meshes submitted with these modifiers are views into this buffer's backing mesh,
+	// and their geometry is sourced from GPU memory.
+	const RenderVertexBuffer*	vertexBuffer;
+
+	// Offset added to the mesh's UVs by the texture matrix.
+	// Lets static meshes scroll their textures without touching their vertex data.
+	TQ3Param2D				uvOffset;
 } RenderModifiers;
 
 enum
@@ -103,11 +125,24 @@ void Render_EnableFog(
 
 void Render_DisableFog(void);
 
+// Moves the fog planes of the current fog (e.g. after the camera's yon changed).
+void Render_SetFogRange(float camYon, float fogHither, float fogYon);
+
+// Returns the eye-space depth beyond which everything is fully fogged, or 0 if there's no fog.
+float Render_GetFogEndDistance(void);
+
+// Returns true if the scene has fog and its color is the clear color,
+// i.e. fully fogged geometry can't be told apart from an empty background.
+bool Render_FogMatchesClearColor(void);
+
 #pragma mark -
 
+// Binds a texture for drawing. Sends the texture's pending uploads to the GPU first.
 void Render_BindTexture(GLuint textureName);
 
 // Wrapper for glTexImage that takes care of all the boilerplate associated with texture creation.
+// The pixels are copied into the upload queue, so the caller may free them right away.
+// Pass NULL pixels to allocate the texture without initializing it.
 // Returns an OpenGL texture name.
 // Aborts the game on failure.
 GLuint Render_LoadTexture(
@@ -120,7 +155,9 @@ GLuint Render_LoadTexture(
 		RendererTextureFlags flags
 );
 
-void Render_UpdateTexture(
+// Queues new pixels for a region of a texture. The pixels are copied, so the caller may reuse them right away.
+// Returns a ticket for Render_IsTextureUploadDone.
+uint32_t Render_UpdateTexture(
 		GLuint textureName,
 		int x,
 		int y,
@@ -132,6 +169,21 @@ void Render_UpdateTexture(
 		int rowBytesInInput
 );
 
+// Returns true once the upload with the given ticket has been sent to the GPU.
+bool Render_IsTextureUploadDone(uint32_t ticket);
+
+// Sends every queued texture upload to the GPU now, regardless of the per-frame budget.
+void Render_FlushAllTextureUploads(void);
+
+// Wrapper for glDeleteTextures that also cancels the textures' pending uploads.
+void Render_DeleteTextures(int numTextures, const GLuint* textureNames);
+
+// Uploads the arrays of a mesh to GPU memory once. The mesh must not change afterwards.
+// If VBOs are unsupported, the returned buffer simply refers to the mesh's client-side arrays.
+RenderVertexBuffer* Render_NewVertexBuffer(const TQ3TriMeshData* backingMesh);
+
+void Render_DisposeVertexBuffer(RenderVertexBuffer* vb);
+
 // Uploads all textures from a 3DMF file to the GPU.
 // Requires an OpenGL context to be active.
 // outTextureNames is an array with enough capacity to hold `metaFile->numTextures` texture names.
@@ -44,6 +44,7 @@ extern	ObjNode	*MakeNewSkeletonObject(NewObjectDefinitionType *newObjDef);
 extern	void AllocSkeletonDefinitionMemory(SkeletonDefType *skeleton);
 extern	void InitSkeletonManager(void);
 extern	void LoadASkeleton(Byte num);
+Job* QueueSkeletonLoad(Byte num);
 extern	void FreeSkeletonFile(Byte skeletonType);
 extern	void FreeAllSkeletonFiles(short skipMe);
 extern	void FreeSkeletonBaseData(SkeletonObjDataType *data);
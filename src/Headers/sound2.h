@@ -118,8 +118,11 @@ extern void	DoSoundMaintenance(void);
 void LoadSoundEffect(int effectNum);
 void DisposeSoundEffect(int effectNum);
 void LoadSoundBank(int bankNum);
+void QueueSoundBankLoad(int bankNum);
 void DisposeSoundBank(int bankNum);
 void DisposeAllSoundBanks(void);
+void PurgeSoundCache(void);
+void LogSoundCacheStats(void);
 void PauseAllChannels(Boolean pause);
 short PlayEffect_Parms(int effectNum, u_long leftVolume, u_long rightVolume, unsigned long rateMultiplier);
 void ChangeChannelVolume(short channel, float leftVol, float rightVol);
@@ -170,6 +170,7 @@ typedef struct
 	TQ3Vector3D			*decomposedNormalsList;			// array of shared normals
 
 	TQ3MetaFile			*associated3DMF;				// associated 3DMF file
+	Ptr					associated3DMFFlatData;			// flat model backing the 3DMF's arrays (nil if the 3DMF was parsed)
 
 	long				numTextures;
 	GLuint				*textureNames;
@@ -333,4 +334,5 @@ typedef struct
 	Byte	antialiasingLevel;
 	Boolean appleKeyboardControls;
 	Byte	displayNumMinus1;
+	Byte	viewDistance;
 }PrefsType;
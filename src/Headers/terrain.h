@@ -19,6 +19,16 @@ enum
 	CEILING = 1
 };
 
+		/* VIEW DISTANCE PREF */
+
+enum
+{
+	VIEW_DISTANCE_NORMAL,				// original game's active ranges
+	VIEW_DISTANCE_FAR,
+	VIEW_DISTANCE_VERYFAR,
+	NUM_VIEW_DISTANCES
+};
+
 		/* SUPER TILE MODES */
 
 enum
@@ -72,15 +82,19 @@ enum
 
 #define	TERRAIN_SUPERTILE_UNIT_SIZE	(SUPERTILE_SIZE*TERRAIN_POLYGON_SIZE)		// world unit size of a supertile
 
-#define	MAX_SUPERTILE_ACTIVE_RANGE	5					// max value of gSuperTileActiveRange
+#define	MIN_SUPERTILE_ACTIVE_RANGE	3					// min value of gSuperTileActiveRange when shrinking to fit the memory budget
+#define	MAX_SUPERTILE_ACTIVE_RANGE	12					// max value of gSuperTileActiveRange
 // The largest map in the game (Night.ter) is 50x40 supertiles == 2000 supertiles.
 // Therefore, the maximum useful value for MAX_SUPERTILE_ACTIVE_RANGE is 23 (because (23*2)**2 == 2116 supertiles)
 
+#define	TERRAIN_MEMORY_BUDGET_HIGH	(128 * 1024 * 1024)		// max bytes of terrain textures & geometry (CPU + GPU)
+#define	TERRAIN_MEMORY_BUDGET_LOW	(32 * 1024 * 1024)		// same, in low-detail mode
+
 #define SUPERTILE_ACTIVE_RANGE	gSuperTileActiveRange
 
 #define	SUPERTILE_DIST_WIDE		(SUPERTILE_ACTIVE_RANGE*2)
 #define	SUPERTILE_DIST_DEEP		(SUPERTILE_ACTIVE_RANGE*2)
-#define	MAX_SUPERTILES			(MAX_SUPERTILE_ACTIVE_RANGE*2 * MAX_SUPERTILE_ACTIVE_RANGE*2)
+#define	SUPERTILE_PREFETCH_MARGIN	1					// extra row & col of supertiles that may be built ahead of the active area
 
 
 #define	MAX_TERRAIN_TILES		((300*3)+1)										// 10x15 * 3pages + 1 blank/black
@@ -101,7 +115,7 @@ struct SuperTileMemoryType
 {
 	Byte				mode;									// free, used, etc.
 	Byte				hasLOD[MAX_LODS];						// flag set when LOD exists
-	Byte				hiccupTimer;							// timer to delay drawing to avoid hiccup of texture upload
+	uint32_t			textureUploadTicket;					// LOD 0 isn't drawn until this texture upload is sent to the GPU
 	TQ3Point3D			coord[MAX_LAYERS];						// world coords of supertile center (y for floor & ceiling)
 	long				left,back;								// integer coords of back/left corner
 	uint32_t			glTextureName[MAX_LAYERS][MAX_LODS];	// OpenGL texture name for floor & ceiling at all LODs
@@ -111,6 +125,21 @@ struct SuperTileMemoryType
 };
 typedef struct SuperTileMemoryType SuperTileMemoryType;
 
+
+		/* STATIC SUPERTILE GEOMETRY */
+		//
+		// Built once per level for every supertile in the map.
+		// The trimeshes are views into a single level-wide mesh that is uploaded to the GPU as a whole,
+		// so they don't own their arrays.
+		//
+
+typedef struct
+{
+	TQ3TriMeshData		mesh[MAX_LAYERS];						// view into the level's terrain geometry (floor & ceiling)
+	TQ3Point3D			coord[MAX_LAYERS];						// world coords of supertile center (floor & ceiling)
+	float				radius[MAX_LAYERS];						// radius of bounding sphere (floor & ceiling)
+} SuperTileGeometryType;
+
 #define	TILENUM_MASK		0x0fff					// b0000111111111111 = mask to filter out tile #
 #define	TILE_FLIPX_MASK		(1<<15)
 #define	TILE_FLIPY_MASK		(1<<14)
@@ -158,6 +187,8 @@ typedef struct
 
 void CreateSuperTileMemoryList(void);
 void DisposeSuperTileMemoryList(void);
+void SetSuperTileActiveRange(int range);
+void GetViewForSuperTileActiveRange(int range, float* yon, float* cycScale);
 extern 	void DisposeTerrain(void);
 extern	void DrawTerrain(const QD3DSetupOutputType *setupInfo);
 extern	void GetSuperTileInfo(long x, long z, long *superCol, long *superRow, long *tileCol, long *tileRow);
@@ -28,4 +28,5 @@ void TextMesh_Shutdown(void);
 void TextMesh_FillDef(TextMeshDef* def);
 TQ3TriMeshData* TextMesh_CreateMesh(const TextMeshDef* def, const char* text);
 TQ3TriMeshData* TextMesh_SetMesh(const TextMeshDef* def, const char* text, TQ3TriMeshData* recycleMesh);
+TQ3TriMeshData* TextMesh_UpdateMesh(const TextMeshDef* def, const char* text, const char* previousText, TQ3TriMeshData* mesh);
 ObjNode* TextMesh_Create(const TextMeshDef* def, const char* text);
@@ -31,3 +31,10 @@ enum
 };
 
 OSErr ReadTGA(const FSSpec* spec, uint8_t** outPtr, TGAHeader* outHeader, bool forceRGBA);
+
+// Reads a TGA from the asset pack, or from the Data folder if it's not in the pack.
+// The path is relative to the Data folder (e.g. ":Images:Textures:1000.tga").
+OSErr ReadDataTGA(const char* path, uint8_t** outPtr, TGAHeader* outHeader, bool forceRGBA);
+
+// Debug: times the decoding of every TGA in Data/Images and logs the results.
+void BenchmarkTGADecoding(void);
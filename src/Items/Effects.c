@@ -27,16 +27,29 @@ static void MoveRipple(ObjNode *theNode);
 /****************************/
 
 #define	MAX_PARTICLE_GROUPS		50
-#define	MAX_PARTICLES			200		// (note change Byte below if > 255)
+#define	MAX_PARKED_EFFECTS		32		// per effect pool
+#define	MAX_PARTICLES			400		// per group
 #define	NUM_PARTICLE_TEXTURES	8
 
-_Static_assert(MAX_PARTICLES <= 255, "rewrite ParticleGroupType to support > 255 particles");
+#define	GRAVITOID_EXACT_MAX		64		// gravitoid groups up to this size get exact pairwise attraction
+#define	GRAVITOID_LEAF_SIZE		8		// octree nodes holding at most this many particles aren't split further
+#define	GRAVITOID_MAX_DEPTH		8		// stops splitting particles that sit on the same spot
+#define	GRAVITOID_THETA			0.6f	// opening angle: nodes smaller than this relative to their distance pull as one mass
+#define	GRAVITOID_MAX_NODES		(MAX_PARTICLES * (GRAVITOID_MAX_DEPTH + 1))		// each depth level holds at most one node per particle
+#define	GRAVITOID_STACK_SIZE	(7 * GRAVITOID_MAX_DEPTH + 8)
+
 _Static_assert(MAX_PARTICLE_GROUPS <= 255, "particle group IDs currently assume the group index will fit in 8 bits");
 
+		/* PARTICLE GROUP */
+		//
+		// Particles are stored densely (structure of arrays) so that live particles
+		// are always in [0, numParticles). Dead particles are swap-removed.
+		//
+
 typedef struct
 {
 	int32_t			magicNum;
-	Pool			*pool;
+	int				numParticles;
 	Byte			type;
 	uint8_t			flags;
 	Byte			particleTextureNum;
@@ -45,15 +58,42 @@ typedef struct
 	float			baseScale;
 	float			decayRate;			// shrink speed
 	float			fadeRate;
-	
+
 	float			alpha[MAX_PARTICLES];
 	float			scale[MAX_PARTICLES];
-	TQ3Point3D		coord[MAX_PARTICLES];
-	TQ3Vector3D		delta[MAX_PARTICLES];
+	float			x[MAX_PARTICLES];
+	float			y[MAX_PARTICLES];
+	float			z[MAX_PARTICLES];
+	float			dx[MAX_PARTICLES];
+	float			dy[MAX_PARTICLES];
+	float			dz[MAX_PARTICLES];
 	TQ3TriMeshData	*mesh;
 }ParticleGroupType;
 
+		/* GRAVITOID OCTREE NODE */
+		//
+		// Children of a node are stored next to each other. A node's particles
+		// are the range [first, first+count) of gGravitoidSorted.
+		//
+
+typedef struct
+{
+	float			x, y, z;			// center of mass
+	float			mass;
+	float			size;				// edge length of the node's cube
+	uint16_t		first;
+	uint16_t		count;
+	uint16_t		firstChild;
+	uint8_t			numChildren;
+}GravitoidNode;
+
 static inline ParticleGroupType* GetValidParticleGroup(int32_t groupID);
+static void ApplyGravitoidForces(ParticleGroupType* pg, float fps);
+static void ApplyGravitoidForces_Exact(ParticleGroupType* pg, float fps);
+static void ApplyGravitoidForces_Tree(ParticleGroupType* pg, float fps);
+static void BuildGravitoidNode(const ParticleGroupType* pg, int nodeIndex, float minX, float minY, float minZ, float size, int depth);
+static void CollideParticlesWithTerrain(ParticleGroupType* pg);
+static void RemoveDeadParticles(ParticleGroupType* pg);
 
 
 /*********************/
@@ -68,14 +108,135 @@ static int32_t				gParticleGroupMagicAllocator = 0;
 static GLuint				gParticleTextureNames[NUM_PARTICLE_TEXTURES];
 static bool					gParticleTexturesLoaded = false;
 
-static float	gGravitoidDistBuffer[MAX_PARTICLES][MAX_PARTICLES];
+static GravitoidNode	gGravitoidNodes[GRAVITOID_MAX_NODES];
+static int				gNumGravitoidNodes = 0;
+static uint16_t			gGravitoidSorted[MAX_PARTICLES];			// particle indices grouped by octree node
+static uint16_t			gGravitoidScratch[MAX_PARTICLES];
+static uint16_t			gGravitoidSlotOf[MAX_PARTICLES];			// where each particle ended up in gGravitoidSorted
+static uint8_t			gGravitoidOctantOf[MAX_PARTICLES];
 
 static RenderModifiers kParticleGroupRenderingMods;
 
+		/* EFFECT POOLS */
+		//
+		// Short-lived effect objects aren't deleted when they expire. They're parked
+		// (taken out of the object list, keeping their geometry) and revived for the next effect of the same kind.
+		//
+
+typedef struct
+{
+	Byte		group;
+	Byte		type;
+	int			numPreallocated;						// parked objects made at the start of each area
+}EffectPoolDef;
+
+static const EffectPoolDef	kEffectPoolDefs[NUM_EFFECT_POOLS] =
+{
+	[EFFECT_POOL_RIPPLE]	= { GLOBAL1_MGroupNum_Ripple,		GLOBAL1_MObjType_Ripple,		16 },
+	[EFFECT_POOL_SHOCKWAVE]	= { GLOBAL1_MGroupNum_ShockWave,	GLOBAL1_MObjType_ShockWave,		2 },
+};
+
+static ObjNode*		gParkedEffects[NUM_EFFECT_POOLS][MAX_PARKED_EFFECTS];
+static int			gNumParkedEffects[NUM_EFFECT_POOLS];
+
 
 #pragma mark -
 
 
+/************************* INIT EFFECT POOLS *********************************/
+//
+// Call after the level's models are loaded.
+//
+
+void InitEffectPools(void)
+{
+	for (int kind = 0; kind < NUM_EFFECT_POOLS; kind++)
+	{
+		const EffectPoolDef* def = &kEffectPoolDefs[kind];
+
+		GAME_ASSERT(gNumParkedEffects[kind] == 0);
+		GAME_ASSERT(def->numPreallocated <= MAX_PARKED_EFFECTS);
+
+		for (int i = 0; i < def->numPreallocated; i++)
+		{
+			gNewObjectDefinition.group		= def->group;
+			gNewObjectDefinition.type		= def->type;
+			gNewObjectDefinition.coord		= (TQ3Point3D) {0,0,0};
+			gNewObjectDefinition.flags		= 0;
+			gNewObjectDefinition.slot		= SLOT_OF_DUMB;
+			gNewObjectDefinition.moveCall	= nil;
+			gNewObjectDefinition.rot		= 0;
+			gNewObjectDefinition.scale		= 1;
+			ObjNode* newObj = MakeNewDisplayGroupObject(&gNewObjectDefinition);
+
+			ReleasePooledEffect(kind, newObj);
+		}
+	}
+}
+
+
+/************************* DISPOSE EFFECT POOLS *********************************/
+//
+// Parked objects aren't in the object list, so DeleteAllObjects wouldn't see them.
+//
+
+void DisposeEffectPools(void)
+{
+	for (int kind = 0; kind < NUM_EFFECT_POOLS; kind++)
+	{
+		for (int i = 0; i < gNumParkedEffects[kind]; i++)
+		{
+			DeleteObject(gParkedEffects[kind][i]);
+			gParkedEffects[kind][i] = nil;
+		}
+		gNumParkedEffects[kind] = 0;
+	}
+}
+
+
+/************************* MAKE POOLED EFFECT *********************************/
+//
+// Same as MakeNewDisplayGroupObject, but reuses a parked object of the same kind if there is one.
+// The definition's group & type must match the pool's.
+//
+
+ObjNode *MakePooledEffect(int kind, NewObjectDefinitionType *newObjDef)
+{
+	GAME_ASSERT(kind >= 0 && kind < NUM_EFFECT_POOLS);
+	GAME_ASSERT(newObjDef->group == kEffectPoolDefs[kind].group);
+	GAME_ASSERT(newObjDef->type == kEffectPoolDefs[kind].type);
+
+	if (gNumParkedEffects[kind] > 0)
+	{
+		ObjNode* theNode = gParkedEffects[kind][--gNumParkedEffects[kind]];
+		gParkedEffects[kind][gNumParkedEffects[kind]] = nil;
+		return ReviveDisplayGroupObject(theNode, newObjDef);
+	}
+
+	return MakeNewDisplayGroupObject(newObjDef);
+}
+
+
+/************************* RELEASE POOLED EFFECT *********************************/
+//
+// Use this instead of DeleteObject on objects made by MakePooledEffect.
+//
+
+void ReleasePooledEffect(int kind, ObjNode *theNode)
+{
+	GAME_ASSERT(kind >= 0 && kind < NUM_EFFECT_POOLS);
+
+	if (gNumParkedEffects[kind] >= MAX_PARKED_EFFECTS)		// pool is full, really delete it
+	{
+		DeleteObject(theNode);
+		return;
+	}
+
+	ParkDisplayGroupObject(theNode);
+	gParkedEffects[kind][gNumParkedEffects[kind]++] = theNode;
+}
+
+
 /************************* MAKE RIPPLE *********************************/
 
 ObjNode *MakeRipple(float x, float y, float z, float startScale)
@@ -92,7 +253,7 @@ ObjNode	*newObj;
 	gNewObjectDefinition.moveCall = MoveRipple;
 	gNewObjectDefinition.rot = 0;
 	gNewObjectDefinition.scale = startScale;
-	newObj = MakeNewDisplayGroupObject(&gNewObjectDefinition);
+	newObj = MakePooledEffect(EFFECT_POOL_RIPPLE, &gNewObjectDefinition);
 	if (newObj == nil)
 		return(nil);
 
@@ -116,7 +277,7 @@ float	fps = gFramesPerSecondFrac;
 	theNode->Health -= fps * .8f;
 	if (theNode->Health < 0)
 	{
-		DeleteObject(theNode);
+		ReleasePooledEffect(EFFECT_POOL_RIPPLE, theNode);
 		return;
 	}
 	
@@ -143,8 +304,6 @@ static void InitParticleGroup(ParticleGroupType* pg)
 
 	SDL_memset(pg, 0, sizeof(ParticleGroupType));
 
-	pg->pool = Pool_New(MAX_PARTICLES);
-
 			/* INIT THE GROUP'S TRIMESH STRUCTURE */
 
 	pg->mesh = Q3TriMeshData_New(MAX_PARTICLES*2, MAX_PARTICLES*4, kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexColors);
@@ -235,9 +394,7 @@ void DeleteAllParticleGroups(void)
 				gParticleGroups[i].mesh = nil;
 			}
 
-			// Free particle pool
-			Pool_Free(gParticleGroups[i].pool);
-			gParticleGroups[i].pool = NULL;
+			gParticleGroups[i].numParticles = 0;
 		}
 
 		// Free particle group pool
@@ -252,7 +409,7 @@ void DeleteAllParticleGroups(void)
 	{
 		for (int i = 0; i < NUM_PARTICLE_TEXTURES; i++)
 		{
-			glDeleteTextures(1, &gParticleTextureNames[i]);
+			Render_DeleteTextures(1, &gParticleTextureNames[i]);
 			gParticleTextureNames[i] = 0;
 		}
 		gParticleTexturesLoaded = false;
@@ -295,6 +452,7 @@ int32_t NewParticleGroup(
 
 			/* INITIALIZE THE GROUP */
 
+	pg->numParticles = 0;
 	pg->type = type;
 	pg->flags = flags;
 	pg->gravity = gravity;
@@ -345,36 +503,38 @@ bool AddParticleToGroup(int32_t groupID, TQ3Point3D *where, TQ3Vector3D *delta,
 	}
 
 
-			/* SCAN FOR FREE SLOT */
-
-	int p = Pool_AllocateIndex(pg->pool);
-
 			/* NO FREE SLOTS */
 
-	if (p < 0)
+	if (pg->numParticles >= MAX_PARTICLES)
 		return true;
 
 			/* INIT PARAMETERS */
 
+	int p = pg->numParticles++;
+
 	pg->alpha[p] = alpha;
 	pg->scale[p] = scale;
-	pg->coord[p] = *where;
-	pg->delta[p] = *delta;
+	pg->x[p] = where->x;
+	pg->y[p] = where->y;
+	pg->z[p] = where->z;
+	pg->dx[p] = delta->x;
+	pg->dy[p] = delta->y;
+	pg->dz[p] = delta->z;
 
 	return(false);
 }
 
 
 /****************** MOVE PARTICLE GROUPS *********************/
+//
+// Each step of the update runs over the whole group at once, and the per-type
+// motion is done in its own loop, so the inner loops are branch-free and the
+// compiler can vectorize them.
+//
 
 void MoveParticleGroups(void)
 {
-Byte		flags;
 float		fps = gFramesPerSecondFrac;
-float		y,baseScale,oneOverBaseScaleSquared,gravity;
-float		decayRate,magnetism,fadeRate;
-TQ3Point3D	*coord;
-TQ3Vector3D	*delta;
 
 	if (!gParticleGroupsInitialized)
 		return;
@@ -388,216 +548,467 @@ TQ3Vector3D	*delta;
 
 		int nextGroupIndex = Pool_Next(gParticleGroupPool, g);
 
-		baseScale 	= pg->baseScale;					// get base scale
-		oneOverBaseScaleSquared = 1.0f/(baseScale*baseScale);
-		gravity 	= pg->gravity;						// get gravity
-		decayRate 	= pg->decayRate;					// get decay rate
-		fadeRate 	= pg->fadeRate;						// get fade rate
-		magnetism 	= pg->magnetism;					// get magnetism
-		flags 		= pg->flags;
-
-		int n = 0;										// init counter
-		int p = Pool_First(pg->pool);
-		while (p >= 0)
+				/* SEE IF GROUP WAS EMPTY, THEN DELETE */
+
+		if (pg->numParticles == 0)
+		{
+			Pool_ReleaseIndex(gParticleGroupPool, g);
+			g = nextGroupIndex;
+			continue;
+		}
+
+		const int n = pg->numParticles;
+		float* restrict x = pg->x;
+		float* restrict y = pg->y;
+		float* restrict z = pg->z;
+		float* restrict dx = pg->dx;
+		float* restrict dy = pg->dy;
+		float* restrict dz = pg->dz;
+
+						/* ADD GRAVITY */
+
+		const float gravityStep = pg->gravity * fps;
+		for (int i = 0; i < n; i++)
+			dy[i] -= gravityStep;
+
+		switch (pg->type)
+		{
+						/* FALLING SPARKS */
+
+			case	PARTICLE_TYPE_FALLINGSPARKS:
+					break;
+
+						/* GRAVITOIDS */
+						//
+						// Every particle has gravity pull on other particle
+						//
+
+			case	PARTICLE_TYPE_GRAVITOIDS:
+					ApplyGravitoidForces(pg, fps);
+					break;
+		}
+
+						/* MOVE IT */
+
+		for (int i = 0; i < n; i++)
+		{
+			x[i] += dx[i] * fps;
+			y[i] += dy[i] * fps;
+			z[i] += dz[i] * fps;
+		}
+
+						/* BOUNCE, HURT PLAYER, HIT CEILING */
+
+		if (pg->flags & (PARTICLE_FLAGS_BOUNCE | PARTICLE_FLAGS_HURTPLAYER | PARTICLE_FLAGS_ROOF))
+			CollideParticlesWithTerrain(pg);
+
+						/* DO SCALE & FADE */
+
+		const float decayStep = pg->decayRate * fps;
+		const float fadeStep = pg->fadeRate * fps;
+		float* restrict scale = pg->scale;
+		float* restrict alpha = pg->alpha;
+
+		for (int i = 0; i < n; i++)
+		{
+			scale[i] -= decayStep;						// shrink it
+			alpha[i] -= fadeStep;						// fade it
+		}
+
+						/* SEE IF GONE */
+
+		RemoveDeadParticles(pg);
+
+		g = nextGroupIndex;
+	}
+}
+
+
+/****************** APPLY GRAVITOID FORCES *********************/
+//
+// Every particle has gravity pull on other particle.
+// Pull strength is 1/dist2, clamped to the particle's radius.
+//
+
+static inline void GravitoidPull(float fromX, float fromY, float fromZ, float toX, float toY, float toZ,
+								float maxPull, float* outX, float* outY, float* outZ)
+{
+	float x = toX - fromX;
+	float y = toY - fromY;
+	float z = toZ - fromZ;
+	float dist2 = x*x + y*y + z*z;
+
+	if (dist2 == 0.0f)								// same spot: no direction to pull in
+	{
+		*outX = *outY = *outZ = 0;
+		return;
+	}
+
+	float pull = 1.0f / dist2;
+	if (pull > maxPull)								// adjust if closer than radius
+		pull = maxPull;
+
+	pull /= sqrtf(dist2);							// also normalizes the vector
+
+	*outX = x * pull;
+	*outY = y * pull;
+	*outZ = z * pull;
+}
+
+
+static void ApplyGravitoidForces(ParticleGroupType* pg, float fps)
+{
+	if (pg->numParticles <= GRAVITOID_EXACT_MAX)
+		ApplyGravitoidForces_Exact(pg, fps);
+	else
+		ApplyGravitoidForces_Tree(pg, fps);
+}
+
+
+/****************** APPLY GRAVITOID FORCES: EXACT *********************/
+//
+// O(n2) pairwise attraction. Each pair is only evaluated once
+// since the pull is symmetric.
+//
+
+static void ApplyGravitoidForces_Exact(ParticleGroupType* pg, float fps)
+{
+	const int n = pg->numParticles;
+	const float maxPull = 1.0f / (pg->baseScale * pg->baseScale);
+	const float k = pg->magnetism * fps;
+
+	for (int p = 0; p < n; p++)
+	{
+		for (int q = p+1; q < n; q++)
 		{
-			GAME_ASSERT(Pool_IsUsed(pg->pool, p));
-			int nextParticleIndex = Pool_Next(pg->pool, p);
+			float vx, vy, vz;
+			GravitoidPull(pg->x[p], pg->y[p], pg->z[p], pg->x[q], pg->y[q], pg->z[q], maxPull, &vx, &vy, &vz);
+
+			pg->dx[p] += vx * k;		pg->dx[q] -= vx * k;
+			pg->dy[p] += vy * k;		pg->dy[q] -= vy * k;
+			pg->dz[p] += vz * k;		pg->dz[q] -= vz * k;
+		}
+	}
+}
+
+
+/****************** APPLY GRAVITOID FORCES: TREE *********************/
+//
+// Barnes-Hut approximation for big groups. The group is split into an octree;
+// a node that looks small from a particle (size/dist < GRAVITOID_THETA) pulls
+// as a single mass at its center of mass, otherwise it's opened. Only leaves
+// that are too close get exact pairwise pulls, so the work per particle grows
+// with log(n) rather than n.
+//
+
+static void ApplyGravitoidForces_Tree(ParticleGroupType* pg, float fps)
+{
+	const int n = pg->numParticles;
+	const float maxPull = 1.0f / (pg->baseScale * pg->baseScale);
+	const float k = pg->magnetism * fps;
+	const float theta2 = GRAVITOID_THETA * GRAVITOID_THETA;
+
+			/* GET BOUNDING CUBE OF GROUP */
+
+	float minX = pg->x[0], maxX = minX;
+	float minY = pg->y[0], maxY = minY;
+	float minZ = pg->z[0], maxZ = minZ;
+
+	for (int i = 1; i < n; i++)
+	{
+		minX = SDL_min(minX, pg->x[i]);		maxX = SDL_max(maxX, pg->x[i]);
+		minY = SDL_min(minY, pg->y[i]);		maxY = SDL_max(maxY, pg->y[i]);
+		minZ = SDL_min(minZ, pg->z[i]);		maxZ = SDL_max(maxZ, pg->z[i]);
+	}
+
+	float size = SDL_max(SDL_max(maxX - minX, maxY - minY), maxZ - minZ);
+	size = SDL_max(size, 1.0f);
+
+			/* BUILD OCTREE */
+
+	for (int i = 0; i < n; i++)
+		gGravitoidSorted[i] = i;
 
-			n++;										// inc counter
-			delta = &pg->delta[p];						// get ptr to deltas
-			coord = &pg->coord[p];						// get ptr to coords
+	gNumGravitoidNodes = 1;
+	gGravitoidNodes[0].first = 0;
+	gGravitoidNodes[0].count = n;
+	BuildGravitoidNode(pg, 0, minX, minY, minZ, size, 0);
 
-							/* ADD GRAVITY */
+	for (int j = 0; j < n; j++)
+		gGravitoidSlotOf[gGravitoidSorted[j]] = j;
 
-			delta->y -= gravity * fps;									// add gravity
+			/* APPLY PULL TO EACH PARTICLE */
 
-			switch (pg->type)
+	for (int p = 0; p < n; p++)
+	{
+		const float px = pg->x[p];
+		const float py = pg->y[p];
+		const float pz = pg->z[p];
+		const int pSlot = gGravitoidSlotOf[p];
+
+		float ax = 0, ay = 0, az = 0;
+		float vx, vy, vz;
+
+		uint16_t stack[GRAVITOID_STACK_SIZE];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const GravitoidNode* node = &gGravitoidNodes[stack[--stackSize]];
+			const bool hasSelf = pSlot >= node->first && pSlot < node->first + node->count;
+
+			float x = node->x - px;
+			float y = node->y - py;
+			float z = node->z - pz;
+			float dist2 = x*x + y*y + z*z;
+
+			if (!hasSelf && node->size * node->size < theta2 * dist2)		// far: whole node as one mass
+			{
+				GravitoidPull(px, py, pz, node->x, node->y, node->z, maxPull, &vx, &vy, &vz);
+				ax += vx * node->mass;
+				ay += vy * node->mass;
+				az += vz * node->mass;
+			}
+			else if (node->numChildren == 0)								// near leaf: exact
+			{
+				for (int j = node->first; j < node->first + node->count; j++)
+				{
+					int q = gGravitoidSorted[j];
+					if (q == p)											// don't check against self
+						continue;
+
+					GravitoidPull(px, py, pz, pg->x[q], pg->y[q], pg->z[q], maxPull, &vx, &vy, &vz);
+					ax += vx;
+					ay += vy;
+					az += vz;
+				}
+			}
+			else															// near: open it up
 			{
-							/* FALLING SPARKS */
-
-				case	PARTICLE_TYPE_FALLINGSPARKS:
-						coord->x += delta->x * fps;						// move it
-						coord->y += delta->y * fps;
-						coord->z += delta->z * fps;
-						break;
-
-
-							/* GRAVITOIDS */
-							//
-							// Every particle has gravity pull on other particle
-							//
-
-				case	PARTICLE_TYPE_GRAVITOIDS:
-						for (int q = Pool_Last(pg->pool); q >= 0; q = Pool_Prev(pg->pool, q))
-						{
-							GAME_ASSERT(Pool_IsUsed(pg->pool, q));
-
-							float		dist;
-							float		x,z;
-							TQ3Vector3D	v;
-
-							if (p == q)									// don't check against self
-								continue;
-
-							x = pg->coord[q].x;
-							y = pg->coord[q].y;
-							z = pg->coord[q].z;
-
-									/* calc 1/(dist2) */
-
-							if (p < q)									// see if calc or get from buffer
-							{
-								float dx = coord->x - x;
-								float dy = coord->y - y;
-								float dz = coord->z - z;
-								dist = sqrtf(dx*dx + dy*dy + dz*dz);
-								if (dist != 0.0f)
-									dist = 1.0f / (dist*dist);
-
-								if (dist > oneOverBaseScaleSquared)		// adjust if closer than radius
-									dist = oneOverBaseScaleSquared;
-
-								gGravitoidDistBuffer[p][q] = dist;		// remember it
-							}
-							else
-							{
-								dist = gGravitoidDistBuffer[q][p];		// use from buffer
-							}
-
-										/* calc vector to particle */
-
-							if (dist != 0.0f)
-							{
-								x = x - coord->x;
-								y = y - coord->y;
-								z = z - coord->z;
-								FastNormalizeVector(x, y, z, &v);
-							}
-							else
-							{
-								v.x = v.y = v.z = 0;
-							}
-
-							delta->x += v.x * (dist * magnetism * fps);		// apply gravity to particle
-							delta->y += v.y * (dist * magnetism * fps);
-							delta->z += v.z * (dist * magnetism * fps);
-						}
-
-						coord->x += delta->x * fps;						// move it
-						coord->y += delta->y * fps;
-						coord->z += delta->z * fps;
-						break;
+				for (int c = 0; c < node->numChildren; c++)
+					stack[stackSize++] = node->firstChild + c;
 			}
+		}
+
+		pg->dx[p] += ax * k;
+		pg->dy[p] += ay * k;
+		pg->dz[p] += az * k;
+	}
+}
 
 
-			if (gFloorMap)					// only do these checks if there's a terrain floor
-			{
-					/*****************/
-					/* SEE IF BOUNCE */
-					/*****************/
+/****************** BUILD GRAVITOID NODE *********************/
+//
+// Computes the node's center of mass, then splits its particles into
+// the non-empty octants of its cube and recurses into them.
+//
+
+static void BuildGravitoidNode(const ParticleGroupType* pg, int nodeIndex, float minX, float minY, float minZ, float size, int depth)
+{
+	GravitoidNode* node = &gGravitoidNodes[nodeIndex];
+	const int first = node->first;
+	const int end = first + node->count;
+
+			/* GET CENTER OF MASS */
+
+	float x = 0, y = 0, z = 0;
+
+	for (int j = first; j < end; j++)
+	{
+		int q = gGravitoidSorted[j];
+		x += pg->x[q];
+		y += pg->y[q];
+		z += pg->z[q];
+	}
+
+	float oneOverMass = 1.0f / node->count;
+	node->x = x * oneOverMass;
+	node->y = y * oneOverMass;
+	node->z = z * oneOverMass;
+	node->mass = node->count;
+	node->size = size;
+	node->numChildren = 0;
+
+	if (node->count <= GRAVITOID_LEAF_SIZE || depth >= GRAVITOID_MAX_DEPTH)
+		return;
+
+			/* SORT PARTICLES BY OCTANT */
+
+	const float half = size * 0.5f;
+	const float midX = minX + half;
+	const float midY = minY + half;
+	const float midZ = minZ + half;
+
+	int octantCount[8] = {0};
+
+	for (int j = first; j < end; j++)
+	{
+		int q = gGravitoidSorted[j];
+		int octant = (pg->x[q] >= midX) | ((pg->y[q] >= midY) << 1) | ((pg->z[q] >= midZ) << 2);
+		gGravitoidOctantOf[q] = octant;
+		octantCount[octant]++;
+	}
+
+	int fill[8];
+	fill[0] = first;
+	for (int o = 1; o < 8; o++)
+		fill[o] = fill[o-1] + octantCount[o-1];
+
+	for (int j = first; j < end; j++)
+	{
+		int q = gGravitoidSorted[j];
+		gGravitoidScratch[fill[gGravitoidOctantOf[q]]++] = q;
+	}
+
+	SDL_memcpy(&gGravitoidSorted[first], &gGravitoidScratch[first], node->count * sizeof(gGravitoidSorted[0]));
+
+			/* MAKE A CHILD FOR EACH NON-EMPTY OCTANT */
+
+	GAME_ASSERT(gNumGravitoidNodes + 8 <= GRAVITOID_MAX_NODES);
+
+	node->firstChild = gNumGravitoidNodes;
+
+	int childFirst = first;
+	for (int o = 0; o < 8; o++)
+	{
+		if (octantCount[o] == 0)
+			continue;
+
+		GravitoidNode* child = &gGravitoidNodes[gNumGravitoidNodes++];
+		child->first = childFirst;
+		child->count = octantCount[o];
+		childFirst += octantCount[o];
+		node->numChildren++;
+	}
 
-				if (flags & PARTICLE_FLAGS_BOUNCE)
+	int childIndex = node->firstChild;
+	for (int o = 0; o < 8; o++)
+	{
+		if (octantCount[o] == 0)
+			continue;
+
+		BuildGravitoidNode(pg, childIndex++,
+				(o & 1) ? midX : minX,
+				(o & 2) ? midY : minY,
+				(o & 4) ? midZ : minZ,
+				half, depth + 1);
+	}
+}
+
+
+/****************** COLLIDE PARTICLES WITH TERRAIN *********************/
+
+static void CollideParticlesWithTerrain(ParticleGroupType* pg)
+{
+	const uint8_t flags = pg->flags;
+
+	for (int i = 0; i < pg->numParticles; i++)
+	{
+		if (gFloorMap)					// only do these checks if there's a terrain floor
+		{
+				/*****************/
+				/* SEE IF BOUNCE */
+				/*****************/
+
+			if (flags & PARTICLE_FLAGS_BOUNCE)
+			{
+				if (pg->dy[i] < 0.0f)							// if moving down, see if hit floor
 				{
-					if (delta->y < 0.0f)							// if moving down, see if hit floor
+					float y = GetTerrainHeightAtCoord(pg->x[i], pg->z[i], FLOOR)+10.0f;	// see if hit floor
+					if (pg->y[i] < y)
 					{
-						y = GetTerrainHeightAtCoord(coord->x, coord->z, FLOOR)+10.0f;	// see if hit floor
-						if (coord->y < y)
-						{
-							coord->y = y;
-							delta->y *= -.4f;
-
-							delta->x += gRecentTerrainNormal[FLOOR].x * 300.0f;	// reflect off of surface
-							delta->z += gRecentTerrainNormal[FLOOR].z * 300.0f;
-						}
+						pg->y[i] = y;
+						pg->dy[i] *= -.4f;
+
+						pg->dx[i] += gRecentTerrainNormal[FLOOR].x * 300.0f;	// reflect off of surface
+						pg->dz[i] += gRecentTerrainNormal[FLOOR].z * 300.0f;
 					}
 				}
+			}
 
 
-					/**********************/
-					/* SEE IF HURT PLAYER */
-					/**********************/
+				/**********************/
+				/* SEE IF HURT PLAYER */
+				/**********************/
 
-				if (flags & PARTICLE_FLAGS_HURTPLAYER)
+			if (flags & PARTICLE_FLAGS_HURTPLAYER)
+			{
+				float x = pg->x[i];
+				float y = pg->y[i];
+				float z = pg->z[i];
+
+				if (DoSimpleBoxCollisionAgainstPlayer(y+30.0f, y-30.0f,
+													x-30.0f, x+30.0f,
+													z+30.0f, z-30.0f))
 				{
-					if (DoSimpleBoxCollisionAgainstPlayer(coord->y+30.0f,coord->y-30.0f,
-														coord->x-30.0f, coord->x+30.0f,
-														coord->z+30.0f, coord->z-30.0f))
+					if (flags & PARTICLE_FLAGS_HURTPLAYERBAD)					// hurt really bad!
+					{
+						PlayerGotHurt(nil, 1.0, false, false, false,.5);		// hurt enough to kill!
+						if (gPlayerGotKilledFlag)
+							gTorchPlayer = true;
+					}
+					else														// normal hurt
 					{
-						if (flags & PARTICLE_FLAGS_HURTPLAYERBAD)					// hurt really bad!
-						{
-							PlayerGotHurt(nil, 1.0, false, false, false,.5);		// hurt enough to kill!
-							if (gPlayerGotKilledFlag)
-								gTorchPlayer = true;
-						}
-						else														// normal hurt
-						{
-							if (gPlayerMode == PLAYER_MODE_BALL)					// ball gets hurt less
-								PlayerGotHurt(nil, .1, false, false, false,1.2);
-							else
-								PlayerGotHurt(nil, .15, false, false, false,1.2);
-						}
+						if (gPlayerMode == PLAYER_MODE_BALL)					// ball gets hurt less
+							PlayerGotHurt(nil, .1, false, false, false,1.2);
+						else
+							PlayerGotHurt(nil, .15, false, false, false,1.2);
 					}
 				}
 			}
+		}
 
-			if (gCeilingMap)
-			{
-						/* SEE IF HIT CEILING */
+		if (gCeilingMap)
+		{
+					/* SEE IF HIT CEILING */
 
-				if (flags & PARTICLE_FLAGS_ROOF)
+			if (flags & PARTICLE_FLAGS_ROOF)
+			{
+				if (pg->dy[i] > 0.0f)							// if moving up, see if hit ceiling
 				{
-					if (delta->y > 0.0f)							// if moving up, see if hit ceiling
+					float y = GetTerrainHeightAtCoord(pg->x[i], pg->z[i], CEILING)-10.0f;	// see if hit ceiling
+					if (pg->y[i] > y)
 					{
-						y = GetTerrainHeightAtCoord(coord->x, coord->z, CEILING)-10.0f;	// see if hit ceiling
-						if (coord->y > y)
-						{
-							coord->y = y;
-							delta->x += gRecentTerrainNormal[FLOOR].x * 1000.0f;	// reflect off of surface
-							delta->z += gRecentTerrainNormal[FLOOR].z * 1000.0f;
-						}
+						pg->y[i] = y;
+						pg->dx[i] += gRecentTerrainNormal[FLOOR].x * 1000.0f;	// reflect off of surface
+						pg->dz[i] += gRecentTerrainNormal[FLOOR].z * 1000.0f;
 					}
 				}
 			}
-
-				/***************/
-				/* SEE IF GONE */
-				/***************/
-
-					/* DO SCALE */
-
-			pg->scale[p] -= decayRate * fps;			// shrink it
-			if (pg->scale[p] <= 0.0f)					// see if gone
-				goto deleteParticle;
-
-					/* DO FADE */
-
-			pg->alpha[p] -= fadeRate * fps;				// fade it
-			if (pg->alpha[p] <= 0.0f)					// see if gone
-				goto deleteParticle;
-
-
-			goto nextParticle;
-
-					/* IF GONE RELEASE INDEX */
-
-deleteParticle:
-			Pool_ReleaseIndex(pg->pool, p);
-
-
-nextParticle:
-			p = nextParticleIndex;
 		}
+	}
+}
 
 
-				/* SEE IF GROUP WAS EMPTY, THEN DELETE */
+/****************** REMOVE DEAD PARTICLES *********************/
+//
+// Swap-removes particles that have shrunk or faded away,
+// so the live ones stay contiguous.
+//
+
+static void RemoveDeadParticles(ParticleGroupType* pg)
+{
+	int i = 0;
 
-		if (n == 0)
+	while (i < pg->numParticles)
+	{
+		if (pg->scale[i] > 0.0f && pg->alpha[i] > 0.0f)
 		{
-			Pool_ReleaseIndex(gParticleGroupPool, g);
+			i++;
+			continue;
 		}
 
+		int last = --pg->numParticles;				// move last particle into this slot
 
-		g = nextGroupIndex;
+		pg->alpha[i]	= pg->alpha[last];
+		pg->scale[i]	= pg->scale[last];
+		pg->x[i]		= pg->x[last];
+		pg->y[i]		= pg->y[last];
+		pg->z[i]		= pg->z[last];
+		pg->dx[i]		= pg->dx[last];
+		pg->dy[i]		= pg->dy[last];
+		pg->dz[i]		= pg->dz[last];
 	}
 }
 
@@ -606,93 +1017,99 @@ nextParticle:
 
 void DrawParticleGroup(const QD3DSetupOutputType *setupInfo)
 {
-float			baseScale;
-TQ3TriMeshData	*tm;
-TQ3Point3D		v[4],*coord;
-TQ3Matrix4x4	m;
-static const TQ3Vector3D up = {0,1,0};
-
-
 	(void) setupInfo;
 
 	if (!gParticleGroupsInitialized)
 		return;
 
-	const TQ3Point3D* camCoords = &gGameViewInfoPtr->currentCameraCoords;
+			/* GET CAMERA BASIS ONCE FOR ALL PARTICLES */
+			//
+			// The camera's right & up vectors in world space are the first two columns
+			// of the world-to-view matrix. Every particle is a quad spanned by these vectors,
+			// so there's no need to build a look-at matrix per particle.
+			//
+
+	const TQ3Matrix4x4* wtv = &gCameraWorldToViewMatrix;
+	const TQ3Vector3D right	= { wtv->value[0][0], wtv->value[1][0], wtv->value[2][0] };
+	const TQ3Vector3D up	= { wtv->value[0][1], wtv->value[1][1], wtv->value[2][1] };
+
+	const TQ3Vector3D diagA = { right.x + up.x, right.y + up.y, right.z + up.z };		// corner 0 (and -corner 2)
+	const TQ3Vector3D diagB = { right.x - up.x, right.y - up.y, right.z - up.z };		// corner 1 (and -corner 3)
+
+	const TQ3Vector3D extent =															// half-size of a unit quad's bbox
+	{
+		fabsf(right.x) + fabsf(up.x),
+		fabsf(right.y) + fabsf(up.y),
+		fabsf(right.z) + fabsf(up.z),
+	};
 
 	for (int g = Pool_First(gParticleGroupPool); g >= 0; g = Pool_Next(gParticleGroupPool, g))
 	{
 		GAME_ASSERT(Pool_IsUsed(gParticleGroupPool, g));
 
-		float	minX,minY,minZ,maxX,maxY,maxZ;
-
 		ParticleGroupType* pg = &gParticleGroups[g];
+		TQ3TriMeshData* tm = pg->mesh;					// get pointer to trimesh data
+		const float baseScale = pg->baseScale;			// get base scale
 
-		tm = pg->mesh;									// get pointer to trimesh data
-		baseScale = pg->baseScale;						// get base scale
+		TQ3Point3D* points = tm->points;
+		TQ3ColorRGBA* colors = tm->vertexColors;
 
 					/********************************/
 					/* ADD ALL PARTICLES TO TRIMESH */
 					/********************************/
 
+		float minX, minY, minZ, maxX, maxY, maxZ;
 		minX = minY = minZ = 1e9f;						// init bbox
 		maxX = maxY = maxZ = -minX;
 
-		int numParticlesDrawn = 0;
-		for (int p = Pool_First(pg->pool); p >= 0; p = Pool_Next(pg->pool, p))
+		const int numParticles = pg->numParticles;
+		for (int p = 0; p < numParticles; p++)
 		{
-			GAME_ASSERT(Pool_IsUsed(pg->pool, p));
-
-					/* TRANSFORM PARTICLE POSITION */
-
-			coord = &pg->coord[p];
-			SetLookAtMatrixAndTranslate(&m, &up, coord, camCoords);
+			const TQ3Point3D c = { pg->x[p], pg->y[p], pg->z[p] };
+			const float S = baseScale * pg->scale[p];
+			const float a = pg->alpha[p];
+			const int v = p * 4;
 
-					/* CULL PARTICLE TO AVOID OVERDRAW (SOURCE PORT ADD) */
+					/* EXPAND QUAD ALONG CAMERA BASIS */
 
-			if (!IsSphereInFrustum_XYZ(coord, pg->baseScale))
-				continue;
+			const float ax = S * diagA.x, ay = S * diagA.y, az = S * diagA.z;
+			const float bx = S * diagB.x, by = S * diagB.y, bz = S * diagB.z;
 
-					/* TRANSFORM PARTICLE VERTICES & ADD TO TRIMESH */
+			points[v+0] = (TQ3Point3D) { c.x + ax, c.y + ay, c.z + az };
+			points[v+1] = (TQ3Point3D) { c.x + bx, c.y + by, c.z + bz };
+			points[v+2] = (TQ3Point3D) { c.x - ax, c.y - ay, c.z - az };
+			points[v+3] = (TQ3Point3D) { c.x - bx, c.y - by, c.z - bz };
 
-			const float S = baseScale * pg->scale[p];
-			v[0] = (TQ3Point3D) {  S, S, 0 };
-			v[1] = (TQ3Point3D) {  S,-S, 0 };
-			v[2] = (TQ3Point3D) { -S,-S, 0 };
-			v[3] = (TQ3Point3D) { -S, S, 0 };
+					/* UPDATE FACE TRANSPARENCY */
 
-			Q3Point3D_To3DTransformArray(&v[0], &m, &tm->points[numParticlesDrawn * 4], 4);
+			colors[v+0].a = a;
+			colors[v+1].a = a;
+			colors[v+2].a = a;
+			colors[v+3].a = a;
 
 					/* UPDATE BBOX */
 
-			for (int i = 0; i < 4; i++)
-			{
-				const TQ3Point3D* pt = &tm->points[numParticlesDrawn * 4 + i];
-				if (pt->x < minX) minX = pt->x;
-				if (pt->x > maxX) maxX = pt->x;
-				if (pt->y < minY) minY = pt->y;
-				if (pt->y > maxY) maxY = pt->y;
-				if (pt->z < minZ) minZ = pt->z;
-				if (pt->z > maxZ) maxZ = pt->z;
-			}
+			const float ex = S * extent.x, ey = S * extent.y, ez = S * extent.z;
+			minX = SDL_min(minX, c.x - ex);		maxX = SDL_max(maxX, c.x + ex);
+			minY = SDL_min(minY, c.y - ey);		maxY = SDL_max(maxY, c.y + ey);
+			minZ = SDL_min(minZ, c.z - ez);		maxZ = SDL_max(maxZ, c.z + ez);
+		}
 
-					/* UPDATE FACE TRANSPARENCY */
+		if (numParticles == 0)										// if no particles, then skip
+			continue;
 
-			tm->vertexColors[numParticlesDrawn * 4 + 0].a = pg->alpha[p];
-			tm->vertexColors[numParticlesDrawn * 4 + 1].a = pg->alpha[p];
-			tm->vertexColors[numParticlesDrawn * 4 + 2].a = pg->alpha[p];
-			tm->vertexColors[numParticlesDrawn * 4 + 3].a = pg->alpha[p];
+				/* CULL THE WHOLE GROUP AT ONCE */
 
-			numParticlesDrawn++;										// inc particle count
-		}
+		TQ3Point3D center = { (minX+maxX) * 0.5f, (minY+maxY) * 0.5f, (minZ+maxZ) * 0.5f };
+		float radius = 0.5f * sqrtf((maxX-minX)*(maxX-minX) + (maxY-minY)*(maxY-minY) + (maxZ-minZ)*(maxZ-minZ));
 
-		if (numParticlesDrawn == 0)										// if no particles, then skip
+		if (!IsSphereInFrustum_XYZ(&center, radius))
 			continue;
 
 				/* UPDATE FINAL VALUES */
 
-		tm->numTriangles = numParticlesDrawn * 2;
-		tm->numPoints = numParticlesDrawn * 4;
+		tm->numTriangles = numParticles * 2;
+		tm->numPoints = numParticles * 4;
 		tm->bBox.min.x = minX;
 		tm->bBox.min.y = minY;
 		tm->bBox.min.z = minZ;
@@ -753,17 +1170,17 @@ bool ParticleHitObject(ObjNode *theNode, uint8_t inFlags)
 		if (inFlags && !(inFlags & pg->flags))				// see if check flags
 			continue;
 
-		for (int p = Pool_First(pg->pool); p >= 0; p = Pool_Next(pg->pool, p))
+		for (int p = 0; p < pg->numParticles; p++)
 		{
-			GAME_ASSERT(Pool_IsUsed(pg->pool, p));
-
 			if (pg->alpha[p] < .4f)							// if particle is too decayed, then skip
 				continue;
 
-			const TQ3Point3D* coord = &pg->coord[p];		// get ptr to coords
-			if (DoSimpleBoxCollisionAgainstObject(coord->y+40.0f,coord->y-40.0f,
-												coord->x-40.0f, coord->x+40.0f,
-												coord->z+40.0f, coord->z-40.0f,
+			float x = pg->x[p];
+			float y = pg->y[p];
+			float z = pg->z[p];
+			if (DoSimpleBoxCollisionAgainstObject(y+40.0f, y-40.0f,
+												x-40.0f, x+40.0f,
+												z+40.0f, z-40.0f,
 												theNode))
 			{
 				return(true);
@@ -17,7 +17,8 @@
 /****************************/
 
 static void DrawWaterPatch(ObjNode *theNode);
-static void DrawWaterPatchTesselated(ObjNode *theNode);
+static void DrawLiquidPatchTesselated(ObjNode *theNode);
+static void BuildLiquidPatchGeometry(ObjNode *theNode);
 static void UpdateWaterTextureAnimation(void);
 static void UpdateHoneyTextureAnimation(void);
 static void UpdateSlimeTextureAnimation(void);
@@ -25,8 +26,10 @@ static void UpdateLavaTextureAnimation(void);
 
 static Boolean AddLiquidPatch(TerrainItemEntryType *itemPtr, long x, long z, int kind);
 static void MoveLiquidPatch(ObjNode *theNode);
-static void DrawSolidLiquidPatchTesselated(ObjNode *theNode);
 static void ApplyJitterToLiquidVertex(TQ3Point3D* p, int type);
+static void SetLiquidPatchGridBits(const ObjNode *theNode, bool set);
+static void RegisterLiquidPatch(ObjNode *theNode);
+static void UnregisterLiquidPatch(ObjNode *theNode);
 
 
 /****************************/
@@ -40,6 +43,12 @@ static void ApplyJitterToLiquidVertex(TQ3Point3D* p, int type);
 
 #define	RISING_WATER_YOFF		200.0f
 
+#define	LIQUID_GRID_CELL_SIZE	TERRAIN_SUPERTILE_UNIT_SIZE		// world size of a cell in the liquid patch index
+#define	LIQUID_GRID_WIDTH		MAX_SUPERTILES_WIDE
+#define	LIQUID_GRID_DEPTH		MAX_SUPERTILES_DEEP
+
+_Static_assert(MAX_LIQUID_MESHES <= 32, "liquid grid cells store a 32-bit mask of liquid mesh IDs");
+
 static const bool gLiquidOnThisLevel[NUM_LEVEL_TYPES][NUM_LIQUID_TYPES] =
 {
 	//								Water	Honey	Slime	Lava
@@ -88,13 +97,16 @@ static GLuint			gLiquidShaders[NUM_LIQUID_TYPES];
 static TQ3Param2D		gLiquidUVOffsets[NUM_LIQUID_TYPES];
 static TQ3Param2D		gWaterUVOffset2;		// extra uv offsets for second plane of non-tesselated water
 
+static ObjNode			*gLiquidPatchNodes[MAX_LIQUID_MESHES];					// active liquid patch for each mesh ID
+static uint32_t			gLiquidGrid[LIQUID_GRID_DEPTH][LIQUID_GRID_WIDTH];		// bit n set: liquid mesh #n overlaps this cell
+
 /****************** HELPER: DELETE TEXTURE **********************/
 
 static void DeleteTexture(GLuint* textureName)
 {
 	if (*textureName)
 	{
-		glDeleteTextures(1, textureName);
+		Render_DeleteTextures(1, textureName);
 		*textureName = 0;
 	}
 }
@@ -124,6 +136,8 @@ static void DisposeLiquidMesh(ObjNode* theNode)
 	GAME_ASSERT(gNumActiveLiquidMeshes >= 0);
 	GAME_ASSERT(theNode->PatchMeshID >= 0 && theNode->PatchMeshID < MAX_LIQUID_MESHES);
 
+	UnregisterLiquidPatch(theNode);
+
 	gNumActiveLiquidMeshes--;
 	gFreeLiquidMeshes[gNumActiveLiquidMeshes] = theNode->PatchMeshID;	// put mesh back into pool
 
@@ -137,6 +151,10 @@ void InitLiquids(void)
 {
 	gNumActiveLiquidMeshes = 0;
 
+	// Clear spatial index
+	SDL_memset(gLiquidGrid, 0, sizeof(gLiquidGrid));
+	SDL_memset(gLiquidPatchNodes, 0, sizeof(gLiquidPatchNodes));
+
 	// Initialize trimeshes
 	for (int i = 0; i < MAX_LIQUID_MESHES; i++)
 	{
@@ -198,6 +216,9 @@ void DisposeLiquids(void)
 	}
 
 	gNumActiveLiquidMeshes = 0;
+
+	SDL_memset(gLiquidGrid, 0, sizeof(gLiquidGrid));					// the objects are gone, don't keep dangling pointers
+	SDL_memset(gLiquidPatchNodes, 0, sizeof(gLiquidPatchNodes));
 }
 
 /*************** UPDATE LIQUID ANIMATION ****************/
@@ -217,39 +238,99 @@ void UpdateLiquidAnimation(void)
 
 Boolean FindLiquidY(float x, float z, float* y)
 {
-	ObjNode* thisNodePtr = gFirstNodePtr;
-	do
+	int col = (int) floorf(x * (1.0f / LIQUID_GRID_CELL_SIZE));
+	int row = (int) floorf(z * (1.0f / LIQUID_GRID_CELL_SIZE));
+
+	if (col < 0 || col >= LIQUID_GRID_WIDTH || row < 0 || row >= LIQUID_GRID_DEPTH)
+		return false;
+
+			/* ONLY CHECK THE PATCHES THAT OVERLAP THIS CELL */
+
+	uint32_t mask = gLiquidGrid[row][col];
+
+	while (mask)
 	{
-		if (thisNodePtr->CType & CTYPE_LIQUID)
+		int meshID = SDL_MostSignificantBitIndex32(mask);
+		mask &= ~(1u << meshID);
+
+		const ObjNode* thisNodePtr = gLiquidPatchNodes[meshID];
+		GAME_ASSERT(thisNodePtr);
+
+		if (!(thisNodePtr->CType & CTYPE_LIQUID) || !thisNodePtr->CollisionBoxes)
+			continue;
+
+		if (x < thisNodePtr->CollisionBoxes[0].left)
+			continue;
+		if (x > thisNodePtr->CollisionBoxes[0].right)
+			continue;
+		if (z > thisNodePtr->CollisionBoxes[0].front)
+			continue;
+		if (z < thisNodePtr->CollisionBoxes[0].back)
+			continue;
+
+		if (y)
 		{
-			if (thisNodePtr->CollisionBoxes)
-			{
-				if (x < thisNodePtr->CollisionBoxes[0].left)
-					goto next;
-				if (x > thisNodePtr->CollisionBoxes[0].right)
-					goto next;
-				if (z > thisNodePtr->CollisionBoxes[0].front)
-					goto next;
-				if (z < thisNodePtr->CollisionBoxes[0].back)
-					goto next;
-
-				if (y)
-				{
-					*y = thisNodePtr->CollisionBoxes[0].top;
-					*y += gLiquidCollisionTopOffset[thisNodePtr->Kind];
-				}
-				return true;
-			}
-		}		
-next:					
-		thisNodePtr = (ObjNode *)thisNodePtr->NextNode;		// next node
+			*y = thisNodePtr->CollisionBoxes[0].top;
+			*y += gLiquidCollisionTopOffset[thisNodePtr->Kind];
+		}
+		return true;
 	}
-	while (thisNodePtr != nil);
 
 	return false;
 }
 
 
+/***************** REGISTER LIQUID PATCH **********************/
+//
+// Adds the patch's collision box to the grid used by FindLiquidY.
+// A cell's mask has one bit per liquid mesh ID, so a patch is identified by its PatchMeshID.
+//
+
+static void SetLiquidPatchGridBits(const ObjNode *theNode, bool set)
+{
+	const CollisionBoxType* box = &theNode->CollisionBoxes[0];
+	uint32_t bit = 1u << theNode->PatchMeshID;
+
+	int left	= SDL_max(0, (int) floorf(box->left  * (1.0f / LIQUID_GRID_CELL_SIZE)));
+	int right	= SDL_min(LIQUID_GRID_WIDTH-1, (int) floorf(box->right * (1.0f / LIQUID_GRID_CELL_SIZE)));
+	int back	= SDL_max(0, (int) floorf(box->back  * (1.0f / LIQUID_GRID_CELL_SIZE)));
+	int front	= SDL_min(LIQUID_GRID_DEPTH-1, (int) floorf(box->front * (1.0f / LIQUID_GRID_CELL_SIZE)));
+
+	for (int row = back; row <= front; row++)
+	{
+		for (int col = left; col <= right; col++)
+		{
+			if (set)
+				gLiquidGrid[row][col] |= bit;
+			else
+				gLiquidGrid[row][col] &= ~bit;
+		}
+	}
+}
+
+static void RegisterLiquidPatch(ObjNode *theNode)
+{
+	GAME_ASSERT(theNode->PatchMeshID >= 0 && theNode->PatchMeshID < MAX_LIQUID_MESHES);
+	GAME_ASSERT(theNode->CollisionBoxes);
+	GAME_ASSERT(!gLiquidPatchNodes[theNode->PatchMeshID]);
+
+	gLiquidPatchNodes[theNode->PatchMeshID] = theNode;
+	SetLiquidPatchGridBits(theNode, true);
+}
+
+
+/***************** UNREGISTER LIQUID PATCH **********************/
+
+static void UnregisterLiquidPatch(ObjNode *theNode)
+{
+	if (gLiquidPatchNodes[theNode->PatchMeshID] != theNode)		// wasn't registered
+		return;
+
+	SetLiquidPatchGridBits(theNode, false);
+	gLiquidPatchNodes[theNode->PatchMeshID] = NULL;
+}
+
+
 #pragma mark -
 
 /************************* ADD WATER PATCH *********************************/
@@ -368,7 +449,7 @@ static const float	yTable2[] = {-540,-540,-540,-540,-370,-540,-540,-540};
 	gNewObjectDefinition.rot 	= 0;
 	gNewObjectDefinition.scale = 1.0;
 	if (tesselateFlag)
-		newObj = MakeNewCustomDrawObject(&gNewObjectDefinition, &bSphere, DrawWaterPatchTesselated);	
+		newObj = MakeNewCustomDrawObject(&gNewObjectDefinition, &bSphere, DrawLiquidPatchTesselated);
 	else
 		newObj = MakeNewCustomDrawObject(&gNewObjectDefinition, &bSphere, DrawWaterPatch);
 		
@@ -406,6 +487,8 @@ static const float	yTable2[] = {-540,-540,-540,-540,-370,-540,-540,-540};
 							depth*.5f * TERRAIN_POLYGON_SIZE,
 							-(depth*.5f) * TERRAIN_POLYGON_SIZE);
 
+	RegisterLiquidPatch(newObj);
+
 			/* SET MESH PROPERTIES */
 
 	TQ3TriMeshData* tmd = gLiquidMeshPtrs[newObj->PatchMeshID];
@@ -420,6 +503,9 @@ static const float	yTable2[] = {-540,-540,-540,-540,-370,-540,-540,-540};
 	tmd->texturingMode = kQ3TexturingModeAlphaBlend;
 	tmd->glTextureName = gLiquidShaders[LIQUID_WATER];
 
+	if (tesselateFlag)
+		BuildLiquidPatchGeometry(newObj);
+
 	return(true);													// item was added
 }
 
@@ -457,6 +543,9 @@ static void MoveLiquidPatch(ObjNode *theNode)
 			}
 			
 			UpdateObject(theNode);
+
+			if (theNode->TesselatePatch)			// static geometry must follow the water up
+				BuildLiquidPatchGeometry(theNode);
 		}
 	}
 }
@@ -602,147 +691,6 @@ TQ3Point3D		*p;
 	Render_SubmitMesh(tmd, nil, &theNode->RenderModifiers, &theNode->Coord);
 }
 
-/********************* DRAW WATER PATCH TESSELATED **********************/
-//
-// This version tesselates the water patch so fog will look better on it.
-//
-
-static void DrawWaterPatchTesselated(ObjNode *theNode)
-{
-float			x,y,z,left,back, right, front;
-float			u,v;
-TQ3Point3D		*p;
-int				width2,depth2,w,h,i;
-TQ3TriMeshTriangleData	*t;
-
-
-			/*********************/
-			/* SETUP ENVIRONMENT */
-			/*********************/
-
-	TQ3TriMeshData* tmd = gLiquidMeshPtrs[theNode->PatchMeshID];
-
-	const TQ3Param2D uvScroll = gLiquidUVOffsets[LIQUID_WATER];
-
-			/************************/
-			/* CALC BOUNDS OF WATER */
-			/************************/
-			
-	x = theNode->Coord.x;
-	y = theNode->Coord.y;
-	z = theNode->Coord.z;
-	
-	if ((theNode->PatchWidth & 1) || (theNode->PatchDepth & 1))		// widths cannot be odd!
-		DoFatalAlert("DrawWaterPatchTesselated: water patches cannot be odd sizes! Must be even numbers.");
-	
-	width2 = theNode->PatchWidth/2;
-	depth2 = theNode->PatchDepth/2;
-	
-	left = x - (float)(width2) * TERRAIN_POLYGON_SIZE;
-	right = left + (float)theNode->PatchWidth * TERRAIN_POLYGON_SIZE;
-	back = z - (float)(depth2) * TERRAIN_POLYGON_SIZE;
-	front = back + (float)theNode->PatchDepth * TERRAIN_POLYGON_SIZE;
-
-//	width = right - left;
-//	depth = front - back;
-	
-
-			/******************/
-			/* BUILD GEOMETRY */
-			/******************/
-
-		/**************************/
-		/* MAKE POINTS & UV ARRAY */
-		/**************************/
-
-	p = tmd->points;							// get ptr to points array
-	tmd->numPoints = (width2+1) * (depth2+1);	// calc # points in geometry
-	i = 0;
-
-	z = back;
-	v = 1.0f;
-
-	for (h = 0; h <= depth2; h++)
-	{
-		x = left;
-		u = 0;
-		for (w = 0; w <= width2; w++)
-		{
-				/* SET POINT */
-
-			p[i].x = x;
-			p[i].y = y;
-			p[i].z = z;
-			if ((h > 0) && (h < depth2) && (w > 0) && (w < width2))		// add random jitter to inner vertices
-			{
-				ApplyJitterToLiquidVertex(&p[i], LIQUID_WATER);
-			}
-
-				/* SET UV */
-
-			tmd->vertexUVs[i].u = uvScroll.u + u;
-			tmd->vertexUVs[i].v = uvScroll.v + v;
-
-			i++;
-			x += TERRAIN_POLYGON_SIZE*2.0f;	
-			u += .4f;
-		}
-
-		v -= .4f;
-		z += TERRAIN_POLYGON_SIZE*2.0f;
-	}
-
-
-			/* UPDATE BBOX */
-
-	tmd->bBox.min.x = left;
-	tmd->bBox.min.y = y;
-	tmd->bBox.min.z = back;
-	tmd->bBox.max.x = right;
-	tmd->bBox.max.y = y;
-	tmd->bBox.max.z = front;
-	tmd->bBox.isEmpty = false;
-
-
-		/**************************/
-		/* MAKE TRIANGLE INDECIES */
-		/**************************/
-
-	t = tmd->triangles;								// get ptr to triangle array
-	i = 0;
-	for (h = 0; h < depth2; h++)
-	{
-		for (w = 0; w < width2; w++)
-		{
-			int rw = width2+1;
-
-				/* TRIANGLE A */
-
-			t[i].pointIndices[0] = (h * rw) + w;			// far left
-			t[i].pointIndices[1] = ((h+1) * rw) + w;		// near left
-			t[i].pointIndices[2] = ((h+1) * rw) + w + 1;	// near right
-			i++;
-
-				/* TRIANGLE B */
-
-			t[i].pointIndices[0] = (h * rw) + w;			// far left
-			t[i].pointIndices[1] = ((h+1) * rw) + w + 1; 	// near right
-			t[i].pointIndices[2] = (h * rw) + w + 1;		// far right
-			i++;
-		}
-	}
-	tmd->numTriangles = i;						// set # triangles in geometry
-
-
-			/*************/
-			/* SUBMIT IT */
-			/*************/
-
-	Render_SubmitMesh(tmd, nil, &theNode->RenderModifiers, &theNode->Coord);
-}
-
-
-
 #pragma mark -
 
 
@@ -865,7 +813,7 @@ float				width,depth;
 	gNewObjectDefinition.moveCall = MoveLiquidPatch;
 	gNewObjectDefinition.rot 	= 0;
 	gNewObjectDefinition.scale = 1.0;
-	newObj = MakeNewCustomDrawObject(&gNewObjectDefinition, &bSphere, DrawSolidLiquidPatchTesselated);
+	newObj = MakeNewCustomDrawObject(&gNewObjectDefinition, &bSphere, DrawLiquidPatchTesselated);
 
 	if (newObj == nil)
 		return(false);
@@ -896,6 +844,8 @@ float				width,depth;
 							(depth*.5f) * TERRAIN_POLYGON_SIZE,
 							-(depth*.5f) * TERRAIN_POLYGON_SIZE);
 
+	RegisterLiquidPatch(newObj);
+
 			/* SET MESH PROPERTIES */
 
 	TQ3TriMeshData* tmd = gLiquidMeshPtrs[newObj->PatchMeshID];
@@ -904,94 +854,99 @@ float				width,depth;
 	tmd->texturingMode = kQ3TexturingModeOpaque;
 	tmd->glTextureName = gLiquidShaders[kind];
 
+	BuildLiquidPatchGeometry(newObj);
+
 
 	return(true);													// item was added
 }
 
-/********************* DRAW LIQUID PATCH TESSELATED **********************/
+/********************* BUILD LIQUID PATCH GEOMETRY **********************/
 //
-// This version tesselates the water patch so fog will look better on it.
+// Tesselates the liquid patch so fog will look better on it.
+//
+// The geometry is built once when the patch is created (and again if the patch moves).
+// The texture animation is applied at draw time through the render modifiers' UV offset,
+// so the vertex data stays static.
 //
 
-static void DrawSolidLiquidPatchTesselated(ObjNode *theNode)
+static void BuildLiquidPatchGeometry(ObjNode *theNode)
 {
-float			x,y,z,left,back, right, front;
-float			u,v;
+float			x,y,z,left,back,right,front;
+float			u,v,spacing;
 TQ3Point3D		*p;
-int				width2,depth2,w,h,i;
+int				numCols,numRows,w,h,i;
 TQ3TriMeshTriangleData	*t;
 
-
-			/*********************/
-			/* SETUP ENVIRONMENT */
-			/*********************/
-
 	TQ3TriMeshData* tmd = gLiquidMeshPtrs[theNode->PatchMeshID];
 
-	const TQ3Param2D uvOffset = gLiquidUVOffsets[theNode->Kind];
-
 			/*************************/
 			/* CALC BOUNDS OF LIQUID */
 			/*************************/
 
+	if (theNode->Kind == LIQUID_WATER)						// water quads span 2x2 tiles
+	{
+		if ((theNode->PatchWidth & 1) || (theNode->PatchDepth & 1))		// widths cannot be odd!
+			DoFatalAlert("BuildLiquidPatchGeometry: water patches cannot be odd sizes! Must be even numbers.");
+
+		numCols = theNode->PatchWidth/2;
+		numRows = theNode->PatchDepth/2;
+		spacing = TERRAIN_POLYGON_SIZE*2.0f;
+	}
+	else
+	{
+		numCols = theNode->PatchWidth;
+		numRows = theNode->PatchDepth;
+		spacing = TERRAIN_POLYGON_SIZE;
+	}
+
 	x = theNode->Coord.x;
 	y = theNode->Coord.y;
 	z = theNode->Coord.z;
 
-	width2 = theNode->PatchWidth;
-	depth2 = theNode->PatchDepth;
-
-	left = x - (width2*.5f) * TERRAIN_POLYGON_SIZE;
-	right = left + width2 * TERRAIN_POLYGON_SIZE;
-	back = z - (depth2*.5f) * TERRAIN_POLYGON_SIZE;
-	front = back + depth2 * TERRAIN_POLYGON_SIZE;
-
-//	width = right - left;
-//	depth = front - back;
-
+	left = x - (numCols*.5f) * spacing;
+	right = left + numCols * spacing;
+	back = z - (numRows*.5f) * spacing;
+	front = back + numRows * spacing;
 
-			/******************/
-			/* BUILD GEOMETRY */
-			/******************/
 
 		/**************************/
 		/* MAKE POINTS & UV ARRAY */
 		/**************************/
 
 	p = tmd->points;							// get ptr to points array
-	tmd->numPoints = (width2+1) * (depth2+1);	// calc # points in geometry
+	tmd->numPoints = (numCols+1) * (numRows+1);	// calc # points in geometry
 	i = 0;
 
 	z = back;
 	v = 1.0f;
 
-	for (h = 0; h <= depth2; h++)
+	for (h = 0; h <= numRows; h++)
 	{
 		x = left;
 		u = 0;
-		for (w = 0; w <= width2; w++)
+		for (w = 0; w <= numCols; w++)
 		{
 				/* SET POINT */
 
 			p[i].x = x;
 			p[i].y = y;
 			p[i].z = z;
-			if ((h > 0) && (h < depth2) && (w > 0) && (w < width2))		// add random jitter to inner vertices
+			if ((h > 0) && (h < numRows) && (w > 0) && (w < numCols))		// add random jitter to inner vertices
 			{
 				ApplyJitterToLiquidVertex(&p[i], theNode->Kind);
 			}
 
 				/* SET UV */
 
-			tmd->vertexUVs[i].u = uvOffset.u + u;
-			tmd->vertexUVs[i].v = uvOffset.v + v;
+			tmd->vertexUVs[i].u = u;
+			tmd->vertexUVs[i].v = v;
 
 			i++;
-			x += TERRAIN_POLYGON_SIZE;
+			x += spacing;
 			u += .4f;
 		}
 		v -= .4f;
-		z += TERRAIN_POLYGON_SIZE;
+		z += spacing;
 	}
 
 
@@ -1012,11 +967,11 @@ TQ3TriMeshTriangleData	*t;
 
 	t = tmd->triangles;								// get ptr to triangle array
 	i = 0;
-	for (h = 0; h < depth2; h++)
+	for (h = 0; h < numRows; h++)
 	{
-		for (w = 0; w < width2; w++)
+		for (w = 0; w < numCols; w++)
 		{
-			int rw = width2+1;
+			int rw = numCols+1;
 			
 				/* TRIANGLE A */
 				
@@ -1034,11 +989,16 @@ TQ3TriMeshTriangleData	*t;
 		}
 	}
 	tmd->numTriangles = i;						// set # triangles in geometry
+}
 
 
-			/*************/
-			/* SUBMIT IT */
-			/*************/
+/********************* DRAW LIQUID PATCH TESSELATED **********************/
+
+static void DrawLiquidPatchTesselated(ObjNode *theNode)
+{
+	TQ3TriMeshData* tmd = gLiquidMeshPtrs[theNode->PatchMeshID];
+
+	theNode->RenderModifiers.uvOffset = gLiquidUVOffsets[theNode->Kind];		// scroll texture
 
 	Render_SubmitMesh(tmd, nil, &theNode->RenderModifiers, &theNode->Coord);
 }
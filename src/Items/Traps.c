@@ -902,7 +902,7 @@ ObjNode	*newObj;
 	gNewObjectDefinition.moveCall 	= MoveShockwave;
 	gNewObjectDefinition.rot 		= 0;
 	gNewObjectDefinition.scale 		= startScale;
-	newObj = MakeNewDisplayGroupObject(&gNewObjectDefinition);
+	newObj = MakePooledEffect(EFFECT_POOL_SHOCKWAVE, &gNewObjectDefinition);
 	if (newObj == nil)
 		return;
 
@@ -930,7 +930,7 @@ float	s;
 
 	if (theNode->Health <= 0.0f)
 	{
-		DeleteObject(theNode);
+		ReleasePooledEffect(EFFECT_POOL_SHOCKWAVE, theNode);
 		return;
 	}
 	
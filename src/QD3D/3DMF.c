@@ -13,20 +13,95 @@
 
 
 /****************************/
-/*    PROTOTYPES            */
+/*    CONSTANTS             */
 /****************************/
 
+#define	FLAT_MODEL_VERSION		1					// bump when the flat model payload changes
+#define	FLAT_MODEL_ALIGNMENT	16
+
 
 /****************************/
-/*    CONSTANTS             */
+/*    TYPES                 */
+/****************************/
+
+		/* FLAT MODEL PAYLOAD */
+		//
+		// A parsed 3DMF, flattened into one position-independent block.
+		// Each block is located by its byte offset from the start of the payload (0 = absent).
+		// The mesh arrays & texture pixmaps are used in place, so they are kept aligned.
+		//
+
+typedef struct
+{
+	int32_t				numTextures;
+	int32_t				numMeshes;
+	int32_t				numTopLevelGroups;
+	uint32_t			texturesOffset;						// FlatModelTexture[numTextures]
+	uint32_t			meshesOffset;						// FlatModelMesh[numMeshes]
+	uint32_t			groupsOffset;						// FlatModelGroup[numTopLevelGroups]
+} FlatModelHeader;
+
+typedef struct
+{
+	int32_t				pixelType;
+	int32_t				width;
+	int32_t				height;
+	int32_t				rowBytes;
+	int32_t				pixelSize;
+	int32_t				byteOrder;
+	int32_t				bitOrder;
+	int32_t				boundaryU;
+	int32_t				boundaryV;
+	uint32_t			imageOffset;
+} FlatModelTexture;
+
+typedef struct
+{
+	int32_t				numTriangles;
+	int32_t				numPoints;
+	int32_t				internalTextureID;
+	uint32_t			texturingMode;
+	TQ3ColorRGBA		diffuseColor;
+	TQ3BoundingBox		bBox;
+	Byte				hasVertexNormals;
+	Byte				hasVertexColors;
+	uint32_t			trianglesOffset;
+	uint32_t			pointsOffset;
+	uint32_t			normalsOffset;
+	uint32_t			uvsOffset;
+	uint32_t			colorsOffset;
+} FlatModelMesh;
+
+typedef struct
+{
+	int32_t				numMeshes;
+	uint32_t			meshIndicesOffset;					// int32_t[numMeshes]: indices into the mesh list
+	TQ3BoundingSphere	boundingSphere;						// precomputed bounds of the whole group
+	TQ3BoundingBox		boundingBox;
+} FlatModelGroup;
+
+
+/****************************/
+/*    PROTOTYPES            */
 /****************************/
 
+static void PrepareGrouped3DMF(const FSSpec *spec, Byte groupNum);
+static void UploadGrouped3DMFTextures(Byte groupNum);
+static void LoadGrouped3DMF_Work(void* userData);
+static void LoadGrouped3DMF_Finish(void* userData);
+static uint32_t ReserveFlatModelBlock(uint32_t* size, size_t blockSize);
+static Boolean FlatModelBlockFits(uint32_t offset, long count, size_t elementSize, long payloadSize);
+static void SaveFlatModel(const FSSpec* spec, const TQ3MetaFile* metaFile, const uint64_t* sourceHash);
+static TQ3MetaFile* LoadFlatModel(const FSSpec* spec, const uint64_t* sourceHash, Ptr* outPayload);
+
 
 /*********************/
 /*    VARIABLES      */
 /*********************/
 
 TQ3MetaFile*				gObjectGroupFile[MAX_3DMF_GROUPS];
+static Ptr					gObjectGroupFlatPayload[MAX_3DMF_GROUPS];		// non-nil if the group was loaded from its flat model
+static FSSpec				gPendingGroupSpecs[MAX_3DMF_GROUPS];			// files for QueueGrouped3DMFLoad
 GLuint*						gObjectGroupTextures[MAX_3DMF_GROUPS];
 TQ3TriMeshFlatGroup			gObjectGroupList[MAX_3DMF_GROUPS][MAX_OBJECTS_IN_GROUP];
 TQ3BoundingSphere	gObjectGroupRadiusList[MAX_3DMF_GROUPS][MAX_OBJECTS_IN_GROUP];
@@ -41,6 +116,7 @@ void Init3DMFManager(void)
 	for (int i = 0; i < MAX_3DMF_GROUPS; i++)
 	{
 		gObjectGroupFile[i] = nil;
+		gObjectGroupFlatPayload[i] = nil;
 		gObjectGroupTextures[i] = nil;
 		gNumObjectsInGroupList[i] = 0;
 	}
@@ -57,6 +133,47 @@ void Init3DMFManager(void)
 
 
 void LoadGrouped3DMF(FSSpec *spec, Byte groupNum)
+{
+	PrepareGrouped3DMF(spec, groupNum);
+	UploadGrouped3DMFTextures(groupNum);
+}
+
+
+/******************** QUEUE GROUPED 3DMF LOAD ***********************/
+//
+// Same as LoadGrouped3DMF, but the geometry is loaded by a worker thread
+// and the textures are uploaded once the main thread runs the job's finish proc.
+//
+
+Job* QueueGrouped3DMFLoad(const FSSpec *spec, Byte groupNum)
+{
+	GAME_ASSERT(groupNum < MAX_3DMF_GROUPS);
+
+	gPendingGroupSpecs[groupNum] = *spec;
+
+	return Jobs_Add(LoadGrouped3DMF_Work, LoadGrouped3DMF_Finish, (void*) (intptr_t) groupNum, 0, NULL);
+}
+
+static void LoadGrouped3DMF_Work(void* userData)
+{
+	Byte groupNum = (Byte) (intptr_t) userData;
+	PrepareGrouped3DMF(&gPendingGroupSpecs[groupNum], groupNum);
+}
+
+static void LoadGrouped3DMF_Finish(void* userData)
+{
+	Byte groupNum = (Byte) (intptr_t) userData;
+	UploadGrouped3DMFTextures(groupNum);
+}
+
+
+/******************** PREPARE GROUPED 3DMF ***********************/
+//
+// CPU side of LoadGrouped3DMF: loads the geometry & builds the object list.
+// Doesn't touch OpenGL, so it may run on a worker thread.
+//
+
+static void PrepareGrouped3DMF(const FSSpec *spec, Byte groupNum)
 {
 	GAME_ASSERT(groupNum < MAX_3DMF_GROUPS);
 
@@ -66,16 +183,11 @@ void LoadGrouped3DMF(FSSpec *spec, Byte groupNum)
 
 			/* LOAD NEW GEOMETRY */
 
-	TQ3MetaFile* the3DMFFile = Q3MetaFile_Load3DMF(spec);
-	GAME_ASSERT(the3DMFFile);
+	Ptr flatPayload = nil;
+	TQ3MetaFile* the3DMFFile = Load3DMFWithFlatCache(spec, &flatPayload);
 
 	gObjectGroupFile[groupNum] = the3DMFFile;
-
-			/* UPLOAD TEXTURES TO GPU */
-
-	gObjectGroupTextures[groupNum] = (GLuint*) NewPtrClear(the3DMFFile->numTextures * sizeof(GLuint));
-
-	Render_Load3DMFTextures(the3DMFFile, gObjectGroupTextures[groupNum], false);
+	gObjectGroupFlatPayload[groupNum] = flatPayload;
 
 			/* BUILD OBJECT LIST */
 
@@ -94,14 +206,41 @@ void LoadGrouped3DMF(FSSpec *spec, Byte groupNum)
 		GAME_ASSERT(0 != meshList.numMeshes);
 		GAME_ASSERT(nil != meshList.meshes);
 
-		QD3D_CalcObjectBoundingSphere(meshList.numMeshes, meshList.meshes, &gObjectGroupRadiusList[groupNum][i]);
-		QD3D_CalcObjectBoundingBox(meshList.numMeshes, meshList.meshes, &gObjectGroupBBoxList[groupNum][i]); // save bbox
+		if (flatPayload)												// bounds were precomputed in the flat model
+		{
+			const FlatModelHeader* header = (const FlatModelHeader*) flatPayload;
+			const FlatModelGroup* flatGroup = (const FlatModelGroup*) (flatPayload + header->groupsOffset);
+			gObjectGroupRadiusList[groupNum][i] = flatGroup[i].boundingSphere;
+			gObjectGroupBBoxList[groupNum][i] = flatGroup[i].boundingBox;
+		}
+		else
+		{
+			QD3D_CalcObjectBoundingSphere(meshList.numMeshes, meshList.meshes, &gObjectGroupRadiusList[groupNum][i]);
+			QD3D_CalcObjectBoundingBox(meshList.numMeshes, meshList.meshes, &gObjectGroupBBoxList[groupNum][i]); // save bbox
+		}
 	}
 
 	gNumObjectsInGroupList[groupNum] = nObjects;					// set # objects.
 }
 
 
+/******************** UPLOAD GROUPED 3DMF TEXTURES ***********************/
+//
+// GL side of LoadGrouped3DMF. Main thread only.
+//
+
+static void UploadGrouped3DMFTextures(Byte groupNum)
+{
+	TQ3MetaFile* the3DMFFile = gObjectGroupFile[groupNum];
+	GAME_ASSERT(the3DMFFile);
+	GAME_ASSERT(!gObjectGroupTextures[groupNum]);
+
+	gObjectGroupTextures[groupNum] = (GLuint*) NewPtrClear(the3DMFFile->numTextures * sizeof(GLuint));
+
+	Render_Load3DMFTextures(the3DMFFile, gObjectGroupTextures[groupNum], false);
+}
+
+
 /******************** DELETE 3DMF GROUP **************************/
 
 void Free3DMFGroup(Byte groupNum)
@@ -109,15 +248,16 @@ void Free3DMFGroup(Byte groupNum)
 	if (gObjectGroupTextures[groupNum] != nil)
 	{
 		GAME_ASSERT(gObjectGroupFile[groupNum] != nil);
-		glDeleteTextures(gObjectGroupFile[groupNum]->numTextures, gObjectGroupTextures[groupNum]);
+		Render_DeleteTextures(gObjectGroupFile[groupNum]->numTextures, gObjectGroupTextures[groupNum]);
 		DisposePtr((Ptr) gObjectGroupTextures[groupNum]);
 		gObjectGroupTextures[groupNum] = nil;
 	}
 
 	if (gObjectGroupFile[groupNum] != nil)
 	{
-		Q3MetaFile_Dispose(gObjectGroupFile[groupNum]);
+		Dispose3DMFWithFlatCache(gObjectGroupFile[groupNum], gObjectGroupFlatPayload[groupNum]);
 		gObjectGroupFile[groupNum] = nil;
+		gObjectGroupFlatPayload[groupNum] = nil;
 	}
 
 	SDL_memset(gObjectGroupList[groupNum], 0, sizeof(gObjectGroupList[groupNum]));	// make sure to init the entire list to be safe
@@ -138,3 +278,389 @@ short	i;
 			Free3DMFGroup(i);
 	}
 }
+
+
+#pragma mark -
+
+/******************** LOAD 3DMF WITH FLAT CACHE ***********************/
+//
+// Loads a 3DMF from its flat model in the cache if it's up to date,
+// otherwise parses the 3DMF and flattens it for next time.
+//
+// OUTPUT:	the 3DMF.
+//			*outFlatPayload = flat model backing the 3DMF's arrays (nil if the 3DMF was parsed).
+//			Pass both to Dispose3DMFWithFlatCache when done.
+//
+
+TQ3MetaFile* Load3DMFWithFlatCache(const FSSpec* spec, Ptr* outFlatPayload)
+{
+	uint64_t sourceHash = Cache_HashFile(spec, false);
+
+	TQ3MetaFile* metaFile = LoadFlatModel(spec, &sourceHash, outFlatPayload);
+	if (metaFile)
+		return metaFile;
+
+			/* FALL BACK TO THE 3DMF PARSER */
+
+	*outFlatPayload = nil;
+
+	Jobs_LockFiles();
+	metaFile = Q3MetaFile_Load3DMF(spec);
+	Jobs_UnlockFiles();
+	GAME_ASSERT(metaFile);
+
+	SaveFlatModel(spec, metaFile, &sourceHash);
+
+	return metaFile;
+}
+
+
+/******************** DISPOSE 3DMF WITH FLAT CACHE ***********************/
+
+void Dispose3DMFWithFlatCache(TQ3MetaFile* metaFile, Ptr flatPayload)
+{
+	if (flatPayload)
+	{
+		DisposePtr((Ptr) metaFile);							// the metafile, its meshes & pixmaps were allocated as one block
+		DisposePtr(flatPayload);
+	}
+	else
+	{
+		Q3MetaFile_Dispose(metaFile);
+	}
+}
+
+
+/******************** RESERVE FLAT MODEL BLOCK ***********************/
+//
+// Returns the offset of a new block at the end of the payload.
+//
+
+static uint32_t ReserveFlatModelBlock(uint32_t* size, size_t blockSize)
+{
+	uint32_t offset = (*size + (FLAT_MODEL_ALIGNMENT-1)) & ~(FLAT_MODEL_ALIGNMENT-1);
+	*size = offset + (uint32_t) blockSize;
+	return offset;
+}
+
+
+/******************** FLAT MODEL BLOCK FITS ***********************/
+
+static Boolean FlatModelBlockFits(uint32_t offset, long count, size_t elementSize, long payloadSize)
+{
+	return count >= 0
+		&& offset >= sizeof(FlatModelHeader)
+		&& (offset & (FLAT_MODEL_ALIGNMENT-1)) == 0
+		&& (uint64_t) offset + (uint64_t) count * elementSize <= (uint64_t) payloadSize;
+}
+
+
+/******************** SAVE FLAT MODEL ***********************/
+//
+// Flattens a freshly-parsed 3DMF (before its textures are uploaded) into the cache.
+//
+
+static void SaveFlatModel(const FSSpec* spec, const TQ3MetaFile* metaFile, const uint64_t* sourceHash)
+{
+FlatModelHeader	header;
+uint32_t		payloadSize = sizeof(FlatModelHeader);
+char			cacheName[64];
+
+			/* LAY OUT THE PAYLOAD */
+
+	SDL_memset(&header, 0, sizeof(header));
+	header.numTextures			= metaFile->numTextures;
+	header.numMeshes			= metaFile->numMeshes;
+	header.numTopLevelGroups	= metaFile->numTopLevelGroups;
+	header.texturesOffset		= ReserveFlatModelBlock(&payloadSize, metaFile->numTextures * sizeof(FlatModelTexture));
+	header.meshesOffset			= ReserveFlatModelBlock(&payloadSize, metaFile->numMeshes * sizeof(FlatModelMesh));
+	header.groupsOffset			= ReserveFlatModelBlock(&payloadSize, metaFile->numTopLevelGroups * sizeof(FlatModelGroup));
+
+	FlatModelTexture* flatTextures = (FlatModelTexture*) NewPtrClear(metaFile->numTextures * sizeof(FlatModelTexture));
+	FlatModelMesh* flatMeshes = (FlatModelMesh*) NewPtrClear(metaFile->numMeshes * sizeof(FlatModelMesh));
+	FlatModelGroup* flatGroups = (FlatModelGroup*) NewPtrClear(metaFile->numTopLevelGroups * sizeof(FlatModelGroup));
+	GAME_ASSERT(flatTextures && flatMeshes && flatGroups);
+
+	for (int i = 0; i < metaFile->numTextures; i++)
+	{
+		const TQ3TextureShader* shader = &metaFile->textures[i];
+		const TQ3Pixmap* pixmap = shader->pixmap;
+		GAME_ASSERT(pixmap);
+
+		flatTextures[i].pixelType	= pixmap->pixelType;
+		flatTextures[i].width		= pixmap->width;
+		flatTextures[i].height		= pixmap->height;
+		flatTextures[i].rowBytes	= pixmap->rowBytes;
+		flatTextures[i].pixelSize	= pixmap->pixelSize;
+		flatTextures[i].byteOrder	= pixmap->byteOrder;
+		flatTextures[i].bitOrder	= pixmap->bitOrder;
+		flatTextures[i].boundaryU	= shader->boundaryU;
+		flatTextures[i].boundaryV	= shader->boundaryV;
+		flatTextures[i].imageOffset	= ReserveFlatModelBlock(&payloadSize, pixmap->rowBytes * pixmap->height);
+	}
+
+	for (int i = 0; i < metaFile->numMeshes; i++)
+	{
+		const TQ3TriMeshData* mesh = metaFile->meshes[i];
+		FlatModelMesh* flatMesh = &flatMeshes[i];
+
+		flatMesh->numTriangles		= mesh->numTriangles;
+		flatMesh->numPoints			= mesh->numPoints;
+		flatMesh->internalTextureID	= mesh->internalTextureID;
+		flatMesh->texturingMode		= mesh->texturingMode;
+		flatMesh->diffuseColor		= mesh->diffuseColor;
+		flatMesh->bBox				= mesh->bBox;
+		flatMesh->hasVertexNormals	= mesh->hasVertexNormals;
+		flatMesh->hasVertexColors	= mesh->hasVertexColors;
+
+		flatMesh->trianglesOffset	= ReserveFlatModelBlock(&payloadSize, mesh->numTriangles * sizeof(TQ3TriMeshTriangleData));
+		flatMesh->pointsOffset		= ReserveFlatModelBlock(&payloadSize, mesh->numPoints * sizeof(TQ3Point3D));
+		if (mesh->vertexNormals)
+			flatMesh->normalsOffset	= ReserveFlatModelBlock(&payloadSize, mesh->numPoints * sizeof(TQ3Vector3D));
+		if (mesh->vertexUVs)
+			flatMesh->uvsOffset		= ReserveFlatModelBlock(&payloadSize, mesh->numPoints * sizeof(TQ3Param2D));
+		if (mesh->vertexColors)
+			flatMesh->colorsOffset	= ReserveFlatModelBlock(&payloadSize, mesh->numPoints * sizeof(TQ3ColorRGBA));
+	}
+
+	for (int i = 0; i < metaFile->numTopLevelGroups; i++)
+	{
+		const TQ3TriMeshFlatGroup* group = &metaFile->topLevelGroups[i];
+
+		flatGroups[i].numMeshes			= group->numMeshes;
+		flatGroups[i].meshIndicesOffset	= ReserveFlatModelBlock(&payloadSize, group->numMeshes * sizeof(int32_t));
+
+		if (group->numMeshes > 0)
+		{
+			QD3D_CalcObjectBoundingSphere(group->numMeshes, group->meshes, &flatGroups[i].boundingSphere);
+			QD3D_CalcObjectBoundingBox(group->numMeshes, group->meshes, &flatGroups[i].boundingBox);
+		}
+	}
+
+			/* COPY EVERYTHING IN */
+
+	Ptr payload = NewPtrClear(payloadSize);
+	GAME_ASSERT(payload);
+
+	SDL_memcpy(payload, &header, sizeof(header));
+	SDL_memcpy(payload + header.texturesOffset, flatTextures, metaFile->numTextures * sizeof(FlatModelTexture));
+	SDL_memcpy(payload + header.meshesOffset, flatMeshes, metaFile->numMeshes * sizeof(FlatModelMesh));
+	SDL_memcpy(payload + header.groupsOffset, flatGroups, metaFile->numTopLevelGroups * sizeof(FlatModelGroup));
+
+	for (int i = 0; i < metaFile->numTextures; i++)
+	{
+		const TQ3Pixmap* pixmap = metaFile->textures[i].pixmap;
+		SDL_memcpy(payload + flatTextures[i].imageOffset, pixmap->image, pixmap->rowBytes * pixmap->height);
+	}
+
+	for (int i = 0; i < metaFile->numMeshes; i++)
+	{
+		const TQ3TriMeshData* mesh = metaFile->meshes[i];
+		const FlatModelMesh* flatMesh = &flatMeshes[i];
+
+		SDL_memcpy(payload + flatMesh->trianglesOffset, mesh->triangles, mesh->numTriangles * sizeof(TQ3TriMeshTriangleData));
+		SDL_memcpy(payload + flatMesh->pointsOffset, mesh->points, mesh->numPoints * sizeof(TQ3Point3D));
+		if (mesh->vertexNormals)
+			SDL_memcpy(payload + flatMesh->normalsOffset, mesh->vertexNormals, mesh->numPoints * sizeof(TQ3Vector3D));
+		if (mesh->vertexUVs)
+			SDL_memcpy(payload + flatMesh->uvsOffset, mesh->vertexUVs, mesh->numPoints * sizeof(TQ3Param2D));
+		if (mesh->vertexColors)
+			SDL_memcpy(payload + flatMesh->colorsOffset, mesh->vertexColors, mesh->numPoints * sizeof(TQ3ColorRGBA));
+	}
+
+	Boolean ok = true;
+
+	for (int i = 0; ok && i < metaFile->numTopLevelGroups; i++)
+	{
+		const TQ3TriMeshFlatGroup* group = &metaFile->topLevelGroups[i];
+		int32_t* meshIndices = (int32_t*) (payload + flatGroups[i].meshIndicesOffset);
+
+		for (int j = 0; ok && j < group->numMeshes; j++)			// turn the group's mesh pointers into indices
+		{
+			meshIndices[j] = -1;
+			for (int k = 0; k < metaFile->numMeshes; k++)
+			{
+				if (metaFile->meshes[k] == group->meshes[j])
+				{
+					meshIndices[j] = k;
+					break;
+				}
+			}
+			ok = meshIndices[j] >= 0;								// group refers to a mesh outside the list; can't flatten that
+		}
+	}
+
+			/* WRITE IT OUT */
+
+	if (ok)
+	{
+		SDL_snprintf(cacheName, sizeof(cacheName), "Model-%s", spec->cName);
+		Cache_Save(cacheName, FLAT_MODEL_VERSION, sourceHash, 1, payload, payloadSize);
+	}
+
+	DisposePtr(payload);
+	DisposePtr((Ptr) flatTextures);
+	DisposePtr((Ptr) flatMeshes);
+	DisposePtr((Ptr) flatGroups);
+}
+
+
+/******************** LOAD FLAT MODEL ***********************/
+//
+// Rebuilds a TQ3MetaFile whose meshes & pixmaps point straight into the flat model's payload.
+// The metafile, its texture shaders, pixmaps, meshes and mesh lists are allocated as a single block.
+//
+// OUTPUT:	nil if there's no up-to-date flat model for this 3DMF.
+//
+
+static TQ3MetaFile* LoadFlatModel(const FSSpec* spec, const uint64_t* sourceHash, Ptr* outPayload)
+{
+char			cacheName[64];
+long			payloadSize = 0;
+uint32_t		blockSize = 0;
+long			totalGroupMeshes = 0;
+
+	SDL_snprintf(cacheName, sizeof(cacheName), "Model-%s", spec->cName);
+
+	Ptr payload = Cache_Load(cacheName, FLAT_MODEL_VERSION, sourceHash, 1, &payloadSize);
+	if (!payload)
+		return nil;
+
+			/* VALIDATE THE LAYOUT */
+
+	const FlatModelHeader* header = (const FlatModelHeader*) payload;
+
+	if (payloadSize < (long) sizeof(FlatModelHeader)
+		|| !FlatModelBlockFits(header->texturesOffset, header->numTextures, sizeof(FlatModelTexture), payloadSize)
+		|| !FlatModelBlockFits(header->meshesOffset, header->numMeshes, sizeof(FlatModelMesh), payloadSize)
+		|| !FlatModelBlockFits(header->groupsOffset, header->numTopLevelGroups, sizeof(FlatModelGroup), payloadSize))
+	{
+		goto stale;
+	}
+
+	const FlatModelTexture* flatTextures = (const FlatModelTexture*) (payload + header->texturesOffset);
+	const FlatModelMesh* flatMeshes = (const FlatModelMesh*) (payload + header->meshesOffset);
+	const FlatModelGroup* flatGroups = (const FlatModelGroup*) (payload + header->groupsOffset);
+
+	for (int i = 0; i < header->numTextures; i++)
+	{
+		if (flatTextures[i].height < 0
+			|| !FlatModelBlockFits(flatTextures[i].imageOffset, flatTextures[i].height, flatTextures[i].rowBytes, payloadSize))
+			goto stale;
+	}
+
+	for (int i = 0; i < header->numMeshes; i++)
+	{
+		const FlatModelMesh* m = &flatMeshes[i];
+		if (!FlatModelBlockFits(m->trianglesOffset, m->numTriangles, sizeof(TQ3TriMeshTriangleData), payloadSize)
+			|| !FlatModelBlockFits(m->pointsOffset, m->numPoints, sizeof(TQ3Point3D), payloadSize)
+			|| (m->normalsOffset && !FlatModelBlockFits(m->normalsOffset, m->numPoints, sizeof(TQ3Vector3D), payloadSize))
+			|| (m->uvsOffset && !FlatModelBlockFits(m->uvsOffset, m->numPoints, sizeof(TQ3Param2D), payloadSize))
+			|| (m->colorsOffset && !FlatModelBlockFits(m->colorsOffset, m->numPoints, sizeof(TQ3ColorRGBA), payloadSize)))
+			goto stale;
+	}
+
+	for (int i = 0; i < header->numTopLevelGroups; i++)
+	{
+		if (!FlatModelBlockFits(flatGroups[i].meshIndicesOffset, flatGroups[i].numMeshes, sizeof(int32_t), payloadSize))
+			goto stale;
+
+		const int32_t* meshIndices = (const int32_t*) (payload + flatGroups[i].meshIndicesOffset);
+		for (int j = 0; j < flatGroups[i].numMeshes; j++)
+		{
+			if (meshIndices[j] < 0 || meshIndices[j] >= header->numMeshes)
+				goto stale;
+		}
+
+		totalGroupMeshes += flatGroups[i].numMeshes;
+	}
+
+			/* ALLOCATE THE METAFILE & ITS STRUCTS AS ONE BLOCK */
+
+	uint32_t metaFileOffset		= ReserveFlatModelBlock(&blockSize, sizeof(TQ3MetaFile));
+	uint32_t shadersOffset		= ReserveFlatModelBlock(&blockSize, header->numTextures * sizeof(TQ3TextureShader));
+	uint32_t pixmapsOffset		= ReserveFlatModelBlock(&blockSize, header->numTextures * sizeof(TQ3Pixmap));
+	uint32_t meshesOffset		= ReserveFlatModelBlock(&blockSize, header->numMeshes * sizeof(TQ3TriMeshData));
+	uint32_t meshPtrsOffset		= ReserveFlatModelBlock(&blockSize, header->numMeshes * sizeof(TQ3TriMeshData*));
+	uint32_t groupsOffset		= ReserveFlatModelBlock(&blockSize, header->numTopLevelGroups * sizeof(TQ3TriMeshFlatGroup));
+	uint32_t groupMeshPtrsOffset = ReserveFlatModelBlock(&blockSize, totalGroupMeshes * sizeof(TQ3TriMeshData*));
+
+	Ptr block = NewPtrClear(blockSize);
+	GAME_ASSERT(block);
+
+	TQ3MetaFile* metaFile			= (TQ3MetaFile*) (block + metaFileOffset);
+	TQ3Pixmap* pixmaps				= (TQ3Pixmap*) (block + pixmapsOffset);
+	TQ3TriMeshData* meshes			= (TQ3TriMeshData*) (block + meshesOffset);
+	TQ3TriMeshData** groupMeshPtrs	= (TQ3TriMeshData**) (block + groupMeshPtrsOffset);
+
+	metaFile->numTextures			= header->numTextures;
+	metaFile->textures				= (TQ3TextureShader*) (block + shadersOffset);
+	metaFile->numMeshes				= header->numMeshes;
+	metaFile->meshes				= (TQ3TriMeshData**) (block + meshPtrsOffset);
+	metaFile->numTopLevelGroups		= header->numTopLevelGroups;
+	metaFile->topLevelGroups		= (TQ3TriMeshFlatGroup*) (block + groupsOffset);
+
+			/* POINT THE PIXMAPS INTO THE PAYLOAD */
+
+	for (int i = 0; i < header->numTextures; i++)
+	{
+		const FlatModelTexture* t = &flatTextures[i];
+
+		pixmaps[i].pixelType	= t->pixelType;
+		pixmaps[i].width		= t->width;
+		pixmaps[i].height		= t->height;
+		pixmaps[i].rowBytes		= t->rowBytes;
+		pixmaps[i].pixelSize	= t->pixelSize;
+		pixmaps[i].byteOrder	= t->byteOrder;
+		pixmaps[i].bitOrder		= t->bitOrder;
+		pixmaps[i].image		= (uint8_t*) (payload + t->imageOffset);
+
+		metaFile->textures[i].pixmap	= &pixmaps[i];
+		metaFile->textures[i].boundaryU	= t->boundaryU;
+		metaFile->textures[i].boundaryV	= t->boundaryV;
+	}
+
+			/* POINT THE MESHES INTO THE PAYLOAD */
+
+	for (int i = 0; i < header->numMeshes; i++)
+	{
+		const FlatModelMesh* m = &flatMeshes[i];
+		TQ3TriMeshData* mesh = &meshes[i];
+
+		mesh->numTriangles		= m->numTriangles;
+		mesh->triangles			= (TQ3TriMeshTriangleData*) (payload + m->trianglesOffset);
+		mesh->numPoints			= m->numPoints;
+		mesh->points			= (TQ3Point3D*) (payload + m->pointsOffset);
+		mesh->vertexNormals		= m->normalsOffset ? (TQ3Vector3D*) (payload + m->normalsOffset) : nil;
+		mesh->vertexUVs			= m->uvsOffset ? (TQ3Param2D*) (payload + m->uvsOffset) : nil;
+		mesh->vertexColors		= m->colorsOffset ? (TQ3ColorRGBA*) (payload + m->colorsOffset) : nil;
+		mesh->bBox				= m->bBox;
+		mesh->internalTextureID	= m->internalTextureID;
+		mesh->texturingMode		= m->texturingMode;
+		mesh->diffuseColor		= m->diffuseColor;
+		mesh->hasVertexNormals	= m->hasVertexNormals;
+		mesh->hasVertexColors	= m->hasVertexColors;
+
+		metaFile->meshes[i] = mesh;
+	}
+
+	for (int i = 0; i < header->numTopLevelGroups; i++)
+	{
+		const int32_t* meshIndices = (const int32_t*) (payload + flatGroups[i].meshIndicesOffset);
+
+		metaFile->topLevelGroups[i].numMeshes = flatGroups[i].numMeshes;
+		metaFile->topLevelGroups[i].meshes = groupMeshPtrs;
+
+		for (int j = 0; j < flatGroups[i].numMeshes; j++)
+			*groupMeshPtrs++ = metaFile->meshes[meshIndices[j]];
+	}
+
+	GAME_ASSERT((Ptr) metaFile == block);							// Dispose3DMFWithFlatCache frees the block through the metafile
+
+	*outPayload = payload;
+	return metaFile;
+
+stale:
+	DisposePtr(payload);
+	return nil;
+}
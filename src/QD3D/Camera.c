@@ -168,7 +168,7 @@ void DisposeLensFlares(void)
 
 	if (gMoonFlareTextureName)							// nuke any old moon shader
 	{
-		glDeleteTextures(1, &gMoonFlareTextureName);
+		Render_DeleteTextures(1, &gMoonFlareTextureName);
 		gMoonFlareTextureName = 0;
 	}
 
@@ -178,7 +178,7 @@ void DisposeLensFlares(void)
 	{
 		if (gLensFlareTextureNames[i])
 		{
-			glDeleteTextures(1, &gLensFlareTextureNames[i]);
+			Render_DeleteTextures(1, &gLensFlareTextureNames[i]);
 			gLensFlareTextureNames[i] = 0;
 		}
 	}
@@ -21,33 +21,45 @@
 /*    CONSTANTS             */
 /****************************/
 
-#define ENVMAP_MAX_VERTICES_PER_MESH	5000
-
 /*********************/
 /*    VARIABLES      */
 /*********************/
 
-TQ3Param2D				gEnvMapUVs[ENVMAP_MAX_VERTICES_PER_MESH];
+static TQ3Param2D*		gEnvMapUVs = NULL;
+static int				gEnvMapUVCapacity = 0;
 
 /****************************** ENVIRONMENT MAP TRI MESH *****************************************/
 //
-// After calling this function, draw your trimesh using gEnvMapUVs as texture coordinates
-// (instead of the trimesh's actual UVs)
+// CPU fallback for when the renderer can't generate sphere map coordinates on the GPU.
+// Computes the same thing as GL_SPHERE_MAP texgen, in eye space, so reflective models
+// look the same whichever path the driver ends up on.
+// Returns the UVs to draw your trimesh with (instead of the trimesh's actual UVs).
+// They're only valid until the next call.
+//
 
-void EnvironmentMapTriMesh(
+const TQ3Param2D* EnvironmentMapTriMesh(
 		const TQ3TriMeshData *mesh,
 		const TQ3Matrix4x4* transform)
 {
-	if (mesh->texturingMode == kQ3TexturingModeOff)
-		return;
-
+	TQ3Matrix4x4		modelToView;
 	TQ3Matrix4x4		invTranspose;
-	const TQ3Point3D*	camCoord = &gGameViewInfoPtr->currentCameraCoords;
 
 	GAME_ASSERT(transform);
-	GAME_ASSERT(mesh->numPoints <= ENVMAP_MAX_VERTICES_PER_MESH);
 
-	Q3Matrix4x4_Invert(transform, &invTranspose);						// calc inverse-transpose matrix
+			/* MAKE SURE THE UV BUFFER IS BIG ENOUGH */
+
+	if (mesh->numPoints > gEnvMapUVCapacity)
+	{
+		if (gEnvMapUVs)
+			DisposePtr((Ptr) gEnvMapUVs);
+
+		gEnvMapUVCapacity = mesh->numPoints;
+		gEnvMapUVs = (TQ3Param2D*) AllocPtr(gEnvMapUVCapacity * sizeof(TQ3Param2D));
+		GAME_ASSERT(gEnvMapUVs);
+	}
+
+	Q3Matrix4x4_Multiply(transform, &gCameraWorldToViewMatrix, &modelToView);	// same as the GL modelview matrix
+	Q3Matrix4x4_Invert(&modelToView, &invTranspose);					// calc inverse-transpose matrix
 	Q3Matrix4x4_Transpose(&invTranspose, &invTranspose);
 
 		/****************************/
@@ -58,35 +70,40 @@ void EnvironmentMapTriMesh(
 	{
 		TQ3Vector3D surfaceNormal;
 
-					/* TRANSFORM VERTEX NORMAL */
+					/* TRANSFORM VERTEX NORMAL TO EYE SPACE */
 
 		Q3Vector3D_Transform(&mesh->vertexNormals[vertNum], &invTranspose, &surfaceNormal);
-		Q3Vector3D_Normalize(&surfaceNormal, &surfaceNormal);
+		Q3Vector3D_Normalize(&surfaceNormal, &surfaceNormal);			// GL_NORMALIZE is on
+
+					/* CALC UNIT VECTOR FROM EYE TO VERTEX */
 
-					/* CALC VECTOR TO VERTEX */
+		TQ3Point3D eyePoint;
+		Q3Point3D_Transform(&mesh->points[vertNum], &modelToView, &eyePoint);
 
-		TQ3Vector3D eyeVector;
-		Q3Vector3D_Transform((const TQ3Vector3D*)&mesh->points[vertNum], transform, &eyeVector);
-		eyeVector.x -= camCoord->x;
-		eyeVector.y -= camCoord->y;
-		eyeVector.z -= camCoord->z;
+		TQ3Vector3D eyeVector = { eyePoint.x, eyePoint.y, eyePoint.z };
+		Q3Vector3D_Normalize(&eyeVector, &eyeVector);
 
 					/* REFLECT VECTOR AROUND VERTEX NORMAL */
-		// Reflection vector: N(2(N.V)) - V
+		// Reflection vector: U - N(2(N.U))
 		// N - Surface Normal
-		// V - View Direction
-		float dot = 2.0f * Q3Vector3D_Dot(&surfaceNormal, &eyeVector);	// compute 2(N.V)
-		TQ3Vector3D reflectedVector =
+		// U - View Direction
+		float dot = 2.0f * Q3Vector3D_Dot(&surfaceNormal, &eyeVector);	// compute 2(N.U)
+		TQ3Vector3D r =
 		{
-			surfaceNormal.x * dot - eyeVector.x,
-			surfaceNormal.y * dot - eyeVector.y,
-			surfaceNormal.z * dot - eyeVector.z,
+			eyeVector.x - surfaceNormal.x * dot,
+			eyeVector.y - surfaceNormal.y * dot,
+			eyeVector.z - surfaceNormal.z * dot,
 		};
-		Q3Vector3D_Normalize(&reflectedVector, &reflectedVector);		// normalize result
 
 					/* CALC UV */
+		// m = 2 * sqrt(rx^2 + ry^2 + (rz+1)^2), per the GL spec
 
-		gEnvMapUVs[vertNum].u = (reflectedVector.x * .5f) + .5f;
-		gEnvMapUVs[vertNum].v = (reflectedVector.y * .5f) + .5f;
+		float m = 2.0f * sqrtf(r.x*r.x + r.y*r.y + (r.z+1.0f)*(r.z+1.0f));
+		float oneOverM = (m > EPS) ? (1.0f / m) : 0.0f;					// reflected straight away from the eye
+
+		gEnvMapUVs[vertNum].u = (r.x * oneOverM) + .5f;
+		gEnvMapUVs[vertNum].v = (r.y * oneOverM) + .5f;
 	}
+
+	return gEnvMapUVs;
 }
@@ -66,3 +66,17 @@ bool IsSphereInFrustum_XYZ(const TQ3Point3D* worldPt, float radius)
 		&& IsSphereFacingFrustumPlane(worldPt, radius, kFrustumPlaneNear)
 		&& IsSphereFacingFrustumPlane(worldPt, radius, kFrustumPlaneFar);
 }
+
+// Returns true if the whole sphere lies farther than the given depth from the near plane.
+bool IsSphereBeyondNearPlaneDepth(const TQ3Point3D* worldPt, float radius, float depth)
+{
+	const TQ3RationalPoint4D* nearPlane = &gFrustumPlanes[kFrustumPlaneNear];
+
+	float planeDot =
+			worldPt->x * nearPlane->x +
+			worldPt->y * nearPlane->y +
+			worldPt->z * nearPlane->z +
+			nearPlane->w;
+
+	return planeDot - radius > depth;
+}
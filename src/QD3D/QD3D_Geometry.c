@@ -24,6 +24,8 @@ static void ExplodeTriMesh(
 		Byte shardMode,
 		int shardDensity,
 		float shardDecaySpeed);
+static int CompareShardBatchKeys(const void* a, const void* b);
+static void SubmitShardBatch(int firstTri, int numTris, const ShardType* firstShard, const TQ3BoundingBox* bBox);
 
 
 /****************************/
@@ -46,6 +48,10 @@ static ShardType			gShards[MAX_SHARDS];
 static RenderModifiers		kShardRenderMods;
 Pool						*gShardPool = NULL;
 
+static TQ3TriMeshData*		gShardBatchMesh = NULL;				// all visible shards, rebuilt every frame
+static TQ3TriMeshData		gShardBatchViews[MAX_SHARDS];		// one view into gShardBatchMesh per texture
+static uint16_t				gShardDrawOrder[MAX_SHARDS];
+
 
 /*************** QD3D: CALC OBJECT BOUNDING BOX ************************/
 
@@ -152,12 +158,10 @@ void QD3D_InitShards(void)
 	else
 		Pool_Reset(gShardPool);
 
-	for (int i = 0; i < MAX_SHARDS; i++)
+	if (!gShardBatchMesh)
 	{
-		ShardType* shard = &gShards[i];
-		shard->mesh = Q3TriMeshData_New(1, 3, kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals);
-		for (int v = 0; v < 3; v++)
-			shard->mesh->triangles[0].pointIndices[v] = v;
+		gShardBatchMesh = Q3TriMeshData_New(MAX_SHARDS, MAX_SHARDS*3,
+				kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals | kQ3TriMeshDataFeatureVertexColors);
 	}
 
 	Render_SetDefaultModifiers(&kShardRenderMods);
@@ -170,14 +174,10 @@ void QD3D_InitShards(void)
 
 void QD3D_DisposeShards(void)
 {
-	for (int i = 0; i < MAX_SHARDS; i++)
+	if (gShardBatchMesh)
 	{
-		ShardType* shard = &gShards[i];
-		if (shard->mesh)
-		{
-			Q3TriMeshData_Dispose(shard->mesh);
-			shard->mesh = NULL;
-		}
+		Q3TriMeshData_Dispose(gShardBatchMesh);
+		gShardBatchMesh = NULL;
 	}
 
 	Pool_Free(gShardPool);
@@ -280,75 +280,70 @@ static void ExplodeTriMesh(
 
 		ShardType* shard = &gShards[shardIndex];
 
-		TQ3TriMeshData* sMesh = shard->mesh;
-
 		const uint32_t* ind = inMesh->triangles[t].pointIndices;		// get indices of 3 points
 
-				/*********************/
-				/* INIT TRIMESH DATA */
-				/*********************/
+				/*******************/
+				/* INIT SHARD DATA */
+				/*******************/
  
 				/* DO POINTS */
 
 		for (int v = 0; v < 3; v++)
 		{
-			Q3Point3D_Transform(&inMesh->points[ind[v]], transform, &sMesh->points[v]);		// transform points
+			Q3Point3D_Transform(&inMesh->points[ind[v]], transform, &shard->points[v]);		// transform points
 		}
 
 		TQ3Point3D centerPt =
 		{
-			(sMesh->points[0].x + sMesh->points[1].x + sMesh->points[2].x) * 0.3333f,		// calc center of polygon
-			(sMesh->points[0].y + sMesh->points[1].y + sMesh->points[2].y) * 0.3333f,
-			(sMesh->points[0].z + sMesh->points[1].z + sMesh->points[2].z) * 0.3333f,
+			(shard->points[0].x + shard->points[1].x + shard->points[2].x) * 0.3333f,		// calc center of polygon
+			(shard->points[0].y + shard->points[1].y + shard->points[2].y) * 0.3333f,
+			(shard->points[0].z + shard->points[1].z + shard->points[2].z) * 0.3333f,
 		};
 
 		for (int v = 0; v < 3; v++)
 		{
-			sMesh->points[v].x -= centerPt.x;											// offset coords to be around center
-			sMesh->points[v].y -= centerPt.y;
-			sMesh->points[v].z -= centerPt.z;
+			shard->points[v].x -= centerPt.x;											// offset coords to be around center
+			shard->points[v].y -= centerPt.y;
+			shard->points[v].z -= centerPt.z;
 		}
 
-		sMesh->bBox.min = sMesh->bBox.max = centerPt;
-		sMesh->bBox.isEmpty = kQ3False;
-
 
 				/* DO VERTEX NORMALS */
 
 		GAME_ASSERT(inMesh->hasVertexNormals);
 		for (int v = 0; v < 3; v++)
 		{
-			Q3Vector3D_Transform(&inMesh->vertexNormals[ind[v]], transform, &sMesh->vertexNormals[v]);		// transform normals
-			Q3Vector3D_Normalize(&sMesh->vertexNormals[v], &sMesh->vertexNormals[v]);						// normalize normals
+			Q3Vector3D_Transform(&inMesh->vertexNormals[ind[v]], transform, &shard->normals[v]);		// transform normals
+			Q3Vector3D_Normalize(&shard->normals[v], &shard->normals[v]);								// normalize normals
 		}
 
 				/* DO VERTEX UV'S */
 
-		sMesh->texturingMode = inMesh->texturingMode;
+		shard->texturingMode = inMesh->texturingMode;
+		shard->glTextureName = 0;
 		if (inMesh->texturingMode != kQ3TexturingModeOff)				// see if also has UV
 		{
 			GAME_ASSERT(inMesh->vertexUVs);
 			for (int v = 0; v < 3; v++)									// get vertex u/v's
 			{
-				sMesh->vertexUVs[v] = inMesh->vertexUVs[ind[v]];
+				shard->uvs[v] = inMesh->vertexUVs[ind[v]];
 			}
-			sMesh->glTextureName = inMesh->glTextureName;
-			sMesh->internalTextureID = inMesh->internalTextureID;
+			shard->glTextureName = inMesh->glTextureName;
 		}
 
 				/* DO VERTEX COLORS */
+				//
+				// Shards are drawn in batches with per-vertex colors, so bake the diffuse color
+				// into the vertices if the mesh doesn't have its own vertex colors.
+				//
 
-		sMesh->diffuseColor = inMesh->diffuseColor;
-
-		sMesh->hasVertexColors = inMesh->hasVertexColors;				// has per-vertex colors?
-		if (inMesh->hasVertexColors)
+		for (int v = 0; v < 3; v++)
 		{
-			for (int v = 0; v < 3; v++)									// get per-vertex colors
-			{
-				sMesh->vertexColors[v] = inMesh->vertexColors[ind[v]];
-			}
+			shard->colors[v] = inMesh->hasVertexColors ? inMesh->vertexColors[ind[v]] : inMesh->diffuseColor;
 		}
 
+		shard->isTranslucent = inMesh->texturingMode == kQ3TexturingModeAlphaBlend || inMesh->diffuseColor.a < .999f;
+
 			/*********************/
 			/* SET PHYSICS STUFF */
 			/*********************/
@@ -476,14 +471,133 @@ void QD3D_DrawShards(const QD3DSetupOutputType *setupInfo)
 	if (!gShardPool || Pool_Empty(gShardPool))		// quick check if any shards at all
 		return;
 
+			/* SORT SHARDS BY TEXTURE SO EACH BATCH IS CONTIGUOUS */
+
+	int numShards = 0;
 	for (int i = Pool_First(gShardPool); i >= 0; i = Pool_Next(gShardPool, i))
 	{
-		ShardType* shard = &gShards[i];
-		Render_SubmitMesh(shard->mesh, &shard->matrix, &kShardRenderMods, &shard->coord);
+		gShardDrawOrder[numShards++] = i;
+	}
+
+	SDL_qsort(gShardDrawOrder, numShards, sizeof(gShardDrawOrder[0]), CompareShardBatchKeys);
+
+			/* TRANSFORM ALL SHARDS INTO THE BATCH MESH */
+
+	TQ3Point3D*		points	= gShardBatchMesh->points;
+	TQ3Vector3D*	normals	= gShardBatchMesh->vertexNormals;
+	TQ3Param2D*		uvs		= gShardBatchMesh->vertexUVs;
+	TQ3ColorRGBA*	colors	= gShardBatchMesh->vertexColors;
+
+	int batchStart = 0;
+	TQ3BoundingBox bBox = { .isEmpty = kQ3False };
+
+	for (int t = 0; t < numShards; t++)
+	{
+		const ShardType* shard = &gShards[gShardDrawOrder[t]];
+		const TQ3Matrix4x4* m = &shard->matrix;
+		const float oneOverScale = 1.0f / shard->scale;				// keep normals unit length
+
+				/* START NEW BATCH IF TEXTURE CHANGES */
+
+		if (t != batchStart
+			&& 0 != CompareShardBatchKeys(&gShardDrawOrder[batchStart], &gShardDrawOrder[t]))
+		{
+			SubmitShardBatch(batchStart, t - batchStart, &gShards[gShardDrawOrder[batchStart]], &bBox);
+			batchStart = t;
+		}
+
+		if (t == batchStart)
+		{
+			bBox.min = bBox.max = shard->coord;
+		}
+
+		for (int v = 0; v < 3; v++)
+		{
+			const TQ3Point3D* p = &shard->points[v];
+			const TQ3Vector3D* n = &shard->normals[v];
+			int i = t*3 + v;
+
+			points[i].x = p->x * m->value[0][0] + p->y * m->value[1][0] + p->z * m->value[2][0] + m->value[3][0];
+			points[i].y = p->x * m->value[0][1] + p->y * m->value[1][1] + p->z * m->value[2][1] + m->value[3][1];
+			points[i].z = p->x * m->value[0][2] + p->y * m->value[1][2] + p->z * m->value[2][2] + m->value[3][2];
+
+			normals[i].x = (n->x * m->value[0][0] + n->y * m->value[1][0] + n->z * m->value[2][0]) * oneOverScale;
+			normals[i].y = (n->x * m->value[0][1] + n->y * m->value[1][1] + n->z * m->value[2][1]) * oneOverScale;
+			normals[i].z = (n->x * m->value[0][2] + n->y * m->value[1][2] + n->z * m->value[2][2]) * oneOverScale;
+
+			uvs[i] = shard->uvs[v];
+			colors[i] = shard->colors[v];
+
+			bBox.min.x = SDL_min(bBox.min.x, points[i].x);		bBox.max.x = SDL_max(bBox.max.x, points[i].x);
+			bBox.min.y = SDL_min(bBox.min.y, points[i].y);		bBox.max.y = SDL_max(bBox.max.y, points[i].y);
+			bBox.min.z = SDL_min(bBox.min.z, points[i].z);		bBox.max.z = SDL_max(bBox.max.z, points[i].z);
+
+			gShardBatchMesh->triangles[t].pointIndices[v] = (t - batchStart) * 3 + v;	// relative to start of batch
+		}
+	}
+
+	if (numShards > batchStart)
+	{
+		SubmitShardBatch(batchStart, numShards - batchStart, &gShards[gShardDrawOrder[batchStart]], &bBox);
 	}
 }
 
 
+/************************* COMPARE SHARD BATCH KEYS ****************************/
+//
+// Shards can share a draw call if they have the same texture & transparency.
+//
+
+static int CompareShardBatchKeys(const void* a, const void* b)
+{
+	const ShardType* shardA = &gShards[*(const uint16_t*) a];
+	const ShardType* shardB = &gShards[*(const uint16_t*) b];
+
+	if (shardA->glTextureName != shardB->glTextureName)
+		return shardA->glTextureName < shardB->glTextureName ? -1 : 1;
+
+	if (shardA->texturingMode != shardB->texturingMode)
+		return shardA->texturingMode < shardB->texturingMode ? -1 : 1;
+
+	return (int) shardA->isTranslucent - (int) shardB->isTranslucent;
+}
+
+
+/************************* SUBMIT SHARD BATCH ****************************/
+
+static void SubmitShardBatch(int firstTri, int numTris, const ShardType* firstShard, const TQ3BoundingBox* bBox)
+{
+	TQ3TriMeshData* view = &gShardBatchViews[firstTri];			// batches never overlap, so index views by first triangle
+
+	*view = *gShardBatchMesh;
+	view->numTriangles		= numTris;
+	view->triangles			= &gShardBatchMesh->triangles[firstTri];
+	view->numPoints			= numTris * 3;
+	view->points			= &gShardBatchMesh->points[firstTri * 3];
+	view->vertexNormals		= &gShardBatchMesh->vertexNormals[firstTri * 3];
+	view->vertexUVs			= &gShardBatchMesh->vertexUVs[firstTri * 3];
+	view->vertexColors		= &gShardBatchMesh->vertexColors[firstTri * 3];
+	view->hasVertexNormals	= true;
+	view->hasVertexColors	= true;
+	view->texturingMode		= firstShard->texturingMode;
+	view->glTextureName		= firstShard->glTextureName;
+	view->bBox				= *bBox;
+
+	// The vertex colors carry the actual opacity. The diffuse color only tells the renderer
+	// to put the batch in the transparent pass.
+	view->diffuseColor		= (TQ3ColorRGBA) { 1, 1, 1, firstShard->isTranslucent ? 0.5f : 1.0f };
+
+	TQ3Point3D center =
+	{
+		(bBox->min.x + bBox->max.x) * 0.5f,
+		(bBox->min.y + bBox->max.y) * 0.5f,
+		(bBox->min.z + bBox->max.z) * 0.5f,
+	};
+
+	Render_SubmitMesh(view, NULL, &kShardRenderMods, &center);
+}
+
+
 
 //============================================================================================
 //============================================================================================
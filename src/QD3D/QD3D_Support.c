@@ -49,6 +49,7 @@ static TQ3Point3D		gNormalWhere;
 static TQ3Vector3D		gNormal;
 
 static TQ3TriMeshData*	gDebugTextMesh = nil;
+static char				gDebugTextMeshText[1024];			// text currently laid out in gDebugTextMesh ("" if unknown)
 static TQ3TriMeshData*	gPillarboxMesh = nil;
 
 
@@ -400,18 +401,15 @@ void QD3D_MoveCameraFromTo(QD3DSetupOutputType *setupInfo, TQ3Vector3D *moveVect
 GLuint QD3D_LoadTextureFile(int textureRezID, int flags)
 {
 char					path[128];
-FSSpec					spec;
 uint8_t*				pixelData = nil;
 TGAHeader				header;
 OSErr					err;
 
 	SDL_snprintf(path, sizeof(path), ":Images:Textures:%d.tga", textureRezID);
 
-	FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &spec);
-
 			/* LOAD RAW RGBA DATA FROM TGA FILE */
 
-	err = ReadTGA(&spec, &pixelData, &header, true);
+	err = ReadDataTGA(path, &pixelData, &header, true);
 	GAME_ASSERT(err == noErr);
 
 	GAME_ASSERT(header.bpp == 32);
@@ -619,6 +617,13 @@ void QD3D_UpdateDebugTextMesh(const char* text)
 			Q3TriMeshData_Dispose(gDebugTextMesh);
 			gDebugTextMesh = nil;
 		}
+		gDebugTextMeshText[0] = '\0';
+		return;
+	}
+
+	// Nothing to do if the text hasn't changed since the last layout
+	if (gDebugTextMesh && 0 == SDL_strcmp(text, gDebugTextMeshText))
+	{
 		return;
 	}
 
@@ -629,14 +634,22 @@ void QD3D_UpdateDebugTextMesh(const char* text)
 	if (!gDebugTextMesh)
 	{
 		gDebugTextMesh = Q3TriMeshData_New(numTriangles, numPoints, kQ3TriMeshDataFeatureVertexUVs);
+		gDebugTextMeshText[0] = '\0';
 	}
 
 	// Reset triangle & point count in mesh so TextMesh_SetMesh knows the mesh's capacity
 	gDebugTextMesh->numTriangles	= numTriangles;
 	gDebugTextMesh->numPoints		= numPoints;
 
-	// Lay out the text
-	TextMesh_SetMesh(nil, text, gDebugTextMesh);
+	// Lay out the text, only rewriting the glyphs that changed since the last layout
+	if (gDebugTextMeshText[0])
+		TextMesh_UpdateMesh(nil, text, gDebugTextMeshText, gDebugTextMesh);
+	else
+		TextMesh_SetMesh(nil, text, gDebugTextMesh);
+
+	// Remember the text for the next update (if it's too long to store, force a full layout next time)
+	if (SDL_strlcpy(gDebugTextMeshText, text, sizeof(gDebugTextMeshText)) >= sizeof(gDebugTextMeshText))
+		gDebugTextMeshText[0] = '\0';
 }
 
 /************ SUBMIT DEBUG TEXT MESH FOR DRAWING *****************/
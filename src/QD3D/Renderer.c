@@ -22,6 +22,8 @@
 typedef struct RendererState
 {
 	GLuint		boundTexture;
+	GLuint		boundArrayBuffer;
+	GLuint		boundElementArrayBuffer;
 	bool		hasClientState_GL_TEXTURE_COORD_ARRAY;
 	bool		hasClientState_GL_VERTEX_ARRAY;
 	bool		hasClientState_GL_COLOR_ARRAY;
@@ -35,11 +37,18 @@ typedef struct RendererState
 	bool		hasState_GL_BLEND;
 	bool		hasState_GL_LIGHTING;
 	bool		hasState_GL_FOG;
+	bool		hasState_GL_TEXTURE_GEN_S;
+	bool		hasState_GL_TEXTURE_GEN_T;
 	bool		hasFlag_glDepthMask;
 	bool		blendFuncIsAdditive;
 	bool		sceneHasFog;
+	bool		fogMatchesClearColor;	// fully fogged geometry looks just like the background
+	bool		hasSphereMapTexGen;	// reflection maps are generated on the GPU
+	float		fogEndDistance;		// eye-space depth at which fog is opaque
+	TQ3ColorRGBA	clearColor;
 	GLboolean	wantColorMask;
 	const TQ3Matrix4x4*	currentTransform;
+	TQ3Param2D	currentUVOffset;
 } RendererState;
 
 typedef struct MeshQueueEntry
@@ -51,6 +60,27 @@ typedef struct MeshQueueEntry
 	bool					meshIsTransparent;
 } MeshQueueEntry;
 
+typedef struct TextureUpload
+{
+	GLuint					textureName;	// 0 if the texture was deleted before we got to it
+	int						x;
+	int						y;
+	int						width;
+	int						height;
+	GLenum					bufferFormat;
+	GLenum					bufferType;
+	int						rowLength;		// GL_UNPACK_ROW_LENGTH; 0 means width
+	Ptr						pixels;			// our own copy of the caller's pixels
+	size_t					size;
+} TextureUpload;
+
+typedef struct PixelBufferSlot
+{
+	GLuint					bufferName;
+	size_t					capacity;
+	GLsync					fence;			// non-NULL while the GPU may still be reading from the buffer
+} PixelBufferSlot;
+
 #define MESHQUEUE_MAX_SIZE 4096
 
 static MeshQueueEntry		gMeshQueueEntryPool[MESHQUEUE_MAX_SIZE];
@@ -60,6 +90,20 @@ static bool					gFrameStarted = false;
 
 static float				gBackupVertexColors[4*65536];
 
+#define TEXTURE_UPLOAD_QUEUE_SIZE		256
+#define TEXTURE_UPLOAD_RING_SIZE		4					// pixel buffer objects in flight
+#define TEXTURE_UPLOAD_FRAME_BUDGET		(1024 * 1024)		// bytes sent to the GPU at the start of each frame
+#define GL_DEFAULT_UNPACK_ALIGNMENT		4					// we never change GL_UNPACK_ALIGNMENT
+
+static TextureUpload		gTextureUploadQueue[TEXTURE_UPLOAD_QUEUE_SIZE];
+static int					gTextureUploadQueueHead = 0;
+static int					gNumQueuedTextureUploads = 0;
+static uint32_t				gTextureUploadsQueued = 0;		// tickets handed out so far
+static uint32_t				gTextureUploadsIssued = 0;		// tickets whose glTexSubImage2D call has been made
+
+static PixelBufferSlot		gPixelBufferRing[TEXTURE_UPLOAD_RING_SIZE];
+static int					gNextPixelBufferSlot = 0;
+
 static int DrawOrderComparator(void const* a_void, void const* b_void);
 
 static void BeginDepthPass(const MeshQueueEntry* entry);
@@ -67,6 +111,13 @@ static void BeginShadingPass(const MeshQueueEntry* entry);
 static void PrepareOpaqueShading(const MeshQueueEntry* entry);
 static void PrepareAlphaShading(const MeshQueueEntry* entry);
 static void SendGeometry(const MeshQueueEntry* entry);
+static void SetUVOffset(TQ3Param2D uvOffset);
+static void Render_GetGLProcAddresses(void);
+static void BindTexture(GLuint textureName);
+static uint32_t QueueTextureUpload(GLuint textureName, int x, int y, int width, int height, GLenum bufferFormat, GLenum bufferType, const GLvoid* pixels, int rowLength);
+static void FlushTextureUploads(size_t byteBudget, int mustIssueUpToIndex);
+static void FlushTextureUploadsForTexture(GLuint textureName);
+static void DisposeTextureUploads(void);
 
 
 #pragma mark -
@@ -131,6 +182,21 @@ float gGammaFadeFactor = 1.0f;
 
 static TQ3TriMeshData* gFullscreenQuad = nil;
 
+static bool gHasVertexBufferObjects = false;		// requires GL 1.5+
+
+static PFNGLGENBUFFERSPROC				procptr_glGenBuffers = NULL;
+static PFNGLDELETEBUFFERSPROC			procptr_glDeleteBuffers = NULL;
+static PFNGLBINDBUFFERPROC				procptr_glBindBuffer = NULL;
+static PFNGLBUFFERDATAPROC				procptr_glBufferData = NULL;
+static PFNGLBUFFERSUBDATAPROC			procptr_glBufferSubData = NULL;
+
+static bool gHasPixelBufferObjects = false;		// requires GL 2.1+ or ARB_pixel_buffer_object
+static bool gHasSyncObjects = false;			// requires GL 3.2+ or ARB_sync
+
+static PFNGLFENCESYNCPROC				procptr_glFenceSync = NULL;
+static PFNGLCLIENTWAITSYNCPROC			procptr_glClientWaitSync = NULL;
+static PFNGLDELETESYNCPROC				procptr_glDeleteSync = NULL;
+
 #pragma mark -
 
 /****************************/
@@ -210,6 +276,61 @@ static inline void SetColorMask(GLboolean enable)
 	}
 }
 
+// Note: the bound buffer is always 0 if VBOs are unsupported, so binding 0 is always safe.
+static inline void BindArrayBuffer(GLuint bufferName)
+{
+	if (gState.boundArrayBuffer != bufferName)
+	{
+		procptr_glBindBuffer(GL_ARRAY_BUFFER, bufferName);
+		gState.boundArrayBuffer = bufferName;
+	}
+}
+
+static inline void BindElementArrayBuffer(GLuint bufferName)
+{
+	if (gState.boundElementArrayBuffer != bufferName)
+	{
+		procptr_glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferName);
+		gState.boundElementArrayBuffer = bufferName;
+	}
+}
+
+// Returns a pointer suitable for gl*Pointer calls.
+// If the mesh is a view into a vertex buffer object, the VBO is bound and an offset into it is returned.
+// Otherwise, client-side arrays are used.
+static const GLvoid* GetVertexArrayPointer(const MeshQueueEntry* entry, const void* meshArray, const void* backingArray, size_t gpuOffset)
+{
+	const RenderVertexBuffer* vb = entry->mods->vertexBuffer;
+
+	if (!vb || !vb->bufferName || !meshArray || !backingArray)
+	{
+		BindArrayBuffer(0);
+		return meshArray;
+	}
+
+	BindArrayBuffer(vb->bufferName);
+	return (const GLvoid*) (gpuOffset + ((const char*) meshArray - (const char*) backingArray));
+}
+
+static const GLvoid* GetIndexArrayPointer(const MeshQueueEntry* entry)
+{
+	const RenderVertexBuffer* vb = entry->mods->vertexBuffer;
+
+	if (!vb || !vb->indexBufferName)
+	{
+		BindElementArrayBuffer(0);
+		return entry->mesh->triangles;
+	}
+
+	BindElementArrayBuffer(vb->indexBufferName);
+	return (const GLvoid*) ((const char*) entry->mesh->triangles - (const char*) vb->backingMesh->triangles);
+}
+
+#define VB_POINTER(entry, field, offsetField) \
+	GetVertexArrayPointer((entry), (entry)->mesh->field, \
+		(entry)->mods->vertexBuffer ? (entry)->mods->vertexBuffer->backingMesh->field : NULL, \
+		(entry)->mods->vertexBuffer ? (entry)->mods->vertexBuffer->offsetField : 0)
+
 #pragma mark -
 
 //=======================================================================================================
@@ -235,13 +356,57 @@ void Render_CreateContext(void)
 
 	// On Windows, proc addresses are only valid for the current context,
 	// so we must get proc addresses everytime we recreate the context.
-	//Render_GetGLProcAddresses();
+	Render_GetGLProcAddresses();
+}
+
+static void Render_GetGLProcAddresses(void)
+{
+	int major = 1;
+	int minor = 0;
+
+	const char* versionString = (const char*) glGetString(GL_VERSION);
+	if (versionString)
+		SDL_sscanf(versionString, "%d.%d", &major, &minor);
+
+	// Vertex buffer objects (core in GL 1.5)
+	procptr_glGenBuffers		= (PFNGLGENBUFFERSPROC)		SDL_GL_GetProcAddress("glGenBuffers");
+	procptr_glDeleteBuffers		= (PFNGLDELETEBUFFERSPROC)	SDL_GL_GetProcAddress("glDeleteBuffers");
+	procptr_glBindBuffer		= (PFNGLBINDBUFFERPROC)		SDL_GL_GetProcAddress("glBindBuffer");
+	procptr_glBufferData		= (PFNGLBUFFERDATAPROC)		SDL_GL_GetProcAddress("glBufferData");
+	procptr_glBufferSubData		= (PFNGLBUFFERSUBDATAPROC)	SDL_GL_GetProcAddress("glBufferSubData");
+
+	gHasVertexBufferObjects = (major > 1 || (major == 1 && minor >= 5))
+		&& procptr_glGenBuffers
+		&& procptr_glDeleteBuffers
+		&& procptr_glBindBuffer
+		&& procptr_glBufferData
+		&& procptr_glBufferSubData;
+
+	// Pixel buffer objects (core in GL 2.1) share their entry points with VBOs
+	gHasPixelBufferObjects = gHasVertexBufferObjects
+		&& (major > 2 || (major == 2 && minor >= 1) || SDL_GL_ExtensionSupported("GL_ARB_pixel_buffer_object"));
+
+	// Sync objects (core in GL 3.2)
+	procptr_glFenceSync			= (PFNGLFENCESYNCPROC)		SDL_GL_GetProcAddress("glFenceSync");
+	procptr_glClientWaitSync	= (PFNGLCLIENTWAITSYNCPROC)	SDL_GL_GetProcAddress("glClientWaitSync");
+	procptr_glDeleteSync		= (PFNGLDELETESYNCPROC)		SDL_GL_GetProcAddress("glDeleteSync");
+
+	gHasSyncObjects = (major > 3 || (major == 3 && minor >= 2) || SDL_GL_ExtensionSupported("GL_ARB_sync"))
+		&& procptr_glFenceSync
+		&& procptr_glClientWaitSync
+		&& procptr_glDeleteSync;
+
+	SDL_Log("OpenGL %d.%d; VBOs: %s; PBOs: %s; fences: %s\n", major, minor,
+			gHasVertexBufferObjects ? "yes" : "no",
+			gHasPixelBufferObjects ? "yes" : "no",
+			gHasSyncObjects ? "yes" : "no");
 }
 
 void Render_DeleteContext(void)
 {
 	if (gGLContext)
 	{
+		DisposeTextureUploads();
 		SDL_GL_DestroyContext(gGLContext);
 		gGLContext = NULL;
 	}
@@ -267,6 +432,8 @@ void Render_InitState(const TQ3ColorRGBA* clearColor)
 	SetInitialState(GL_BLEND,			false);
 	SetInitialState(GL_LIGHTING,		true);
 	SetInitialState(GL_FOG,				false);
+	SetInitialState(GL_TEXTURE_GEN_S,	false);
+	SetInitialState(GL_TEXTURE_GEN_T,	false);
 
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	gState.blendFuncIsAdditive = false;		// must match glBlendFunc call above!
@@ -281,10 +448,26 @@ void Render_InitState(const TQ3ColorRGBA* clearColor)
 	
 	gState.boundTexture = 0;
 	gState.sceneHasFog = false;
+
+	if (gHasVertexBufferObjects)
+	{
+		procptr_glBindBuffer(GL_ARRAY_BUFFER, 0);
+		procptr_glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	gState.boundArrayBuffer = 0;			// must match glBindBuffer calls above!
+	gState.boundElementArrayBuffer = 0;
 	gState.currentTransform = NULL;
+	gState.currentUVOffset = (TQ3Param2D) {0, 0};		// texture matrix starts out as identity
 
 	glClearColor(clearColor->r, clearColor->g, clearColor->b, 1.0f);
+	gState.clearColor = *clearColor;
 	
+	// Generate reflection map coordinates on the GPU if the driver lets us
+	for (int i = 0; i < 32 && glGetError() != GL_NO_ERROR; i++) {}		// flush stale errors (bounded: some drivers keep returning an error)
+	glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_SPHERE_MAP);
+	glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_SPHERE_MAP);
+	gState.hasSphereMapTexGen = (glGetError() == GL_NO_ERROR);
+
 	// Set misc GL defaults that apply throughout the entire game
 	glAlphaFunc(GL_GREATER, 0.4999f);
 	glFrontFace(GL_CCW);
@@ -330,6 +513,10 @@ void Render_EnableFog(
 	glFogf(GL_FOG_END,		fogYon * camYon);
 	glFogfv(GL_FOG_COLOR,	&fogColor.r);
 	gState.sceneHasFog = true;
+	gState.fogEndDistance = fogYon * camYon;
+	gState.fogMatchesClearColor = fogColor.r == gState.clearColor.r
+								&& fogColor.g == gState.clearColor.g
+								&& fogColor.b == gState.clearColor.b;
 }
 
 void Render_DisableFog(void)
@@ -337,9 +524,26 @@ void Render_DisableFog(void)
 	gState.sceneHasFog = false;
 }
 
+void Render_SetFogRange(float camYon, float fogHither, float fogYon)
+{
+	glFogf(GL_FOG_START,	fogHither * camYon);
+	glFogf(GL_FOG_END,		fogYon * camYon);
+	gState.fogEndDistance = fogYon * camYon;
+}
+
+float Render_GetFogEndDistance(void)
+{
+	return gState.sceneHasFog ? gState.fogEndDistance : 0;
+}
+
+bool Render_FogMatchesClearColor(void)
+{
+	return gState.sceneHasFog && gState.fogMatchesClearColor;
+}
+
 #pragma mark -
 
-void Render_BindTexture(GLuint textureName)
+static void BindTexture(GLuint textureName)
 {
 	if (gState.boundTexture != textureName)
 	{
@@ -348,6 +552,14 @@ void Render_BindTexture(GLuint textureName)
 	}
 }
 
+void Render_BindTexture(GLuint textureName)
+{
+	if (gNumQueuedTextureUploads > 0)				// a draw must see the texture's latest pixels
+		FlushTextureUploadsForTexture(textureName);
+
+	BindTexture(textureName);
+}
+
 GLuint Render_LoadTexture(
 		GLenum internalFormat,
 		int width,
@@ -364,7 +576,7 @@ GLuint Render_LoadTexture(
 	glGenTextures(1, &textureName);
 	CHECK_GL_ERROR();
 
-	Render_BindTexture(textureName);				// this is now the currently active texture
+	BindTexture(textureName);						// this is now the currently active texture
 	CHECK_GL_ERROR();
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, !gGamePrefs.lowDetail? GL_LINEAR: GL_NEAREST);
@@ -376,6 +588,7 @@ GLuint Render_LoadTexture(
 	if (flags & kRendererTextureFlags_ClampV)
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+	// Allocate storage only; the pixels go through the upload queue
 	glTexImage2D(
 			GL_TEXTURE_2D,
 			0,						// mipmap level
@@ -385,13 +598,16 @@ GLuint Render_LoadTexture(
 			0,						// border
 			bufferFormat,			// what my format is
 			bufferType,				// size of each r,g,b
-			pixels);				// pointer to the actual texture pixels
+			NULL);
 	CHECK_GL_ERROR();
 
+	if (pixels)
+		QueueTextureUpload(textureName, 0, 0, width, height, bufferFormat, bufferType, pixels, 0);
+
 	return textureName;
 }
 
-void Render_UpdateTexture(
+uint32_t Render_UpdateTexture(
 		GLuint textureName,
 		int x,
 		int y,
@@ -402,36 +618,382 @@ void Render_UpdateTexture(
 		const GLvoid* pixels,
 		int rowBytesInInput)
 {
-	GLint pUnpackRowLength = 0;
+	return QueueTextureUpload(textureName, x, y, width, height, bufferFormat, bufferType, pixels, SDL_max(rowBytesInInput, 0));
+}
+
+bool Render_IsTextureUploadDone(uint32_t ticket)
+{
+	return (int32_t) (gTextureUploadsIssued - ticket) >= 0;
+}
+
+void Render_FlushAllTextureUploads(void)
+{
+	if (gNumQueuedTextureUploads > 0)
+		FlushTextureUploads(0, gNumQueuedTextureUploads - 1);
+}
+
+void Render_DeleteTextures(int numTextures, const GLuint* textureNames)
+{
+	for (int i = 0; i < numTextures; i++)
+	{
+		if (!textureNames[i])
+			continue;
+
+		// Cancel pending uploads so they don't land in a texture that reuses this name later
+		for (int q = 0; q < gNumQueuedTextureUploads; q++)
+		{
+			TextureUpload* upload = &gTextureUploadQueue[(gTextureUploadQueueHead + q) % TEXTURE_UPLOAD_QUEUE_SIZE];
+			if (upload->textureName == textureNames[i])
+				upload->textureName = 0;
+		}
+
+		// GL unbinds deleted textures, so our cached binding must follow
+		if (gState.boundTexture == textureNames[i])
+			gState.boundTexture = 0;
+	}
+
+	glDeleteTextures(numTextures, textureNames);
+}
+
+#pragma mark -
+
+/****************************/
+/*    TEXTURE UPLOADS       */
+/****************************/
+//
+// Texture pixels are copied into a queue so the caller can move on right away.
+// At the start of each frame, up to TEXTURE_UPLOAD_FRAME_BUDGET bytes are sent to the GPU
+// through a ring of pixel buffer objects, so the driver copies asynchronously.
+// A fence per buffer tells us when the GPU is done reading from it.
+// Binding a texture for drawing sends its pending uploads right away.
+//
+
+static int GetBytesPerPixel(GLenum bufferFormat, GLenum bufferType)
+{
+	switch (bufferType)
+	{
+		case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+		case GL_UNSIGNED_SHORT_5_5_5_1:
+		case GL_UNSIGNED_SHORT_5_6_5:
+		case GL_UNSIGNED_SHORT_4_4_4_4:
+		case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+			return 2;
+
+		case GL_UNSIGNED_INT_8_8_8_8:
+		case GL_UNSIGNED_INT_8_8_8_8_REV:
+			return 4;
+
+		case GL_UNSIGNED_BYTE:
+			switch (bufferFormat)
+			{
+				case GL_RGBA:
+				case GL_BGRA:
+					return 4;
+				case GL_RGB:
+				case GL_BGR:
+					return 3;
+				case GL_LUMINANCE_ALPHA:
+					return 2;
+				case GL_LUMINANCE:
+				case GL_ALPHA:
+					return 1;
+			}
+			break;
+	}
+
+	DoFatalAlert("GetBytesPerPixel: unsupported format 0x%x/0x%x", bufferFormat, bufferType);
+	return 0;
+}
+
+static uint32_t QueueTextureUpload(
+		GLuint textureName,
+		int x,
+		int y,
+		int width,
+		int height,
+		GLenum bufferFormat,
+		GLenum bufferType,
+		const GLvoid* pixels,
+		int rowLength)
+{
+	GAME_ASSERT(gGLContext);
+	GAME_ASSERT(pixels);
+
+	if (width <= 0 || height <= 0)
+		return gTextureUploadsQueued;
+
+	if (gNumQueuedTextureUploads == TEXTURE_UPLOAD_QUEUE_SIZE)		// queue full: send the oldest upload now
+		FlushTextureUploads(0, 0);
+
+			/* COPY PIXELS THE WAY GL WOULD READ THEM */
+
+	const int bytesPerPixel = GetBytesPerPixel(bufferFormat, bufferType);
+	size_t stride = (rowLength > 0 ? rowLength : width) * bytesPerPixel;
+	stride = (stride + GL_DEFAULT_UNPACK_ALIGNMENT - 1) & ~(size_t) (GL_DEFAULT_UNPACK_ALIGNMENT - 1);
+	const size_t size = stride * (height - 1) + width * bytesPerPixel;
+
+	TextureUpload* upload = &gTextureUploadQueue[(gTextureUploadQueueHead + gNumQueuedTextureUploads) % TEXTURE_UPLOAD_QUEUE_SIZE];
+
+	upload->textureName		= textureName;
+	upload->x				= x;
+	upload->y				= y;
+	upload->width			= width;
+	upload->height			= height;
+	upload->bufferFormat	= bufferFormat;
+	upload->bufferType		= bufferType;
+	upload->rowLength		= rowLength;
+	upload->size			= size;
+	upload->pixels			= AllocPtr(size);
+	GAME_ASSERT(upload->pixels);
+	SDL_memcpy(upload->pixels, pixels, size);
+
+	gNumQueuedTextureUploads++;
+	return ++gTextureUploadsQueued;
+}
+
+static PixelBufferSlot* AcquirePixelBufferSlot(size_t size)
+{
+	if (!gHasPixelBufferObjects)
+		return NULL;
+
+	PixelBufferSlot* slot = &gPixelBufferRing[gNextPixelBufferSlot];	// oldest slot in the ring
+
+	if (slot->fence)
+	{
+		GLenum status = procptr_glClientWaitSync(slot->fence, 0, 0);
+		if (status == GL_TIMEOUT_EXPIRED)							// GPU still reading from it
+			return NULL;
+
+		procptr_glDeleteSync(slot->fence);
+		slot->fence = NULL;
+	}
+
+	gNextPixelBufferSlot = (gNextPixelBufferSlot + 1) % TEXTURE_UPLOAD_RING_SIZE;
+
+	if (!slot->bufferName)
+		procptr_glGenBuffers(1, &slot->bufferName);
+
+	procptr_glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->bufferName);
+
+	// Without fences, orphan the old storage every time so we never overwrite pixels in flight
+	if (slot->capacity < size || !gHasSyncObjects)
+	{
+		slot->capacity = SDL_max(size, slot->capacity);
+		procptr_glBufferData(GL_PIXEL_UNPACK_BUFFER, slot->capacity, NULL, GL_STREAM_DRAW);
+	}
+
+	return slot;
+}
+
+// Returns false if the upload can wait and every pixel buffer is still busy.
+static bool IssueTextureUpload(const TextureUpload* upload, bool mustIssue)
+{
+	const GLvoid* source = upload->pixels;						// straight from client memory unless we get a pixel buffer
 
-	Render_BindTexture(textureName);
+	PixelBufferSlot* slot = AcquirePixelBufferSlot(upload->size);
 
-	// Set unpack row length (if valid rowbytes input given)
-	if (rowBytesInInput > 0)
+	if (slot)
 	{
-		glGetIntegerv(GL_UNPACK_ROW_LENGTH, &pUnpackRowLength);
-		glPixelStorei(GL_UNPACK_ROW_LENGTH, rowBytesInInput);
+		procptr_glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, upload->size, upload->pixels);
+		source = (const GLvoid*) 0;								// offset into the bound pixel buffer
 	}
+	else if (gHasPixelBufferObjects && !mustIssue)
+	{
+		return false;
+	}
+
+	BindTexture(upload->textureName);
+
+	if (upload->rowLength > 0)
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, upload->rowLength);
 
 	glTexSubImage2D(
 			GL_TEXTURE_2D,
 			0,
-			x,
-			y,
-			width,
-			height,
-			bufferFormat,
-			bufferType,
-			pixels);
+			upload->x,
+			upload->y,
+			upload->width,
+			upload->height,
+			upload->bufferFormat,
+			upload->bufferType,
+			source);
+	CHECK_GL_ERROR();
+
+	if (upload->rowLength > 0)
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+	if (slot)
+	{
+		if (gHasSyncObjects)
+			slot->fence = procptr_glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		procptr_glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);		// other texture calls read from client memory
+	}
+
+	return true;
+}
+
+// Sends queued uploads to the GPU in order.
+// Uploads up to index mustIssueUpToIndex (relative to the head of the queue) are sent no matter what;
+// after that, we keep going until the byte budget is spent or no pixel buffer is free.
+static void FlushTextureUploads(size_t byteBudget, int mustIssueUpToIndex)
+{
+	size_t bytesIssued = 0;
+
+	for (int i = 0; gNumQueuedTextureUploads > 0; i++)
+	{
+		TextureUpload* upload = &gTextureUploadQueue[gTextureUploadQueueHead];
+		bool mustIssue = i <= mustIssueUpToIndex;
+
+		if (!mustIssue && bytesIssued >= byteBudget)
+			break;
+
+		if (upload->textureName)
+		{
+			if (!IssueTextureUpload(upload, mustIssue))				// ring is full; try again next frame
+				break;
+
+			bytesIssued += upload->size;
+		}
+
+		DisposePtr(upload->pixels);
+		upload->pixels = nil;
+
+		gTextureUploadQueueHead = (gTextureUploadQueueHead + 1) % TEXTURE_UPLOAD_QUEUE_SIZE;
+		gNumQueuedTextureUploads--;
+		gTextureUploadsIssued++;
+	}
+}
+
+static void FlushTextureUploadsForTexture(GLuint textureName)
+{
+	int lastIndex = -1;
+
+	for (int q = 0; q < gNumQueuedTextureUploads; q++)
+	{
+		if (gTextureUploadQueue[(gTextureUploadQueueHead + q) % TEXTURE_UPLOAD_QUEUE_SIZE].textureName == textureName)
+			lastIndex = q;
+	}
+
+	if (lastIndex >= 0)
+		FlushTextureUploads(0, lastIndex);
+}
+
+static void DisposeTextureUploads(void)
+{
+	while (gNumQueuedTextureUploads > 0)
+	{
+		TextureUpload* upload = &gTextureUploadQueue[gTextureUploadQueueHead];
+		DisposePtr(upload->pixels);
+		upload->pixels = nil;
+
+		gTextureUploadQueueHead = (gTextureUploadQueueHead + 1) % TEXTURE_UPLOAD_QUEUE_SIZE;
+		gNumQueuedTextureUploads--;
+		gTextureUploadsIssued++;
+	}
+
+	for (int i = 0; i < TEXTURE_UPLOAD_RING_SIZE; i++)
+	{
+		PixelBufferSlot* slot = &gPixelBufferRing[i];
+
+		if (slot->fence)
+			procptr_glDeleteSync(slot->fence);
+
+		if (slot->bufferName)
+			procptr_glDeleteBuffers(1, &slot->bufferName);
+
+		SDL_memset(slot, 0, sizeof(*slot));
+	}
+
+	gNextPixelBufferSlot = 0;
+}
+
+#pragma mark -
+
+RenderVertexBuffer* Render_NewVertexBuffer(const TQ3TriMeshData* backingMesh)
+{
+	RenderVertexBuffer* vb = (RenderVertexBuffer*) AllocPtr(sizeof(RenderVertexBuffer));
+	GAME_ASSERT(vb);
+
+	vb->backingMesh = backingMesh;
+
+	if (!gHasVertexBufferObjects)						// no VBO support: meshes will be drawn from client-side arrays
+		return vb;
+
+	const int numPoints = backingMesh->numPoints;
+
+	size_t size = 0;
+
+	vb->pointsOffset = size;
+	size += numPoints * sizeof(TQ3Point3D);
+
+	if (backingMesh->vertexNormals)
+	{
+		vb->normalsOffset = size;
+		size += numPoints * sizeof(TQ3Vector3D);
+	}
+
+	if (backingMesh->vertexUVs)
+	{
+		vb->uvsOffset = size;
+		size += numPoints * sizeof(TQ3Param2D);
+	}
+
+	if (backingMesh->vertexColors)
+	{
+		vb->colorsOffset = size;
+		size += numPoints * sizeof(TQ3ColorRGBA);
+	}
+
+			/* UPLOAD VERTEX DATA ONCE */
+
+	procptr_glGenBuffers(1, &vb->bufferName);
+	BindArrayBuffer(vb->bufferName);
+	procptr_glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STATIC_DRAW);
+	procptr_glBufferSubData(GL_ARRAY_BUFFER, vb->pointsOffset, numPoints * sizeof(TQ3Point3D), backingMesh->points);
+	if (backingMesh->vertexNormals)
+		procptr_glBufferSubData(GL_ARRAY_BUFFER, vb->normalsOffset, numPoints * sizeof(TQ3Vector3D), backingMesh->vertexNormals);
+	if (backingMesh->vertexUVs)
+		procptr_glBufferSubData(GL_ARRAY_BUFFER, vb->uvsOffset, numPoints * sizeof(TQ3Param2D), backingMesh->vertexUVs);
+	if (backingMesh->vertexColors)
+		procptr_glBufferSubData(GL_ARRAY_BUFFER, vb->colorsOffset, numPoints * sizeof(TQ3ColorRGBA), backingMesh->vertexColors);
 	CHECK_GL_ERROR();
 
-	// Restore unpack row length
-	if (rowBytesInInput > 0)
+			/* UPLOAD INDEX DATA ONCE */
+
+	procptr_glGenBuffers(1, &vb->indexBufferName);
+	BindElementArrayBuffer(vb->indexBufferName);
+	procptr_glBufferData(GL_ELEMENT_ARRAY_BUFFER, backingMesh->numTriangles * sizeof(TQ3TriMeshTriangleData), backingMesh->triangles, GL_STATIC_DRAW);
+	CHECK_GL_ERROR();
+
+	BindArrayBuffer(0);
+	BindElementArrayBuffer(0);
+
+	return vb;
+}
+
+void Render_DisposeVertexBuffer(RenderVertexBuffer* vb)
+{
+	if (!vb)
+		return;
+
+	if (vb->bufferName || vb->indexBufferName)
 	{
-		glPixelStorei(GL_UNPACK_ROW_LENGTH, pUnpackRowLength);
+		BindArrayBuffer(0);
+		BindElementArrayBuffer(0);
+
+		if (vb->bufferName)
+			procptr_glDeleteBuffers(1, &vb->bufferName);
+
+		if (vb->indexBufferName)
+			procptr_glDeleteBuffers(1, &vb->indexBufferName);
 	}
+
+	DisposePtr((Ptr) vb);
 }
 
+#pragma mark -
+
 void Render_Load3DMFTextures(TQ3MetaFile* metaFile, GLuint* outTextureNames, bool forceClampUVs)
 {
 	for (int i = 0; i < metaFile->numTextures; i++)
@@ -521,6 +1083,9 @@ void Render_StartFrame(void)
 	// Clear mesh queue
 	gMeshQueueSize = 0;
 
+	// Send some pending texture uploads to the GPU
+	FlushTextureUploads(TEXTURE_UPLOAD_FRAME_BUDGET, -1);
+
 	// Clear stats
 	gRenderStats.meshesPass1 = 0;
 	gRenderStats.meshesPass2 = 0;
@@ -631,12 +1196,21 @@ void Render_FlushQueue(void)
 	// Clear mesh draw queue
 	gMeshQueueSize = 0;
 
+	// Unbind vertex buffers so that client-side arrays work outside the queue
+	BindArrayBuffer(0);
+	BindElementArrayBuffer(0);
+
 	// Clear transform
 	if (NULL != gState.currentTransform)
 	{
 		glPopMatrix();
 		gState.currentTransform = NULL;
 	}
+
+	// Clear texture matrix & texgen so that textures drawn outside the queue aren't affected
+	SetUVOffset((TQ3Param2D) {0, 0});
+	DisableState(GL_TEXTURE_GEN_S);
+	DisableState(GL_TEXTURE_GEN_T);
 }
 
 void Render_EndFrame(void)
@@ -827,7 +1401,8 @@ static void SendGeometry(const MeshQueueEntry* entry)
 		glCullFace(GL_FRONT);		// Pass 1: draw backfaces (cull frontfaces)
 
 	// Submit vertex data
-	glVertexPointer(3, GL_FLOAT, 0, mesh->points);
+	glVertexPointer(3, GL_FLOAT, 0, VB_POINTER(entry, points, pointsOffset));
+	const GLvoid* indices = GetIndexArrayPointer(entry);
 
 	// Submit transformation matrix if any
 	if (gState.currentTransform != entry->transform)
@@ -845,7 +1420,7 @@ static void SendGeometry(const MeshQueueEntry* entry)
 	}
 
 	// Draw the mesh
-	glDrawElements(GL_TRIANGLES, mesh->numTriangles*3, GL_UNSIGNED_INT, mesh->triangles);
+	glDrawElements(GL_TRIANGLES, mesh->numTriangles*3, GL_UNSIGNED_INT, indices);
 	CHECK_GL_ERROR();
 
 	// Pass 2 to draw transparent meshes without face culling (see above for an explanation)
@@ -855,11 +1430,24 @@ static void SendGeometry(const MeshQueueEntry* entry)
 		glCullFace(GL_BACK);	// pass 2: draw frontfaces (cull backfaces)
 
 		// Draw the mesh again
-		glDrawElements(GL_TRIANGLES, mesh->numTriangles * 3, GL_UNSIGNED_INT, mesh->triangles);
+		glDrawElements(GL_TRIANGLES, mesh->numTriangles * 3, GL_UNSIGNED_INT, indices);
 		CHECK_GL_ERROR();
 	}
 }
 
+static void SetUVOffset(TQ3Param2D uvOffset)
+{
+	if (gState.currentUVOffset.u == uvOffset.u && gState.currentUVOffset.v == uvOffset.v)
+		return;
+
+	glMatrixMode(GL_TEXTURE);
+	glLoadIdentity();
+	glTranslatef(uvOffset.u, uvOffset.v, 0);
+	glMatrixMode(GL_MODELVIEW);
+
+	gState.currentUVOffset = uvOffset;
+}
+
 static void BeginDepthPass(const MeshQueueEntry* entry)
 {
 	const TQ3TriMeshData* mesh = entry->mesh;
@@ -891,7 +1479,10 @@ static void BeginDepthPass(const MeshQueueEntry* entry)
 		EnableState(GL_TEXTURE_2D);
 		EnableClientState(GL_TEXTURE_COORD_ARRAY);
 		Render_BindTexture(mesh->glTextureName);
-		glTexCoordPointer(2, GL_FLOAT, 0, mesh->vertexUVs);
+		DisableState(GL_TEXTURE_GEN_S);
+		DisableState(GL_TEXTURE_GEN_T);
+		SetUVOffset(entry->mods->uvOffset);
+		glTexCoordPointer(2, GL_FLOAT, 0, VB_POINTER(entry, vertexUVs, uvsOffset));
 		CHECK_GL_ERROR();
 	}
 	else
@@ -911,10 +1502,6 @@ static void BeginShadingPass(const MeshQueueEntry* entry)
 	// Always write to color mask in this pass
 	SetColorMask(GL_TRUE);
 
-	// Environment map effect
-	if (statusBits & STATUS_BIT_REFLECTIONMAP)
-		EnvironmentMapTriMesh(mesh, entry->transform);
-
 	// Apply gouraud or null illumination
 	SetState(GL_LIGHTING,
 			!( (statusBits & STATUS_BIT_NULLSHADER) || (mesh->texturingMode & kQ3TexturingModeExt_NullShaderFlag) ));
@@ -927,9 +1514,31 @@ static void BeginShadingPass(const MeshQueueEntry* entry)
 			(mesh->texturingMode & kQ3TexturingModeExt_OpacityModeMask) != kQ3TexturingModeOff)
 	{
 		EnableState(GL_TEXTURE_2D);
-		EnableClientState(GL_TEXTURE_COORD_ARRAY);
 		Render_BindTexture(mesh->glTextureName);
-		glTexCoordPointer(2, GL_FLOAT, 0, (statusBits & STATUS_BIT_REFLECTIONMAP) ? gEnvMapUVs: mesh->vertexUVs);
+		if (!(statusBits & STATUS_BIT_REFLECTIONMAP))
+		{
+			EnableClientState(GL_TEXTURE_COORD_ARRAY);
+			DisableState(GL_TEXTURE_GEN_S);
+			DisableState(GL_TEXTURE_GEN_T);
+			SetUVOffset(entry->mods->uvOffset);
+			glTexCoordPointer(2, GL_FLOAT, 0, VB_POINTER(entry, vertexUVs, uvsOffset));
+		}
+		else if (gState.hasSphereMapTexGen)		// environment map effect on the GPU
+		{
+			DisableClientState(GL_TEXTURE_COORD_ARRAY);		// don't let GL fetch a stale UV pointer we won't use
+			EnableState(GL_TEXTURE_GEN_S);
+			EnableState(GL_TEXTURE_GEN_T);
+			SetUVOffset((TQ3Param2D) {0, 0});
+		}
+		else									// environment map effect on the CPU
+		{
+			EnableClientState(GL_TEXTURE_COORD_ARRAY);
+			DisableState(GL_TEXTURE_GEN_S);
+			DisableState(GL_TEXTURE_GEN_T);
+			SetUVOffset((TQ3Param2D) {0, 0});
+			BindArrayBuffer(0);
+			glTexCoordPointer(2, GL_FLOAT, 0, EnvironmentMapTriMesh(mesh, entry->transform));
+		}
 		CHECK_GL_ERROR();
 	}
 	else
@@ -939,11 +1548,12 @@ static void BeginShadingPass(const MeshQueueEntry* entry)
 		CHECK_GL_ERROR();
 	}
 
-	// Submit normal data if any
-	if (mesh->hasVertexNormals && !(statusBits & STATUS_BIT_NULLSHADER))
+	// Submit normal data if any (texgen needs normals even if the mesh isn't lit)
+	bool texGenNeedsNormals = (statusBits & STATUS_BIT_REFLECTIONMAP) && gState.hasSphereMapTexGen;
+	if (mesh->hasVertexNormals && (texGenNeedsNormals || !(statusBits & STATUS_BIT_NULLSHADER)))
 	{
 		EnableClientState(GL_NORMAL_ARRAY);
-		glNormalPointer(GL_FLOAT, 0, mesh->vertexNormals);
+		glNormalPointer(GL_FLOAT, 0, VB_POINTER(entry, vertexNormals, normalsOffset));
 	}
 	else
 	{
@@ -969,7 +1579,7 @@ static void PrepareOpaqueShading(const MeshQueueEntry* entry)
 	{
 		EnableClientState(GL_COLOR_ARRAY);
 
-		glColorPointer(4, GL_FLOAT, 0, mesh->vertexColors);
+		glColorPointer(4, GL_FLOAT, 0, VB_POINTER(entry, vertexColors, colorsOffset));
 	}
 	else
 	{
@@ -1017,6 +1627,7 @@ static void PrepareAlphaShading(const MeshQueueEntry* entry)
 			gBackupVertexColors[j++] = mesh->vertexColors[v].a * entry->mods->autoFadeFactor;
 		}
 
+		BindArrayBuffer(0);
 		glColorPointer(4, GL_FLOAT, 0, gBackupVertexColors);
 	}
 	else
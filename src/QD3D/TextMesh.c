@@ -41,6 +41,46 @@ TQ3TriMeshData* TextMesh_CreateMesh(const TextMeshDef* def, const char* text)
 }
 
 TQ3TriMeshData* TextMesh_SetMesh(const TextMeshDef* def, const char* text, TQ3TriMeshData* recycleMesh)
+{
+	return TextMesh_UpdateMesh(def, text, NULL, recycleMesh);
+}
+
+static float MeasureLine(const char* line, float spacing)
+{
+	float lineWidth = 0;
+	for (const char* c = line; *c && *c != '\n'; c++)
+		lineWidth += gAtlasGlyphs[(uint8_t) *c].xadv + spacing;
+	return lineWidth;
+}
+
+static int CountLineQuads(const char* line)
+{
+	int numQuads = 0;
+	for (const char* c = line; *c && *c != '\n'; c++)
+	{
+		if (*c != ' ')
+			numQuads++;
+	}
+	return numQuads;
+}
+
+static float GetLineStartX(const char* line, float x, int align, float spacing)
+{
+	if (align == TEXTMESH_ALIGN_CENTER)
+		return x - MeasureLine(line, spacing) * .5f;
+	else if (align == TEXTMESH_ALIGN_RIGHT)
+		return x - MeasureLine(line, spacing);
+	else
+		return x;
+}
+
+// Lays out text into a mesh. Alignment applies to each line separately.
+//
+// If previousText is non-NULL, the mesh must be a recycled mesh that was last laid out
+// with previousText and the same def. In that case, glyph quads that stay put are not rewritten:
+// for each line, the glyphs preceding the first change are skipped as long as the line
+// starts at the same x and the same quad index as before.
+TQ3TriMeshData* TextMesh_UpdateMesh(const TextMeshDef* def, const char* text, const char* previousText, TQ3TriMeshData* recycleMesh)
 {
 	float x = gDefaultTextMeshDef.meshOrigin.x;
 	float y = gDefaultTextMeshDef.meshOrigin.y;
@@ -58,29 +98,16 @@ TQ3TriMeshData* TextMesh_SetMesh(const TextMeshDef* def, const char* text, TQ3Tr
 
 //	GAME_ASSERT(gAtlasGlyphs);
 	GAME_ASSERT(gFontTexture);
+	GAME_ASSERT(!previousText || recycleMesh);
 
-	// Compute number of quads and line width
-	float lineWidth = 0;
+	// Compute number of quads
 	int numQuads = 0;
 	for (const char* c = text; *c; c++)
 	{
-		if (*c == '\n')		// TODO: line widths for strings containing line breaks aren't supported yet
-			continue;
-
-		const AtlasGlyph g = gAtlasGlyphs[(uint8_t) *c];
-		lineWidth += g.xadv + spacing;
-		if (*c != ' ')
+		if (*c != ' ' && *c != '\n')
 			numQuads++;
 	}
 
-	// Adjust start x for text alignment
-	if (align == TEXTMESH_ALIGN_CENTER)
-		x -= lineWidth * .5f;
-	else if (align == TEXTMESH_ALIGN_RIGHT)
-		x -= lineWidth;
-
-	float x0 = x;
-
 	// Adjust y for ascender
 	y += gLineHeight * .7f;
 
@@ -102,47 +129,83 @@ TQ3TriMeshData* TextMesh_SetMesh(const TextMeshDef* def, const char* text, TQ3Tr
 	mesh->texturingMode = kQ3TexturingModeAlphaBlend;
 	mesh->glTextureName = gFontTexture;
 
-	// Create a quad for each character
+	// Create a quad for each character, line by line
 	int t = 0;
 	int p = 0;
-	for (const char* c = text; *c; c++)
+	int prevP = 0;
+	const char* line = text;
+	const char* prevLine = previousText;
+
+	while (1)
 	{
-		if (*c == '\n')
+		const char* c = line;
+		float lineX = GetLineStartX(line, x, align, spacing);
+		float cx = lineX;
+
+		// Skip glyphs that haven't moved since the previous layout
+		if (prevLine
+			&& prevP == p
+			&& lineX == GetLineStartX(prevLine, x, align, spacing))
 		{
-			x = x0;
-			y -= gLineHeight;
-			continue;
+			for (const char* pc = prevLine; *c && *c != '\n' && *c == *pc; c++, pc++)
+			{
+				cx += gAtlasGlyphs[(uint8_t) *c].xadv + spacing;
+				if (*c != ' ')
+				{
+					t += 2;
+					p += 4;
+				}
+			}
 		}
 
-		const AtlasGlyph g = gAtlasGlyphs[(uint8_t) *c];
+		// Rewrite the rest of the line
+		for (; *c && *c != '\n'; c++)
+		{
+			const AtlasGlyph g = gAtlasGlyphs[(uint8_t) *c];
+
+			if (*c == ' ')
+			{
+				cx += g.xadv + spacing;
+				continue;
+			}
+
+			float qx = cx + g.xoff + g.w*.5f;
+			float qy = y - g.yoff - g.h*.5f;
+
+			mesh->triangles[t + 0].pointIndices[0] = p + 0;
+			mesh->triangles[t + 0].pointIndices[1] = p + 1;
+			mesh->triangles[t + 0].pointIndices[2] = p + 2;
+			mesh->triangles[t + 1].pointIndices[0] = p + 0;
+			mesh->triangles[t + 1].pointIndices[1] = p + 2;
+			mesh->triangles[t + 1].pointIndices[2] = p + 3;
+			mesh->points[p + 0] = (TQ3Point3D) { qx - g.w*.5f, qy - g.h*.5f, z };
+			mesh->points[p + 1] = (TQ3Point3D) { qx + g.w*.5f, qy - g.h*.5f, z };
+			mesh->points[p + 2] = (TQ3Point3D) { qx + g.w*.5f, qy + g.h*.5f, z };
+			mesh->points[p + 3] = (TQ3Point3D) { qx - g.w*.5f, qy + g.h*.5f, z };
+			mesh->vertexUVs[p + 0] = (TQ3Param2D) { g.x/512.0f,			(g.y+g.h)/256.0f };
+			mesh->vertexUVs[p + 1] = (TQ3Param2D) { (g.x+g.w)/512.0f,	(g.y+g.h)/256.0f };
+			mesh->vertexUVs[p + 2] = (TQ3Param2D) { (g.x+g.w)/512.0f,	g.y/256.0f };
+			mesh->vertexUVs[p + 3] = (TQ3Param2D) { g.x/512.0f,			g.y/256.0f };
+
+			cx += g.xadv + spacing;
+			t += 2;
+			p += 4;
+		}
 
-		if (*c == ' ')
+		// Move on to the matching line in the previous text
+		if (prevLine)
 		{
-			x += g.xadv + spacing;
-			continue;
+			prevP += CountLineQuads(prevLine) * 4;
+			prevLine = SDL_strchr(prevLine, '\n');
+			if (prevLine)
+				prevLine++;
 		}
 
-		float qx = x + g.xoff + g.w*.5f;
-		float qy = y - g.yoff - g.h*.5f;
-
-		mesh->triangles[t + 0].pointIndices[0] = p + 0;
-		mesh->triangles[t + 0].pointIndices[1] = p + 1;
-		mesh->triangles[t + 0].pointIndices[2] = p + 2;
-		mesh->triangles[t + 1].pointIndices[0] = p + 0;
-		mesh->triangles[t + 1].pointIndices[1] = p + 2;
-		mesh->triangles[t + 1].pointIndices[2] = p + 3;
-		mesh->points[p + 0] = (TQ3Point3D) { qx - g.w*.5f, qy - g.h*.5f, z };
-		mesh->points[p + 1] = (TQ3Point3D) { qx + g.w*.5f, qy - g.h*.5f, z };
-		mesh->points[p + 2] = (TQ3Point3D) { qx + g.w*.5f, qy + g.h*.5f, z };
-		mesh->points[p + 3] = (TQ3Point3D) { qx - g.w*.5f, qy + g.h*.5f, z };
-		mesh->vertexUVs[p + 0] = (TQ3Param2D) { g.x/512.0f,			(g.y+g.h)/256.0f };
-		mesh->vertexUVs[p + 1] = (TQ3Param2D) { (g.x+g.w)/512.0f,	(g.y+g.h)/256.0f };
-		mesh->vertexUVs[p + 2] = (TQ3Param2D) { (g.x+g.w)/512.0f,	g.y/256.0f };
-		mesh->vertexUVs[p + 3] = (TQ3Param2D) { g.x/512.0f,			g.y/256.0f };
-
-		x += g.xadv + spacing;
-		t += 2;
-		p += 4;
+		if (!*c)
+			break;
+
+		line = c + 1;
+		y -= gLineHeight;
 	}
 
 	GAME_ASSERT(p == mesh->numPoints);
@@ -261,7 +324,7 @@ void TextMesh_Shutdown(void)
 
 	if (gFontTexture)
 	{
-		glDeleteTextures(1, &gFontTexture);
+		Render_DeleteTextures(1, &gFontTexture);
 		gFontTexture = 0;
 	}
 }
@@ -20,10 +20,10 @@
 
 static int GetSpriteWidth(int spriteNum);
 static void DrawSprite(int spriteNum, int x, int y);
-static void EraseSprite(int spriteNum, int x, int y);
+static void FillInfobarRect(const Rect r, uint32_t fillColor);
 static void ShowHealth(void);
 static void LoadSpriteResources(void);
-static void ShowBallTimerAndInventory(Boolean ballTimerOnly);
+static void ShowBallTimerAndInventory(void);
 static void ShowLadyBugs(void);
 static void ShowLives(void);
 static void ShowBlueClover(void);
@@ -65,9 +65,14 @@ static void ShowBossHealth(void);
 #define	BLUE_CLOVER_X		196
 #define	BLUE_CLOVER_Y		0
 
-#define	INFOBAR_TEXTURE_WIDTH	1024
-#define	INFOBAR_TEXTURE_HEIGHT	128
-#define	BOTTOM_BAR_Y_IN_TEXTURE	64
+#define	BOTTOM_BAR_Y		420
+
+#define	INFOBAR_ATLAS_WIDTH		1024
+#define	INFOBAR_ATLAS_HEIGHT	256
+#define	INFOBAR_ATLAS_PADDING	2					// gap around each sprite in the atlas (the inner pixel is a copy of the sprite's edge)
+#define	INFOBAR_ATLAS_WHITE_SIZE	4				// size of the solid white block used by filled rects
+
+#define	MAX_INFOBAR_SPRITE_QUADS	128				// sprites & filled rects in either bar (not counting the nitro gauge)
 
 
 		/* INFOBAR OBJTYPES */
@@ -148,28 +153,29 @@ short			gNumGreenClovers,gNumGoldClovers,gNumBlueClovers;
 static Boolean		gInfobarArtLoaded = false;
 
 static uint32_t*	gSprites[MAX_SPRITES];
-static uint32_t*	gSpriteMasks[MAX_SPRITES];
 static int			gSpriteWidths[MAX_SPRITES];
 static int			gSpriteHeights[MAX_SPRITES];
+static Rect			gSpriteAtlasRects[MAX_SPRITES];			// where each sprite lives in the atlas texture
+static Rect			gWhiteAtlasRect;						// solid white block in the atlas, for filled rects
 
+static GLuint			gInfobarAtlasTextureName = 0;
 static TQ3TriMeshData*	gInfobarTopMesh = nil;
 static TQ3TriMeshData*	gInfobarBottomMesh = nil;
+static int				gInfobarTopMeshCapacity = 0;		// in quads
+static int				gInfobarBottomMeshCapacity = 0;		// in quads
 
-static uint32_t*	gInfobarTexture = nil;
-static GLuint		gInfobarTextureName = 0;
-static Rect			gInfobarTextureDirtyRect;
-static Boolean		gInfobarTextureIsDirty = true;
+static TQ3TriMeshData*	gCurrentInfobarMesh = nil;			// mesh that DrawSprite & co. append quads to
+static int				gCurrentInfobarMeshCapacity = 0;
 
 static Byte		gLeftArmType, gRightArmType;
-static Byte		gOldLeftArmType, gOldRightArmType;
 
-static Boolean	gBallIconIsDisplayed;
 static Boolean	gBossHealthWasUpdated;
 
-static const int	gNitroGaugeMaxSkipsPerRow = 8;
+static const int	gNitroGaugeMaxSpansPerRow = 8;
 static Rect			gNitroGaugeRect;
 static uint8_t*		gNitroGaugeData		= nil;
-static int*			gNitroGaugeAlphaSkips	= nil;
+static int*			gNitroGaugeSpans	= nil;		// per row: pairs of [start;end) of opaque pixels, terminated by -1
+static int			gNitroGaugeMaxQuads	= 0;		// worst-case number of quads emitted by AddNitroGaugeQuads
 
 /**************** INIT INVENTORY FOR GAME *********************/
 
@@ -220,16 +226,10 @@ TerrainItemEntryType	*itemPtr;
 
 void DisposeInfobarTexture(void)
 {
-	if (gInfobarTexture)
-	{
-		DisposePtr((Ptr) gInfobarTexture);
-		gInfobarTexture = nil;
-	}
-
-	if (gInfobarTextureName)
+	if (gInfobarAtlasTextureName)
 	{
-		glDeleteTextures(1, &gInfobarTextureName);
-		gInfobarTextureName = 0;
+		Render_DeleteTextures(1, &gInfobarAtlasTextureName);
+		gInfobarAtlasTextureName = 0;
 	}
 
 	if (gInfobarTopMesh)
@@ -244,102 +244,168 @@ void DisposeInfobarTexture(void)
 		gInfobarBottomMesh = nil;
 	}
 
-	gInfobarTextureIsDirty = true;
+	gCurrentInfobarMesh = nil;
 }
 
-/*************** INIT INFOBAR **********************/
+
+/****************** CREATE INFOBAR ATLAS TEXTURE ********************/
 //
-// Doesnt init inventories, just the physical infobar itself.
+// Copies all sprites into one texture at the spots picked by PackSpriteAtlas.
+// Solid black is see-through in every sprite except the bar backgrounds.
 //
 
-void InitInfobar(void)
+static void CopySpriteToAtlas(uint32_t* atlas, int spriteNum)
 {
-	GAME_ASSERT(gInfobarArtLoaded);
-
-			/* SEE IF DISPOSE OLD TOP / BOTTOM */
-
-	DisposeInfobarTexture();
-
-			/* CREATE TEXTURE BUFFER */
+#if __BIG_ENDIAN__
+	const uint32_t alphaMask = 0x000000FF;
+#else
+	const uint32_t alphaMask = 0xFF000000;
+#endif
 
-	gInfobarTexture = (uint32_t*) NewPtrClear(sizeof(uint32_t) * 1024 * 128);
+	const Boolean colorKey = spriteNum != SPRITE_INFOBARTOP && spriteNum != SPRITE_INFOBARBOTTOM;
+	const int w = gSpriteWidths[spriteNum];
+	const int h = gSpriteHeights[spriteNum];
+	const Rect r = gSpriteAtlasRects[spriteNum];
 
-			/* DO TOP */
+	// Also extrude the sprite's edges by 1 pixel so that texture filtering doesn't pull in the gap
+	for (int row = -1; row <= h; row++)
+	{
+		const uint32_t* in = gSprites[spriteNum] + SDL_clamp(row, 0, h-1) * w;
+		uint32_t* out = atlas + (r.top + row) * INFOBAR_ATLAS_WIDTH + r.left;
 
-	DrawSprite(SPRITE_INFOBARTOP, 0, 0);
+		for (int col = -1; col <= w; col++)
+		{
+			uint32_t pixel = in[SDL_clamp(col, 0, w-1)];
+			out[col] = (colorKey && pixel == alphaMask) ? 0 : pixel;
+		}
+	}
+}
 
-			/* DO BOTTOM */
+static GLuint CreateInfobarAtlasTexture(void)
+{
+	uint32_t* atlas = (uint32_t*) NewPtrClear(sizeof(uint32_t) * INFOBAR_ATLAS_WIDTH * INFOBAR_ATLAS_HEIGHT);
 
-	DrawSprite(SPRITE_INFOBARBOTTOM, 0, BOTTOM_BAR_Y_IN_TEXTURE);
+	for (int i = 0; i < MAX_SPRITES; i++)
+	{
+		CopySpriteToAtlas(atlas, i);
+	}
 
-			/* CREATE TEXTURE */
+	for (int y = gWhiteAtlasRect.top; y < gWhiteAtlasRect.bottom; y++)
+	{
+		for (int x = gWhiteAtlasRect.left; x < gWhiteAtlasRect.right; x++)
+		{
+			atlas[y * INFOBAR_ATLAS_WIDTH + x] = 0xFFFFFFFF;
+		}
+	}
 
-	gInfobarTextureName = Render_LoadTexture(
-			GL_RGB,
-			1024,
-			128,
+	GLuint textureName = Render_LoadTexture(
+			GL_RGBA,
+			INFOBAR_ATLAS_WIDTH,
+			INFOBAR_ATLAS_HEIGHT,
 			GL_RGBA,
 			GL_UNSIGNED_BYTE,
-			gInfobarTexture,
+			atlas,
 			kRendererTextureFlags_ClampBoth
 	);
 	CHECK_GL_ERROR();
 
-			/* CREATE TOP MESH */
+	DisposePtr((Ptr) atlas);
 
-	float uMult = 1.0f / INFOBAR_TEXTURE_WIDTH;
-	float vMult = 1.0f / INFOBAR_TEXTURE_HEIGHT;
+	return textureName;
+}
 
-	GAME_ASSERT_MESSAGE(!gInfobarTopMesh, "infobar top mesh already created");
+static TQ3TriMeshData* NewInfobarMesh(int numQuads)
+{
+	TQ3TriMeshData* mesh = Q3TriMeshData_New(numQuads*2, numQuads*4, kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexColors);
+	mesh->texturingMode = kQ3TexturingModeAlphaTest;
+	mesh->glTextureName = gInfobarAtlasTextureName;
+	mesh->numTriangles = 0;
+	mesh->numPoints = 0;
+	return mesh;
+}
 
-	gInfobarTopMesh = MakeQuadMesh_UI(
-			0, 0, 640, 62,
-			0,
-			0,
-			uMult * 640,
-			vMult * 62
-	);
-	gInfobarTopMesh->texturingMode = kQ3TexturingModeOpaque;
-	gInfobarTopMesh->glTextureName = gInfobarTextureName;
+/*************** INIT INFOBAR **********************/
+//
+// Doesnt init inventories, just the physical infobar itself.
+//
+
+void InitInfobar(void)
+{
+	GAME_ASSERT(gInfobarArtLoaded);
 
-			/* CREATE BOTTOM MESH */
+			/* SEE IF DISPOSE OLD TOP / BOTTOM */
 
-	GAME_ASSERT_MESSAGE(!gInfobarBottomMesh, "infobar bottom mesh already created");
+	DisposeInfobarTexture();
 
-	if (!gGamePrefs.showBottomBar)
-	{
-		// Make a mesh that only shows the boss's health
-		gInfobarBottomMesh = MakeQuadMesh_UI(
-				(640-BOSS_WIDTH)/2, 420+20, (640+BOSS_WIDTH)/2, 420+40,
-				uMult * ((640-BOSS_WIDTH)/2 + 0.5f),
-				vMult * (BOTTOM_BAR_Y_IN_TEXTURE + 20 + 0.5f),
-				uMult * ((640+BOSS_WIDTH)/2 - 0.5f),
-				vMult * (BOTTOM_BAR_Y_IN_TEXTURE + 40 - 0.5f));
-	}
-	else
-	{
-		gInfobarBottomMesh = MakeQuadMesh_UI(
-				0, 420, 640, 480,
-				uMult * 0,
-				vMult * BOTTOM_BAR_Y_IN_TEXTURE,
-				uMult * 640,
-				vMult * (BOTTOM_BAR_Y_IN_TEXTURE + 60));
-	}
-	gInfobarBottomMesh->texturingMode = kQ3TexturingModeOpaque;
-	gInfobarBottomMesh->glTextureName = gInfobarTextureName;
+			/* CREATE TEXTURE */
 
+	gInfobarAtlasTextureName = CreateInfobarAtlasTexture();
+
+			/* CREATE TOP & BOTTOM MESHES */
+			//
+			// Their quads are rebuilt by UpdateInfobar whenever the infobar changes.
+			//
+
+	gInfobarTopMeshCapacity = MAX_INFOBAR_SPRITE_QUADS + gNitroGaugeMaxQuads;
+	gInfobarTopMesh = NewInfobarMesh(gInfobarTopMeshCapacity);
+
+	gInfobarBottomMeshCapacity = MAX_INFOBAR_SPRITE_QUADS;
+	gInfobarBottomMesh = NewInfobarMesh(gInfobarBottomMeshCapacity);
 
 			/* PRIME SCREEN */
 
-	gOldLeftArmType = gLeftArmType = SPRITE_EMPTYHAND_L;
-	gOldRightArmType = gRightArmType = SPRITE_EMPTYHAND_R;
-	gBallIconIsDisplayed = false;
+	gLeftArmType = SPRITE_EMPTYHAND_L;
+	gRightArmType = SPRITE_EMPTYHAND_R;
 
 	gInfobarUpdateBits = 0xffffffff;
 	UpdateInfobar();
 }
 
 
+/******************* REBUILD INFOBAR MESHES *********************/
+//
+// The bars are drawn from scratch in back-to-front order.
+// This only costs a handful of quads, and no texture uploads.
+//
+
+static void BeginInfobarMesh(TQ3TriMeshData* mesh, int capacity)
+{
+	GAME_ASSERT(mesh);
+
+	mesh->numTriangles = 0;
+	mesh->numPoints = 0;
+
+	gCurrentInfobarMesh = mesh;
+	gCurrentInfobarMeshCapacity = capacity;
+}
+
+static void RebuildInfobarTop(void)
+{
+	BeginInfobarMesh(gInfobarTopMesh, gInfobarTopMeshCapacity);
+
+	DrawSprite(SPRITE_INFOBARTOP, 0, 0);
+	ShowLives();
+	ShowGoldClover();
+	ShowBlueClover();
+	ShowLadyBugs();
+	ShowBallTimerAndInventory();
+	ShowHealth();
+
+	gCurrentInfobarMesh = nil;
+}
+
+static void RebuildInfobarBottom(void)
+{
+	BeginInfobarMesh(gInfobarBottomMesh, gInfobarBottomMeshCapacity);
+
+	if (gGamePrefs.showBottomBar)
+		DrawSprite(SPRITE_INFOBARBOTTOM, 0, BOTTOM_BAR_Y);
+	ShowBossHealth();
+
+	gCurrentInfobarMesh = nil;
+}
+
+
 /******************* UPDATE INFOBAR *********************/
 
 void UpdateInfobar(void)
@@ -348,47 +414,30 @@ unsigned long	bits;
 
 	bits = gInfobarUpdateBits;
 
-		/* UPDATE HEALTH */
-		
-	if (bits & UPDATE_HEALTH)
-		ShowHealth();
+		/* SEE IF BALL TIMER HAS CHANGED ENOUGH TO BOTHER */
 
-		/* UPDATE LIVES */
-		
-	if (bits & UPDATE_LIVES)
-		ShowLives();
+	if (bits & (UPDATE_TIMER | UPDATE_HANDS))
+	{
+		if (gBallTimer < 0.0f)
+			gBallTimer = 0.0;
+		int n = 180.0f * gBallTimer;
 
+		if (!(bits & UPDATE_HANDS) && abs(n - gOldTimerN) < 2)		// if hasnt changed enough, then dont bother
+			bits &= ~UPDATE_TIMER;
+		else
+			gOldTimerN = n;
+	}
+
+		/* REBUILD TOP BAR */
+
+	if (bits & ~UPDATE_BOSS)
+		RebuildInfobarTop();
 
-		/* UPDATE BALL TIMER */
-		
-	if (bits & UPDATE_TIMER)
-		ShowBallTimerAndInventory(true);
-	
-		
-		/* UPDATE LADY BUGS */
-		
-	if (bits & UPDATE_LADYBUGS)
-		ShowLadyBugs();
-	
-	
-		/* UPDATE HANDS */
-			
-	if (bits & UPDATE_HANDS)
-		ShowBallTimerAndInventory(false);
-	
-	
-		/* CLOVERS */
-		
-	if (bits & UPDATE_BLUECLOVER)
-		ShowBlueClover();
-	if (bits & UPDATE_GOLDCLOVER)
-		ShowGoldClover();
-	
 		/* BOSS HEALTH */
-		
+
 	if (bits & UPDATE_BOSS)
-		ShowBossHealth();	
-	
+		RebuildInfobarBottom();
+
 	gInfobarUpdateBits = 0;
 }
 
@@ -396,11 +445,71 @@ unsigned long	bits;
 
 #pragma mark -
 
+/******************* PACK SPRITE ATLAS **********************/
+//
+// Lays out the sprites on shelves in the atlas texture, tallest first.
+//
+
+static int CompareSpriteHeights(const void* a, const void* b)
+{
+	int spriteA = *(const int*) a;
+	int spriteB = *(const int*) b;
+
+	if (gSpriteHeights[spriteA] != gSpriteHeights[spriteB])
+		return gSpriteHeights[spriteB] - gSpriteHeights[spriteA];
+	return spriteA - spriteB;
+}
+
+static Rect AllocAtlasRect(int w, int h, int* shelfX, int* shelfY, int* shelfHeight)
+{
+	int paddedW = w + 2 * INFOBAR_ATLAS_PADDING;
+	int paddedH = h + 2 * INFOBAR_ATLAS_PADDING;
+
+	if (*shelfX + paddedW > INFOBAR_ATLAS_WIDTH)		// start new shelf
+	{
+		*shelfX = 0;
+		*shelfY += *shelfHeight;
+		*shelfHeight = 0;
+	}
+
+	GAME_ASSERT_MESSAGE(*shelfY + paddedH <= INFOBAR_ATLAS_HEIGHT, "infobar sprites don't fit in atlas");
+
+	Rect r;
+	r.left		= *shelfX + INFOBAR_ATLAS_PADDING;
+	r.top		= *shelfY + INFOBAR_ATLAS_PADDING;
+	r.right		= r.left + w;
+	r.bottom	= r.top + h;
+
+	*shelfX += paddedW;
+	*shelfHeight = SDL_max(*shelfHeight, paddedH);
+
+	return r;
+}
+
+static void PackSpriteAtlas(void)
+{
+int		order[MAX_SPRITES];
+int		shelfX = 0;
+int		shelfY = 0;
+int		shelfHeight = 0;
+
+	for (int i = 0; i < MAX_SPRITES; i++)
+		order[i] = i;
+	SDL_qsort(order, MAX_SPRITES, sizeof(order[0]), CompareSpriteHeights);
+
+	for (int i = 0; i < MAX_SPRITES; i++)
+	{
+		int spriteNum = order[i];
+		gSpriteAtlasRects[spriteNum] = AllocAtlasRect(gSpriteWidths[spriteNum], gSpriteHeights[spriteNum], &shelfX, &shelfY, &shelfHeight);
+	}
+
+	gWhiteAtlasRect = AllocAtlasRect(INFOBAR_ATLAS_WHITE_SIZE, INFOBAR_ATLAS_WHITE_SIZE, &shelfX, &shelfY, &shelfHeight);
+}
+
 /******************* LOAD SPRITE RESOURCES **********************/
 
 static void LoadSpriteResources(void)
 {
-FSSpec		spec;
 OSErr		err;
 uint8_t*	pixelData;
 TGAHeader	header;
@@ -412,28 +521,17 @@ char		path[256];
 	{
 		SDL_snprintf(path, sizeof(path), ":Images:Infobar:%d.tga", 128 + i);
 
-		FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &spec);
-		err = ReadTGA(&spec, &pixelData, &header, true);
+		err = ReadDataTGA(path, &pixelData, &header, true);
 		GAME_ASSERT(!err);
 
 		gSprites[i] = (uint32_t*) pixelData;
 		gSpriteWidths[i] = header.width;
 		gSpriteHeights[i] = header.height;
+	}
 
-		gSpriteMasks[i] = (uint32_t*) NewPtrClear(4 * header.width * header.height);
-
-
-#if __BIG_ENDIAN__
-		const uint32_t alphaMask = 0x000000FF;
-#else
-		const uint32_t alphaMask = 0xFF000000;
-#endif
+			/* LAY THEM OUT IN THE ATLAS */
 
-		for (int p = 0; p < header.width * header.height; p++)
-		{
-			gSpriteMasks[i][p] = gSprites[i][p]==alphaMask? 0x00000000: 0xFFFFFFFF;
-		}
-	}
+	PackSpriteAtlas();
 }
 
 /****************** LOAD INFOBAR ART ********************/
@@ -442,48 +540,72 @@ static void LoadNitroGaugeTemplate(void)
 {
 	GAME_ASSERT_MESSAGE(gNitroGaugeData == nil, "nitro gauge template already loaded");
 
-	FSSpec spec;
 	TGAHeader tga;
 	OSErr err;
-	
-	FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Images:Infobar:NitroGauge.tga", &spec);
-	err = ReadTGA(&spec, &gNitroGaugeData, &tga, false);
+
+	err = ReadDataTGA(":Images:Infobar:NitroGauge.tga", &gNitroGaugeData, &tga, false);
 	GAME_ASSERT(err == noErr);
 	GAME_ASSERT(tga.imageType == TGA_IMAGETYPE_RAW_GRAYSCALE);
-	
+
 	gNitroGaugeRect.left		= TIMER_X - tga.width/2;
 	gNitroGaugeRect.right		= gNitroGaugeRect.left + tga.width;
 	gNitroGaugeRect.top			= TIMER_Y;
 	gNitroGaugeRect.bottom		= gNitroGaugeRect.top + tga.height;
 
-	// Prepare alpha skip table. The nitro gauge is mostly made up of transparent pixels,
-	// so this will speed up rendering a little.
+	// Prepare span table. The nitro gauge is mostly made up of transparent pixels,
+	// so we only keep track of the runs of opaque pixels in each row.
+	//
+	// Within a span, the gauge color can only change where the template values
+	// turn around, so a span where the values go up and down N times can't
+	// produce more than 3*(N+1) quads (green, margin, black).
 
-	gNitroGaugeAlphaSkips	= (int*) NewPtrClear(tga.height * gNitroGaugeMaxSkipsPerRow * sizeof(int));
-	uint8_t*	grayscale	= gNitroGaugeData;
-	int*		skipTable	= gNitroGaugeAlphaSkips;
+	const int spansStride = 2 * gNitroGaugeMaxSpansPerRow + 1;
+
+	gNitroGaugeSpans = (int*) NewPtrClear(tga.height * spansStride * sizeof(int));
+	gNitroGaugeMaxQuads = 0;
+
+	const uint8_t* grayscale = gNitroGaugeData;
 	for (int y = 0; y < tga.height; y++)
 	{
-		int skipsThisRow = 0;
-		int* currentSkip = nil;
-		for (int x = 0; x < tga.width; x++)
+		int* spans = &gNitroGaugeSpans[y * spansStride];
+		int numSpans = 0;
+
+		int x = 0;
+		while (x < tga.width)
 		{
-			if ((*grayscale++) != 0)
+			if (grayscale[x] == 0)
 			{
-				currentSkip = nil;
-			}
-			else if (!currentSkip)
-			{
-				GAME_ASSERT(skipsThisRow < gNitroGaugeMaxSkipsPerRow);
-				currentSkip = &skipTable[skipsThisRow++];
-				*currentSkip = 1;
+				x++;
+				continue;
 			}
-			else
+
+			GAME_ASSERT(numSpans < gNitroGaugeMaxSpansPerRow);
+
+			int start = x;
+			int direction = 0;
+			int numMonotonicRuns = 1;
+
+			for (x++; x < tga.width && grayscale[x] != 0; x++)
 			{
-				(*currentSkip)++;
+				int delta = grayscale[x] - grayscale[x-1];
+				int newDirection = (delta > 0) - (delta < 0);
+				if (newDirection != 0 && newDirection != direction)
+				{
+					if (direction != 0)
+						numMonotonicRuns++;
+					direction = newDirection;
+				}
 			}
+
+			spans[2 * numSpans + 0] = start;
+			spans[2 * numSpans + 1] = x;
+			numSpans++;
+
+			gNitroGaugeMaxQuads += 3 * numMonotonicRuns;
 		}
-		skipTable += gNitroGaugeMaxSkipsPerRow;
+
+		spans[2 * numSpans] = -1;			// end of row
+		grayscale += tga.width;
 	}
 }
 
@@ -511,11 +633,11 @@ void FreeInfobarArt(void)
 		DisposePtr((Ptr) gNitroGaugeData);
 		gNitroGaugeData = nil;
 	}
-	
-	if (gNitroGaugeAlphaSkips != nil)
+
+	if (gNitroGaugeSpans != nil)
 	{
-		DisposePtr((Ptr) gNitroGaugeAlphaSkips);
-		gNitroGaugeAlphaSkips = nil;
+		DisposePtr((Ptr) gNitroGaugeSpans);
+		gNitroGaugeSpans = nil;
 	}
 
 	if (gInfobarArtLoaded)
@@ -523,51 +645,57 @@ void FreeInfobarArt(void)
 		for (int i = 0; i < MAX_SPRITES; i++)
 		{
 			DisposePtr((Ptr) gSprites[i]);
-			DisposePtr((Ptr) gSpriteMasks[i]);
 			gSprites[i] = nil;
-			gSpriteMasks[i] = nil;
 		}
 	}
 
 	gInfobarArtLoaded = false;
 }
 
-static uint32_t* GetInfobarTextureOffset(int x, int y)
-{
-	uint32_t* out = gInfobarTexture + (y * INFOBAR_TEXTURE_WIDTH + x);
-	GAME_ASSERT(out >= gInfobarTexture);
-	GAME_ASSERT(out < gInfobarTexture + 4 * INFOBAR_TEXTURE_WIDTH * INFOBAR_TEXTURE_HEIGHT);
-	return out;
-}
-
-static void DamageInfobarTextureRect(int x, int y, int w, int h)
-{
-	int left	= x;
-	int top		= y;
-	int right	= x + w;
-	int bottom	= y + h;
 
-	if (!gInfobarTextureIsDirty)
-	{
-		gInfobarTextureDirtyRect.left		= left;
-		gInfobarTextureDirtyRect.top		= top;
-		gInfobarTextureDirtyRect.right		= right;
-		gInfobarTextureDirtyRect.bottom		= bottom;
-	}
-	else
-	{
-#define MIN(a,b) ((a)<(b) ? (a) : (b))
-#define MAX(a,b) ((a)>(b) ? (a) : (b))
-		// Already dirty, expand existing dirty rect
-		gInfobarTextureDirtyRect.top    = MIN(gInfobarTextureDirtyRect.top,    top);
-		gInfobarTextureDirtyRect.left   = MIN(gInfobarTextureDirtyRect.left,   left);
-		gInfobarTextureDirtyRect.bottom = MAX(gInfobarTextureDirtyRect.bottom, bottom);
-		gInfobarTextureDirtyRect.right  = MAX(gInfobarTextureDirtyRect.right,  right);
-#undef MIN
-#undef MAX
-	}
+/********************** ADD INFOBAR QUAD ****************************/
+//
+// Appends a quad to the mesh being rebuilt.
+// xy are in 640x480 UI coordinates, uv are in atlas pixels.
+//
 
-	gInfobarTextureIsDirty = true;
+static void AddInfobarQuad(
+		float left, float top, float right, float bottom,
+		float uvLeft, float uvTop, float uvRight, float uvBottom,
+		TQ3ColorRGBA color)
+{
+	TQ3TriMeshData* mesh = gCurrentInfobarMesh;
+	GAME_ASSERT(mesh);
+	GAME_ASSERT_MESSAGE(mesh->numPoints < 4 * gCurrentInfobarMeshCapacity, "too many quads in infobar");
+
+	const float uMult = 1.0f / INFOBAR_ATLAS_WIDTH;
+	const float vMult = 1.0f / INFOBAR_ATLAS_HEIGHT;
+
+	int p = mesh->numPoints;
+	int t = mesh->numTriangles;
+
+	mesh->triangles[t + 0].pointIndices[0] = p + 0;
+	mesh->triangles[t + 0].pointIndices[1] = p + 1;
+	mesh->triangles[t + 0].pointIndices[2] = p + 2;
+	mesh->triangles[t + 1].pointIndices[0] = p + 0;
+	mesh->triangles[t + 1].pointIndices[1] = p + 2;
+	mesh->triangles[t + 1].pointIndices[2] = p + 3;
+
+	mesh->points[p + 0] = (TQ3Point3D) { left,	bottom,	0 };
+	mesh->points[p + 1] = (TQ3Point3D) { right,	bottom,	0 };
+	mesh->points[p + 2] = (TQ3Point3D) { right,	top,	0 };
+	mesh->points[p + 3] = (TQ3Point3D) { left,	top,	0 };
+
+	mesh->vertexUVs[p + 0] = (TQ3Param2D) { uvLeft * uMult,		uvBottom * vMult };
+	mesh->vertexUVs[p + 1] = (TQ3Param2D) { uvRight * uMult,	uvBottom * vMult };
+	mesh->vertexUVs[p + 2] = (TQ3Param2D) { uvRight * uMult,	uvTop * vMult };
+	mesh->vertexUVs[p + 3] = (TQ3Param2D) { uvLeft * uMult,		uvTop * vMult };
+
+	for (int i = 0; i < 4; i++)
+		mesh->vertexColors[p + i] = color;
+
+	mesh->numPoints += 4;
+	mesh->numTriangles += 2;
 }
 
 
@@ -578,59 +706,34 @@ static void DrawSprite(int spriteNum, int x, int y)
 	GAME_ASSERT(gInfobarArtLoaded);
 	GAME_ASSERT_MESSAGE(spriteNum < MAX_SPRITES, "illegal sprite #");
 
-	uint32_t* out = (uint32_t*) GetInfobarTextureOffset(x, y);
-	const uint32_t* in = gSprites[spriteNum];
-	const uint32_t* inMask = gSpriteMasks[spriteNum];
-
-	const int spriteWidth = gSpriteWidths[spriteNum];
-	const int spriteHeight = gSpriteHeights[spriteNum];
-
-	for (int row = 0; row < spriteHeight; row++)
-	{
-		for (int col = 0; col < spriteWidth; col++)
-		{
-			*out = (*out & ~*inMask) | *in;
-			out++;
-			in++;
-			inMask++;
-		}
-
-		out += INFOBAR_TEXTURE_WIDTH - spriteWidth;
-	}
-
-	GAME_ASSERT(out <= gInfobarTexture + INFOBAR_TEXTURE_WIDTH * INFOBAR_TEXTURE_HEIGHT);
+	const Rect r = gSpriteAtlasRects[spriteNum];
 
-	DamageInfobarTextureRect(x, y, spriteWidth, spriteHeight);
+	AddInfobarQuad(
+			x, y, x + gSpriteWidths[spriteNum], y + gSpriteHeights[spriteNum],
+			r.left, r.top, r.right, r.bottom,
+			(TQ3ColorRGBA) {1, 1, 1, 1});
 }
 
 
-/********************** ERASE SPRITE ****************************/
+/********************** FILL INFOBAR RECT ****************************/
+//
+// Solid-color quad. Color is in 0xRRGGBBAA form.
+//
 
-static void EraseSprite(int spriteNum, int x, int y)
+static void FillInfobarRect(const Rect r, uint32_t fillColor)
 {
-	GAME_ASSERT(gInfobarArtLoaded);
-	GAME_ASSERT_MESSAGE(spriteNum < MAX_SPRITES, "illegal sprite #");
-
-	const int spriteWidth = gSpriteWidths[spriteNum];
-	const int spriteHeight = gSpriteHeights[spriteNum];
-
-	const int backgroundWidth = gSpriteWidths[SPRITE_INFOBARTOP];
-
-	uint32_t* out = (uint32_t*) GetInfobarTextureOffset(x, y);
-
-	const uint32_t* in = gSprites[SPRITE_INFOBARTOP] + x + backgroundWidth * y;
-	//GAME_ASSERT(HandleBoundsCheck(....));
-
-	for (int row = 0; row < spriteHeight; row++)
+	TQ3ColorRGBA color =
 	{
-		SDL_memcpy(out, in, 4*spriteWidth);
-		out += INFOBAR_TEXTURE_WIDTH;
-		in += backgroundWidth;
-	}
+		.r = ((fillColor >> 24) & 0xFF) * (1.0f / 255.0f),
+		.g = ((fillColor >> 16) & 0xFF) * (1.0f / 255.0f),
+		.b = ((fillColor >>  8) & 0xFF) * (1.0f / 255.0f),
+		.a = 1.0f,
+	};
 
-	GAME_ASSERT(out <= gInfobarTexture + (INFOBAR_TEXTURE_WIDTH * INFOBAR_TEXTURE_HEIGHT * 4));
+	float u = (gWhiteAtlasRect.left + gWhiteAtlasRect.right) * .5f;
+	float v = (gWhiteAtlasRect.top + gWhiteAtlasRect.bottom) * .5f;
 
-	DamageInfobarTextureRect(x, y, spriteWidth, spriteHeight);
+	AddInfobarQuad(r.left, r.top, r.right, r.bottom, u, v, u, v, color);
 }
 
 
@@ -649,126 +752,76 @@ static int GetSpriteWidth(int spriteNum)
 
 /****************** DRAW NITRO GAUGE ************************/
 // Source port rewrite.
-// Original code used FrameArc(). We use a reference image instead.
+// Original code used FrameArc(). We use a reference image instead,
+// and emit one solid-color quad per run of same-colored pixels in each row.
 // arcSpan is in degrees. 0: gauge empty; 180: gauge full.
 
+static uint32_t GetNitroGaugeColor(uint8_t t, int arcSpan, Boolean wantMargin)
+{
+	t--;	// move value from [1;181] to [0;180] (zero is reserved for mask)
+
+	if (t <= arcSpan)						// green (original: 0x0000,0xBDEF,0x294A)
+		return 0x00bd29FF;
+	else if (wantMargin && t <= arcSpan+3)	// margin line (original: 0xffff,0xF7BD,0x0000)
+		return 0xfff700FF;
+	else									// black
+		return 0x000000FF;
+}
+
 static void DrawNitroGauge(int arcSpan)
 {
 	Boolean wantMargin = (arcSpan < 178) && (arcSpan > 2);
 
-	uint8_t* templateRow = gNitroGaugeData;
 	int nitroGaugeWidth = gNitroGaugeRect.right - gNitroGaugeRect.left;
 	int nitroGaugeHeight = gNitroGaugeRect.bottom - gNitroGaugeRect.top;
-	
-	uint32_t* outRow = GetInfobarTextureOffset(gNitroGaugeRect.left, gNitroGaugeRect.top);
 
-	int* skipTable = gNitroGaugeAlphaSkips;
+	const uint8_t* templateRow = gNitroGaugeData;
+	const int* spans = gNitroGaugeSpans;
 
 	for (int y = 0; y < nitroGaugeHeight; y++)
 	{
-		int* skipData = &skipTable[y * gNitroGaugeMaxSkipsPerRow];
-		int x = 0;
-		while (x < nitroGaugeWidth)
+		for (const int* span = spans; span[0] >= 0; span += 2)
 		{
-			uint8_t t = templateRow[x];
-			if (t == 0)
-			{
-				x += (*skipData++);
-				continue;
-			}
-
-			t--;	// move value from [1;181] to [0;180] (zero is reserved for mask)
-			
-			uint32_t fillColor = 0;
+			int runStart = span[0];
+			uint32_t runColor = GetNitroGaugeColor(templateRow[runStart], arcSpan, wantMargin);
 
-			if (t <= arcSpan)						// green (original: 0x0000,0xBDEF,0x294A)
-			{
-				fillColor = 0x00bd29FF;
-			}
-			else if (wantMargin && t <= arcSpan+3)	// margin line (original: 0xffff,0xF7BD,0x0000)
-			{
-				fillColor = 0xfff700FF;
-			}
-			else									// black
+			for (int x = runStart + 1; x <= span[1]; x++)
 			{
-				fillColor = 0x000000FF;
+				uint32_t color = (x < span[1]) ? GetNitroGaugeColor(templateRow[x], arcSpan, wantMargin) : 0;
+
+				if (x == span[1] || color != runColor)		// end of run
+				{
+					Rect r;
+					r.left		= gNitroGaugeRect.left + runStart;
+					r.right		= gNitroGaugeRect.left + x;
+					r.top		= gNitroGaugeRect.top + y;
+					r.bottom	= r.top + 1;
+					FillInfobarRect(r, runColor);
+
+					runStart = x;
+					runColor = color;
+				}
 			}
-
-			outRow[x] = UnpackU32BE(&fillColor);
-
-			x++;
 		}
 
 		templateRow += nitroGaugeWidth;
-		outRow += INFOBAR_TEXTURE_WIDTH;
+		spans += 2 * gNitroGaugeMaxSpansPerRow + 1;
 	}
-
-	DamageInfobarTextureRect(gNitroGaugeRect.left, gNitroGaugeRect.top, nitroGaugeWidth, nitroGaugeHeight);
 }
 
 
 /****************** SHOW BALL TIMER AND INVENTORY ************************/
 //
-// Shows the ball timer composited with the inventory hands
-//
-// INPUT:	ballTimerOnly = true if only need to update ball timer
+// Shows the ball timer composited with the inventory hands (or the ball icon in ball mode)
 //
 
-static void ShowBallTimerAndInventory(Boolean ballTimerOnly)
+static void ShowBallTimerAndInventory(void)
 {
-int		n;
-Boolean	eraseBugStuff;
-
-
-		/* IF ONLY NEED TO UPDATE TIMER, THEN SEE IF NECESSARY */
-		
-	if (gBallTimer < 0.0f)
-		gBallTimer = 0.0;
-	n = 180.0f * gBallTimer;
-	
-	if (ballTimerOnly)
-	{
-		if (abs(n - gOldTimerN) < 2)			// if hasnt changed enough, then dont bother
-			return;
-	}
-	gOldTimerN = n;
-
-
-			/* SEE IF ERASE BUG RELATED ICONS */
-			
-	if ((gPlayerMode == PLAYER_MODE_BALL) && (!gBallIconIsDisplayed))
-		eraseBugStuff = true;
-	else
-		eraseBugStuff = false;
-		
-
-			/***********************************/
-			/* SEE IF NEED TO ERASE ARMS FIRST */
-			/***********************************/
-
-	if (!gBallIconIsDisplayed)
-	{
-		if ((gOldLeftArmType != gLeftArmType) || eraseBugStuff)				// erase if changed
-			EraseSprite(gOldLeftArmType, HAND_X - GetSpriteWidth(gOldLeftArmType), HAND_Y);
-
-		if ((gOldRightArmType != gRightArmType) || eraseBugStuff)
-			EraseSprite(gOldRightArmType, HAND_X, HAND_Y);
-	}
-
-
-			/* SEE IF ERASE BALL */
-			
-	if ((gPlayerMode == PLAYER_MODE_BUG) && (gBallIconIsDisplayed))
-	{
-		EraseSprite(SPRITE_BALL, BALL_X, BALL_Y);
-		gBallIconIsDisplayed = false;
-	}
-
 				/**************/
 				/* DRAW METER */
 				/**************/
 
-	DrawNitroGauge(n);
+	DrawNitroGauge(gOldTimerN);
 
 
 		/***********************/
@@ -779,17 +832,11 @@ Boolean	eraseBugStuff;
 	{
 		DrawSprite(gLeftArmType, HAND_X - GetSpriteWidth(gLeftArmType), HAND_Y);
 		DrawSprite(gRightArmType, HAND_X, HAND_Y);
-		gBallIconIsDisplayed = false;
 	}
-	else
-	if ((!gBallIconIsDisplayed) || eraseBugStuff)				// draw ball icon instead
+	else														// draw ball icon instead
 	{
 		DrawSprite(SPRITE_BALL, BALL_X, BALL_Y);
-		gBallIconIsDisplayed = true;
 	}
-
-	gOldLeftArmType = gLeftArmType;
-	gOldRightArmType = gRightArmType;
 }
 
 
@@ -1034,24 +1081,6 @@ void LoseHealth(float amount)
 
 /****************** SHOW HEALTH ************************/
 
-static void FillInfobarRect(const Rect r, uint32_t fillColor)
-{
-	fillColor = UnpackU32BE(&fillColor);
-
-	uint32_t* dst = GetInfobarTextureOffset(r.left, r.top);
-
-	for (int y = r.top; y < r.bottom; y++)
-	{
-		for (int x = 0; x < r.right - r.left; x++)
-		{
-			dst[x] = fillColor;
-		}
-		dst += INFOBAR_TEXTURE_WIDTH;
-	}
-
-	DamageInfobarTextureRect(r.left, r.top, r.right - r.left, r.bottom - r.top);
-}
-
 static void ShowHealth(void)
 {
 int		n;
@@ -1104,8 +1133,6 @@ int	i,x;
 	{
 		if (i < (gNumLives-1))
 			DrawSprite(SPRITE_LIFE1+i, x, LIVES_Y);
-		else
-			EraseSprite(SPRITE_LIFE1+i, x, LIVES_Y);
 
 		x += LIVES_WIDTH;
 	}	
@@ -1158,8 +1185,6 @@ int	n;
 			
 		DrawSprite(SPRITE_BLUECLOVER1 + n, BLUE_CLOVER_X, BLUE_CLOVER_Y);
 	}
-	else
-		EraseSprite(SPRITE_BLUECLOVER1, BLUE_CLOVER_X, BLUE_CLOVER_Y);
 }
 
 
@@ -1178,8 +1203,6 @@ int	n;
 			
 		DrawSprite(SPRITE_GOLDCLOVER1 + n, GOLD_CLOVER_X, GOLD_CLOVER_Y);
 	}
-	else
-		EraseSprite(SPRITE_GOLDCLOVER1, GOLD_CLOVER_X, GOLD_CLOVER_Y);
 }
 
 
@@ -1230,7 +1253,7 @@ int		w,x;
 		/* DRAW IT */
 		/***********/
 			
-	r.top = BOTTOM_BAR_Y_IN_TEXTURE + 20;
+	r.top = BOTTOM_BAR_Y + 20;
 	r.bottom = r.top + 20;
 	r.left = 320-(BOSS_WIDTH/2);
 	x = r.right = r.left + BOSS_WIDTH;
@@ -1267,29 +1290,11 @@ int		w,x;
 
 void SubmitInfobarOverlay(void)
 {
-	if (!gInfobarTextureName)
+	if (!gInfobarAtlasTextureName)
 		return;
 
-	// If the screen port has dirty pixels ("damaged"), update the texture
-	if (gInfobarTextureIsDirty)
-	{
-		Render_UpdateTexture(
-				gInfobarTextureName,
-				gInfobarTextureDirtyRect.left,
-				gInfobarTextureDirtyRect.top,
-				gInfobarTextureDirtyRect.right - gInfobarTextureDirtyRect.left,
-				gInfobarTextureDirtyRect.bottom - gInfobarTextureDirtyRect.top,
-				GL_RGBA,
-				GL_UNSIGNED_BYTE,
-				GetInfobarTextureOffset(gInfobarTextureDirtyRect.left, gInfobarTextureDirtyRect.top),
-				INFOBAR_TEXTURE_WIDTH);
-
-		// Clear damage
-		gInfobarTextureIsDirty = false;
-	}
-
 	Render_SubmitMesh(gInfobarTopMesh, NULL, &kDefaultRenderMods_UI, &kQ3Point3D_Zero);
 
-	if (gGamePrefs.showBottomBar || gBossHealthWasUpdated)
+	if ((gGamePrefs.showBottomBar || gBossHealthWasUpdated) && gInfobarBottomMesh->numTriangles > 0)
 		Render_SubmitMesh(gInfobarBottomMesh, NULL, &kDefaultRenderMods_UI, &kQ3Point3D_Zero);
 }
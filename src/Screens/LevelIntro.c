@@ -76,6 +76,8 @@ enum
 	LINTRO_MObjType_Parachute
 };
 
+#define	PRELOAD_TIME_BUDGET_MS	4.0f				// time per frame spent uploading the level's preloaded art
+
 enum
 {
 	INTRO_CAM_MODE_RIGHTDRIFT,
@@ -198,12 +200,23 @@ void ShowLevelIntroScreen(void)
 	
 	DeleteAllObjects();
 	DeleteAllParticleGroups();
-	FreeAllSkeletonFiles(-1);
-	DeleteAll3DMFGroups();
-	QD3D_DisposeShards();
-	DisposeSoundBank(SOUNDBANK_MAIN);
-	QD3D_DisposeWindowSetup(&gGameViewInfoPtr);		
-	Pomme_FlushPtrTracking(true);
+
+	if (IsPreloadingLevelArt())						// the level's art is still coming in, so only free the intro's models
+	{												// (our skeleton & the main sound bank are part of the level's art too)
+		Free3DMFGroup(MODEL_GROUP_LEVELINTRO);
+		QD3D_DisposeShards();
+		StopAllEffectChannels();
+		QD3D_DisposeWindowSetup(&gGameViewInfoPtr);
+	}
+	else
+	{
+		FreeAllSkeletonFiles(-1);
+		DeleteAll3DMFGroups();
+		QD3D_DisposeShards();
+		DisposeSoundBank(SOUNDBANK_MAIN);
+		QD3D_DisposeWindowSetup(&gGameViewInfoPtr);
+		Pomme_FlushPtrTracking(true);
+	}
 }
 
 
@@ -298,6 +311,17 @@ TQ3Vector3D				fillDirection2 = { -.7, -.2, -.9 };			// fill
 			
 	}
 
+			/*********************************/
+			/* START LOADING THE LEVEL'S ART */
+			/*********************************/
+			//
+			// Do this after loading our own art: the level needs our skeleton too,
+			// so the preload won't queue it again.
+			//
+
+	StartPreloadingLevelArt();
+
+
 			/*******************/
 			/* MAKE BACKGROUND */
 			/*******************/
@@ -1466,6 +1490,7 @@ static Boolean WaitAndDraw(float duration)
 		MoveParticleGroups();
 		QD3D_MoveShards();
 		QD3D_DrawScene(gGameViewInfoPtr,IntroDrawStuff);
+		Jobs_Pump(PRELOAD_TIME_BUDGET_MS);
 		QD3D_CalcFramesPerSecond();				
 		DoSDLMaintenance();
 		duration -= gFramesPerSecondFrac;
@@ -99,7 +99,7 @@ bool DoLevelSelect(void)
 
 	CleanupUIStuff();
 
-	glDeleteTextures(NUM_LEVELS, levelScreenshots);
+	Render_DeleteTextures(NUM_LEVELS, levelScreenshots);
 
 	return proceed;
 }
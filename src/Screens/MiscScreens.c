@@ -250,7 +250,7 @@ int curState = kPauseChoice_Resume;
 
 			/* FREE MESH/TEXTURES */
 
-	glDeleteTextures(NUM_PAUSE_TEXTURES, textures);
+	Render_DeleteTextures(NUM_PAUSE_TEXTURES, textures);
 	Q3TriMeshData_Dispose(gPauseQuad);
 	gPauseQuad = nil;
 
@@ -16,6 +16,7 @@
 
 static const char* GenerateKiddieModeSubtitle(void);
 static const char* GenerateDetailSubtitle(void);
+static const char* GenerateViewDistanceSubtitle(void);
 static const char* GenerateMSAASubtitle(void);
 
 static void OnChangeFullscreenMode(void)
@@ -160,6 +161,15 @@ static SettingEntry gVideoMenu[] =
 		.choices = {"High", "Low"},
 	},
 
+	{
+		.kind = kCycler,
+		.ptr = &gGamePrefs.viewDistance,
+		.label = "View distance",
+		.subtitle = GenerateViewDistanceSubtitle,
+		.nChoices = NUM_VIEW_DISTANCES,
+		.choices = {"Normal", "Far", "Very far"},
+	},
+
 	{
 		.kind = kCycler,
 		.ptr = &gGamePrefs.force4x3AspectRatio,
@@ -231,6 +241,16 @@ static const char* GenerateDetailSubtitle(void)
 	return gGamePrefs.lowDetail ? "The \223ATI Rage II\224 look" : NULL;
 }
 
+static const char* GenerateViewDistanceSubtitle(void)
+{
+	if (gGamePrefs.viewDistance == VIEW_DISTANCE_NORMAL)
+		return NULL;
+	else if (gGamePrefs.lowDetail)
+		return "Requires high level of detail";
+	else
+		return "Uses more video memory";
+}
+
 static const char* GenerateMSAASubtitle(void)
 {
 	return gGamePrefs.antialiasingLevel != gCurrentAntialiasingLevel
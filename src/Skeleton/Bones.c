@@ -10,20 +10,54 @@
 /****************************/
 
 #include "game.h"
+#include <stddef.h>
 
 
 /****************************/
-/*    PROTOTYPES            */
+/*    CONSTANTS             */
 /****************************/
 
-static void DecomposeATriMesh(SkeletonDefType* gCurrentSkeleton, TQ3TriMeshData* triMeshData);
-static void UpdateSkinnedGeometry_Recurse(ObjNode* skelNode, short joint);
+#define	WELD_GRID_NUM_BUCKETS	2048				// must be a power of 2 (about twice the max # of entries)
+
+#define	WELD_POINT_TOLERANCE	0.001f				// same as PointsAreCloseEnough
+#define	WELD_NORMAL_TOLERANCE	0.02f				// same as VectorsAreCloseEnough
+
+_Static_assert(MAX_DECOMPOSED_NORMALS <= MAX_DECOMPOSED_POINTS, "weld grid entries are sized for points");
+_Static_assert(MAX_DECOMPOSED_POINTS <= 0x7FFF, "weld grid uses 16-bit indices");
 
 
 /****************************/
-/*    CONSTANTS             */
+/*    TYPES                 */
 /****************************/
 
+		/* WELD GRID */
+		//
+		// Spatial hash of the points (or normals) decomposed so far, keyed on coords quantized
+		// to cells twice as big as the weld tolerance. Anything within tolerance of a
+		// point is in the same cell or in one of the 26 neighboring cells.
+		//
+
+typedef struct
+{
+	float			cellSizeFrac;
+	float			tolerance;
+	const Byte*		entries;									// coords of entry #i start at entries + i*stride
+	size_t			stride;
+	int16_t			bucketHeads[WELD_GRID_NUM_BUCKETS];			// first entry in each bucket (-1 if empty)
+	int16_t			next[MAX_DECOMPOSED_POINTS];				// next entry in the same bucket
+} WeldGrid;
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static void DecomposeATriMesh(SkeletonDefType* gCurrentSkeleton, TQ3TriMeshData* triMeshData, WeldGrid* pointGrid, WeldGrid* normalGrid);
+static void InitWeldGrid(WeldGrid* grid, float tolerance, const void* entries, size_t stride);
+static int FindInWeldGrid(const WeldGrid* grid, const float* coords);
+static void AddToWeldGrid(WeldGrid* grid, int entry);
+static void UpdateSkinnedGeometry_Recurse(ObjNode* skelNode, short joint);
+
 
 /*********************/
 /*    VARIABLES      */
@@ -39,29 +73,38 @@ static	TQ3Vector3D			gTransformedNormals[MAX_DECOMPOSED_NORMALS];	// temporary b
 
 /******************** LOAD BONES REFERENCE MODEL *********************/
 //
+// Doesn't touch OpenGL, so it may run on a worker thread.
+// Call UploadBonesReferenceModelTextures on the main thread afterwards.
+//
 // INPUT: inSpec = spec of 3dmf file to load.
+//		  decompose = false if the decomposed point & normal lists were already restored from the skeleton cache.
 //
 
-void LoadBonesReferenceModel(const FSSpec	*inSpec, SkeletonDefType *skeleton)
+void LoadBonesReferenceModel(const FSSpec	*inSpec, SkeletonDefType *skeleton, Boolean decompose)
 {
 			/* LOAD 3DMF */
 
-	skeleton->associated3DMF = Q3MetaFile_Load3DMF(inSpec);
+	skeleton->associated3DMF = Load3DMFWithFlatCache(inSpec, &skeleton->associated3DMFFlatData);
 	GAME_ASSERT(skeleton->associated3DMF);
 
-			/* UPLOAD TEXTURES TO GPU */
+			/* JUST HOOK UP THE TRIMESHES IF THE DECOMPOSED DATA IS CACHED */
 
-	GAME_ASSERT(skeleton->numTextures == 0);
-	GAME_ASSERT(!skeleton->textureNames);
+	if (!decompose)
+	{
+		GAME_ASSERT(skeleton->associated3DMF->numMeshes <= MAX_DECOMPOSED_TRIMESHES);
 
-	skeleton->numTextures = skeleton->associated3DMF->numTextures;
-	skeleton->textureNames = (GLuint*) NewPtrClear(skeleton->numTextures * sizeof(GLuint));
+		skeleton->numDecomposedTriMeshes = skeleton->associated3DMF->numMeshes;
 
-	// We want to force clamp texture UVs on all skeleton models to avoid seams at the edges of
-	// alpha-tested textures. The only exception, which requires repeated texture UVs, is RootSwing.
-	bool forceClampUVs = 0 != SDL_strcasecmp("RootSwing.3dmf", inSpec->cName);
+		for (int i = 0; i < skeleton->associated3DMF->numMeshes; i++)
+		{
+			TQ3TriMeshData* triMeshData = skeleton->associated3DMF->meshes[i];
+			skeleton->decomposedTriMeshPtrs[i] = triMeshData;
 
-	Render_Load3DMFTextures(skeleton->associated3DMF, skeleton->textureNames, forceClampUVs);
+			for (int v = 0; v < triMeshData->numPoints; v++)							// normalize to be safe (as in DecomposeATriMesh)
+				Q3Vector3D_Normalize(&triMeshData->vertexNormals[v], &triMeshData->vertexNormals[v]);
+		}
+		return;
+	}
 
 			/* DECOMPOSE REFERENCE MODEL */
 
@@ -69,16 +112,125 @@ void LoadBonesReferenceModel(const FSSpec	*inSpec, SkeletonDefType *skeleton)
 	skeleton->numDecomposedPoints		= 0;
 	skeleton->numDecomposedNormals		= 0;
 
+	WeldGrid pointGrid;
+	WeldGrid normalGrid;
+	InitWeldGrid(&pointGrid, WELD_POINT_TOLERANCE,
+			(const Byte*) skeleton->decomposedPointList + offsetof(DecomposedPointType, realPoint), sizeof(DecomposedPointType));
+	InitWeldGrid(&normalGrid, WELD_NORMAL_TOLERANCE,
+			skeleton->decomposedNormalsList, sizeof(TQ3Vector3D));
+
 	for (int i = 0; i < skeleton->associated3DMF->numMeshes; i++)
 	{
-		DecomposeATriMesh(skeleton, skeleton->associated3DMF->meshes[i]);
+		DecomposeATriMesh(skeleton, skeleton->associated3DMF->meshes[i], &pointGrid, &normalGrid);
+	}
+}
+
+
+/******************** UPLOAD BONES REFERENCE MODEL TEXTURES *********************/
+//
+// Main thread only.
+//
+
+void UploadBonesReferenceModelTextures(SkeletonDefType *skeleton, Boolean forceClampUVs)
+{
+	GAME_ASSERT(skeleton->associated3DMF);
+	GAME_ASSERT(skeleton->numTextures == 0);
+	GAME_ASSERT(!skeleton->textureNames);
+
+	skeleton->numTextures = skeleton->associated3DMF->numTextures;
+	skeleton->textureNames = (GLuint*) NewPtrClear(skeleton->numTextures * sizeof(GLuint));
+
+	Render_Load3DMFTextures(skeleton->associated3DMF, skeleton->textureNames, forceClampUVs);
+}
+
+
+#pragma mark -
+
+/******************* INIT WELD GRID ***********************/
+
+static void InitWeldGrid(WeldGrid* grid, float tolerance, const void* entries, size_t stride)
+{
+	grid->cellSizeFrac	= 1.0f / (2.0f * tolerance);
+	grid->tolerance		= tolerance;
+	grid->entries		= (const Byte*) entries;
+	grid->stride		= stride;
+
+	for (int i = 0; i < WELD_GRID_NUM_BUCKETS; i++)
+		grid->bucketHeads[i] = -1;
+}
+
+static inline const float* GetWeldGridCoords(const WeldGrid* grid, int entry)
+{
+	return (const float*) (grid->entries + entry * grid->stride);
+}
+
+static inline uint32_t HashWeldGridCell(int x, int y, int z)
+{
+	uint32_t h = ((uint32_t) x * 73856093u) ^ ((uint32_t) y * 19349663u) ^ ((uint32_t) z * 83492791u);
+	return h & (WELD_GRID_NUM_BUCKETS - 1);
+}
+
+
+/******************* FIND IN WELD GRID ***********************/
+//
+// Returns the lowest-numbered entry within tolerance of the coords (i.e. the same entry
+// that a linear search of the list would find), or -1 if there's none.
+//
+
+static int FindInWeldGrid(const WeldGrid* grid, const float* coords)
+{
+	int cx = (int) floorf(coords[0] * grid->cellSizeFrac);
+	int cy = (int) floorf(coords[1] * grid->cellSizeFrac);
+	int cz = (int) floorf(coords[2] * grid->cellSizeFrac);
+	int best = -1;
+
+	for (int z = cz-1; z <= cz+1; z++)
+	for (int y = cy-1; y <= cy+1; y++)
+	for (int x = cx-1; x <= cx+1; x++)
+	{
+		for (int i = grid->bucketHeads[HashWeldGridCell(x, y, z)]; i >= 0; i = grid->next[i])
+		{
+			if (best >= 0 && i >= best)
+				continue;
+
+			const float* other = GetWeldGridCoords(grid, i);
+
+			if (fabsf(coords[0] - other[0]) < grid->tolerance
+				&& fabsf(coords[1] - other[1]) < grid->tolerance
+				&& fabsf(coords[2] - other[2]) < grid->tolerance)
+			{
+				best = i;
+			}
+		}
 	}
+
+	return best;
+}
+
+
+/******************* ADD TO WELD GRID ***********************/
+//
+// The entry's coords must already be stored in the list.
+//
+
+static void AddToWeldGrid(WeldGrid* grid, int entry)
+{
+	const float* coords = GetWeldGridCoords(grid, entry);
+
+	uint32_t bucket = HashWeldGridCell(
+			(int) floorf(coords[0] * grid->cellSizeFrac),
+			(int) floorf(coords[1] * grid->cellSizeFrac),
+			(int) floorf(coords[2] * grid->cellSizeFrac));
+
+	GAME_ASSERT(entry < MAX_DECOMPOSED_POINTS);
+	grid->next[entry] = grid->bucketHeads[bucket];
+	grid->bucketHeads[bucket] = entry;
 }
 
 
 /******************* DECOMPOSE A TRIMESH ***********************/
 
-static void DecomposeATriMesh(SkeletonDefType* gCurrentSkeleton, TQ3TriMeshData* triMeshData)
+static void DecomposeATriMesh(SkeletonDefType* gCurrentSkeleton, TQ3TriMeshData* triMeshData, WeldGrid* pointGrid, WeldGrid* normalGrid)
 {
 long				numVertices;
 TQ3Point3D			*vertexList;
@@ -105,24 +257,23 @@ DecomposedPointType	*decomposedPoint;
 	for (long vertNum = 0; vertNum < numVertices; vertNum++)
 	{				
 			/* SEE IF THIS POINT IS ALREADY IN DECOMPOSED LIST */
-				
-		for (pointNum=0; pointNum < gCurrentSkeleton->numDecomposedPoints; pointNum++)
+
+		pointNum = FindInWeldGrid(pointGrid, &vertexList[vertNum].x);
+		if (pointNum >= 0)
 		{
 			decomposedPoint = &gCurrentSkeleton->decomposedPointList[pointNum];					// point to this decomposed point
-			
-			if (PointsAreCloseEnough(&vertexList[vertNum],&decomposedPoint->realPoint))			// see if close enough to match
-			{
-					/* ADD ANOTHER REFERENCE */
-					
-				refNum = decomposedPoint->numRefs;												// get # refs for this point
-				GAME_ASSERT(refNum < MAX_POINT_REFS);
 
-				decomposedPoint->whichTriMesh[refNum] = n;										// set triMesh #
-				decomposedPoint->whichPoint[refNum] = vertNum;									// set point #
-				decomposedPoint->numRefs++;														// inc counter
-				goto added_vert;
-			}
+				/* ADD ANOTHER REFERENCE */
+
+			refNum = decomposedPoint->numRefs;													// get # refs for this point
+			GAME_ASSERT(refNum < MAX_POINT_REFS);
+
+			decomposedPoint->whichTriMesh[refNum] = n;											// set triMesh #
+			decomposedPoint->whichPoint[refNum] = vertNum;										// set point #
+			decomposedPoint->numRefs++;															// inc counter
+			goto added_vert;
 		}
+
 				/* IT'S A NEW POINT SO ADD TO LIST */
 				
 		pointNum = gCurrentSkeleton->numDecomposedPoints;
@@ -135,7 +286,8 @@ DecomposedPointType	*decomposedPoint;
 		decomposedPoint->whichTriMesh[refNum] = n;											// set triMesh #
 		decomposedPoint->whichPoint[refNum] = vertNum;										// set point #
 		decomposedPoint->numRefs = 1;														// set # refs to 1
-		
+		AddToWeldGrid(pointGrid, pointNum);
+
 		gCurrentSkeleton->numDecomposedPoints++;											// inc # decomposed points
 		
 added_vert:
@@ -149,9 +301,9 @@ added_vert:
 					
 		Q3Vector3D_Normalize(&normalPtr[vertNum],&normalPtr[vertNum]);						// normalize to be safe
 					
-		for (i=0; i < gCurrentSkeleton->numDecomposedNormals; i++)
-			if (VectorsAreCloseEnough(&normalPtr[vertNum],&gCurrentSkeleton->decomposedNormalsList[i]))	// if already in list, then dont add it again
-				goto added_norm;
+		i = FindInWeldGrid(normalGrid, &normalPtr[vertNum].x);
+		if (i >= 0)																		// if already in list, then dont add it again
+			goto added_norm;
 	
 
 				/* ADD NEW NORMAL TO LIST */
@@ -160,6 +312,7 @@ added_vert:
 		GAME_ASSERT(i < MAX_DECOMPOSED_NORMALS);
 
 		gCurrentSkeleton->decomposedNormalsList[i] = normalPtr[vertNum];				// add new normal to list			
+		AddToWeldGrid(normalGrid, i);
 		gCurrentSkeleton->numDecomposedNormals++;										// inc # decomposed normals
 		
 added_norm:
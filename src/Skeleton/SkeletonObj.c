@@ -18,6 +18,9 @@
 
 static SkeletonObjDataType *MakeNewSkeletonBaseData(short sourceSkeletonNum);
 static void DisposeSkeletonDefinitionMemory(SkeletonDefType *skeleton);
+static void RegisterSkeleton(Byte num, SkeletonDefType* skeleton);
+static void LoadASkeleton_Work(void* userData);
+static void LoadASkeleton_Finish(void* userData);
 
 
 /****************************/
@@ -31,6 +34,7 @@ static void DisposeSkeletonDefinitionMemory(SkeletonDefType *skeleton);
 
 static SkeletonDefType		*gLoadedSkeletonsList[MAX_SKELETON_TYPES];
 static TQ3BoundingSphere	gSkeletonBoundingSpheres[MAX_SKELETON_TYPES];
+static SkeletonDefType		*gPendingSkeletons[MAX_SKELETON_TYPES];		// loaded by QueueSkeletonLoad's worker, waiting to be registered
 
 
 
@@ -51,13 +55,68 @@ void LoadASkeleton(Byte num)
 	GAME_ASSERT(num < MAX_SKELETON_TYPES);
 
 	if (gLoadedSkeletonsList[num] == nil)					// check if already loaded
-		gLoadedSkeletonsList[num] = LoadSkeletonFile(num);
+		RegisterSkeleton(num, LoadSkeletonFile(num));
+}
+
+
+/******************** QUEUE A SKELETON LOAD ****************************/
+//
+// Same as LoadASkeleton, but the skeleton file is loaded by a worker thread
+// and registered once Jobs_RunAll gets to it.
+//
+// OUTPUT:	the job, or nil if the skeleton is already loaded.
+//
+
+Job* QueueSkeletonLoad(Byte num)
+{
+	GAME_ASSERT(num < MAX_SKELETON_TYPES);
+
+	if (gLoadedSkeletonsList[num] != nil)					// check if already loaded
+		return nil;
+
+	GAME_ASSERT(gPendingSkeletons[num] == nil);
+
+	return Jobs_Add(LoadASkeleton_Work, LoadASkeleton_Finish, (void*) (intptr_t) num, 0, NULL);
+}
+
+static void LoadASkeleton_Work(void* userData)
+{
+	Byte num = (Byte) (intptr_t) userData;
+	gPendingSkeletons[num] = LoadSkeletonFile(num);
+}
+
+static void LoadASkeleton_Finish(void* userData)
+{
+	Byte num = (Byte) (intptr_t) userData;
+	RegisterSkeleton(num, gPendingSkeletons[num]);
+	gPendingSkeletons[num] = nil;
+}
+
+
+/******************** REGISTER SKELETON ****************************/
+//
+// Uploads the textures of a freshly-loaded skeleton file & makes it available to MakeNewSkeletonObject.
+// Main thread only.
+//
+
+static void RegisterSkeleton(Byte num, SkeletonDefType* skeleton)
+{
+	GAME_ASSERT(skeleton);
+	GAME_ASSERT(gLoadedSkeletonsList[num] == nil);
+
+	gLoadedSkeletonsList[num] = skeleton;
+
+			/* UPLOAD TEXTURES TO GPU */
+
+	// We want to force clamp texture UVs on all skeleton models to avoid seams at the edges of
+	// alpha-tested textures. The only exception, which requires repeated texture UVs, is RootSwing.
+	UploadBonesReferenceModelTextures(skeleton, num != SKELETON_TYPE_ROOTSWING);
 
 			/* CALC BOUNDING SPHERE OF OBJECT */
 
 	QD3D_CalcObjectBoundingSphere(
-			gLoadedSkeletonsList[num]->numDecomposedTriMeshes,
-			gLoadedSkeletonsList[num]->decomposedTriMeshPtrs,
+			skeleton->numDecomposedTriMeshes,
+			skeleton->decomposedTriMeshPtrs,
 			&gSkeletonBoundingSpheres[num]
 			);
 
@@ -65,9 +124,9 @@ void LoadASkeleton(Byte num)
 
 	if (num == SKELETON_TYPE_KINGANT)
 	{
-		gLoadedSkeletonsList[num]->decomposedTriMeshPtrs[3]->texturingMode |= kQ3TexturingModeExt_NullShaderFlag;	// eyebrows
-		gLoadedSkeletonsList[num]->decomposedTriMeshPtrs[8]->texturingMode |= kQ3TexturingModeExt_NullShaderFlag;	// hair
-		gLoadedSkeletonsList[num]->decomposedTriMeshPtrs[9]->texturingMode |= kQ3TexturingModeExt_NullShaderFlag;	// beard
+		skeleton->decomposedTriMeshPtrs[3]->texturingMode |= kQ3TexturingModeExt_NullShaderFlag;	// eyebrows
+		skeleton->decomposedTriMeshPtrs[8]->texturingMode |= kQ3TexturingModeExt_NullShaderFlag;	// hair
+		skeleton->decomposedTriMeshPtrs[9]->texturingMode |= kQ3TexturingModeExt_NullShaderFlag;	// beard
 	}
 }
 
@@ -294,15 +353,16 @@ static void DisposeSkeletonDefinitionMemory(SkeletonDefType *skeleton)
 
 	if (skeleton->associated3DMF)
 	{
-		Q3MetaFile_Dispose(skeleton->associated3DMF);
+		Dispose3DMFWithFlatCache(skeleton->associated3DMF, skeleton->associated3DMFFlatData);
 		skeleton->associated3DMF = nil;
+		skeleton->associated3DMFFlatData = nil;
 	}
 
 			/* DISPOSE OF TEXTURES */
 
 	if (skeleton->textureNames)
 	{
-		glDeleteTextures(skeleton->numTextures, skeleton->textureNames);
+		Render_DeleteTextures(skeleton->numTextures, skeleton->textureNames);
 		DisposePtr((Ptr) skeleton->textureNames);
 		skeleton->numTextures = 0;
 		skeleton->textureNames = nil;
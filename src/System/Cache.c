@@ -0,0 +1,429 @@
+// CACHE.C
+// This file is part of Bugdom. https://github.com/jorio/bugdom
+
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	CACHE_FORMAT_VERSION	2					// bump when CacheFileHeader or HashBytes changes
+#define	CACHE_BYTE_ORDER_MARK	0x01020304			// cache files are only valid on machines with the same endianness
+#define	CACHE_FILE_PREFIX		"Cache-"
+
+#define	CACHE_HASH_CHUNK_SIZE	(64 * 1024)			// must be a multiple of 8 (see HashBytes)
+#define	CACHE_STAMP_BLOCK_SIZE	4096				// size of each block sampled by Cache_StampFile
+
+#define	FNV1A_64_OFFSET_BASIS	0xcbf29ce484222325ull
+#define	FNV1A_64_PRIME			0x00000100000001b3ull
+
+
+/****************************/
+/*    TYPES                 */
+/****************************/
+
+		/* CACHE FILE HEADER */
+		//
+		// Stored in native byte order, followed by the payload.
+		//
+
+typedef struct
+{
+	char		magic[4];
+	uint32_t	byteOrderMark;
+	uint32_t	formatVersion;
+	uint32_t	payloadVersion;
+	uint32_t	numSourceHashes;
+	uint32_t	pad;
+	uint64_t	sourceHashes[CACHE_MAX_SOURCE_HASHES];
+	uint64_t	payloadSize;
+	uint64_t	payloadHash;
+} CacheFileHeader;
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static uint64_t HashBytes(uint64_t hash, const void* data, long size);
+static OSErr MakeCacheFSSpec(const char* name, bool createFolder, FSSpec* spec);
+static bool OpenCacheFile(const char* name, uint32_t payloadVersion, const uint64_t* sourceHashes, int numSourceHashes, short* outRefNum, CacheFileHeader* outHeader);
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+static const char kCacheMagic[4] = {'B','C','c','h'};
+
+
+/******************** HASH BYTES **********************/
+//
+// 64-bit FNV-1a, fed 8 bytes at a time (then byte by byte for the tail).
+// It's only a corruption check, and this is several times faster than going byte by byte.
+// When hashing a stream in pieces, every piece but the last must be a multiple of 8 bytes.
+//
+
+static uint64_t HashBytes(uint64_t hash, const void* data, long size)
+{
+	const Byte* bytes = (const Byte*) data;
+	long i = 0;
+
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t word;
+		SDL_memcpy(&word, bytes + i, 8);
+		hash ^= word;
+		hash *= FNV1A_64_PRIME;
+	}
+
+	for (; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= FNV1A_64_PRIME;
+	}
+
+	return hash;
+}
+
+
+/******************** HASH FILE **********************/
+
+uint64_t Cache_HashFile(const FSSpec* spec, bool resourceFork)
+{
+OSErr		iErr;
+short		refNum;
+long		count;
+uint64_t	hash = FNV1A_64_OFFSET_BASIS;
+
+	Jobs_LockFiles();
+	if (resourceFork)
+		iErr = FSpOpenRF(spec, fsRdPerm, &refNum);
+	else
+		iErr = FSpOpenDF(spec, fsRdPerm, &refNum);
+	Jobs_UnlockFiles();
+	if (iErr)
+		return 0;
+
+	Ptr buffer = NewPtr(CACHE_HASH_CHUNK_SIZE);
+	GAME_ASSERT(buffer);
+
+	do
+	{
+		count = CACHE_HASH_CHUNK_SIZE;
+		Jobs_LockFiles();										// only hold the lock while reading, so other jobs can hash concurrently
+		iErr = FSRead(refNum, &count, buffer);
+		Jobs_UnlockFiles();
+		hash = HashBytes(hash, buffer, count);
+	} while (iErr == noErr && count == CACHE_HASH_CHUNK_SIZE);
+
+	DisposePtr(buffer);
+
+	Jobs_LockFiles();
+	FSClose(refNum);
+	Jobs_UnlockFiles();
+
+	if (iErr != noErr && iErr != eofErr)
+		return 0;
+
+	return hash != 0 ? hash : 1;									// 0 is reserved for "can't read"
+}
+
+
+/******************** STAMP FILE **********************/
+//
+// Hashes a file's size and a few blocks sampled from its start, middle and end.
+// This costs a few small reads no matter how big the file is.
+//
+
+uint64_t Cache_StampFile(const FSSpec* spec, bool resourceFork)
+{
+OSErr		iErr;
+short		refNum;
+long		eof = 0;
+long		count;
+uint64_t	hash = FNV1A_64_OFFSET_BASIS;
+Byte		block[CACHE_STAMP_BLOCK_SIZE];
+
+	Jobs_LockFiles();
+
+	if (resourceFork)
+		iErr = FSpOpenRF(spec, fsRdPerm, &refNum);
+	else
+		iErr = FSpOpenDF(spec, fsRdPerm, &refNum);
+	if (iErr)
+	{
+		Jobs_UnlockFiles();
+		return 0;
+	}
+
+	iErr = GetEOF(refNum, &eof);
+
+	uint64_t size = eof;
+	hash = HashBytes(hash, &size, sizeof(size));
+
+	const long blockOffsets[3] =
+	{
+		0,
+		(eof - CACHE_STAMP_BLOCK_SIZE) / 2,
+		eof - CACHE_STAMP_BLOCK_SIZE,
+	};
+
+	for (int i = 0; iErr == noErr && i < 3; i++)
+	{
+		if (i > 0 && eof <= CACHE_STAMP_BLOCK_SIZE)					// the first block already covers the whole file
+			break;
+
+		iErr = SetFPos(refNum, fsFromStart, blockOffsets[i]);
+		if (iErr == noErr)
+		{
+			count = SDL_min(eof, CACHE_STAMP_BLOCK_SIZE);
+			iErr = FSRead(refNum, &count, (Ptr) block);
+			hash = HashBytes(hash, block, count);
+		}
+	}
+
+	FSClose(refNum);
+	Jobs_UnlockFiles();
+
+	if (iErr != noErr && iErr != eofErr)
+		return 0;
+
+	return hash != 0 ? hash : 1;									// 0 is reserved for "can't read"
+}
+
+
+/******************** MAKE CACHE FSSPEC **********************/
+
+static OSErr MakeCacheFSSpec(const char* name, bool createFolder, FSSpec* spec)
+{
+	char filename[64];
+	SDL_snprintf(filename, sizeof(filename), "%s%s", CACHE_FILE_PREFIX, name);
+
+	return MakePrefsFSSpec(filename, createFolder, spec);
+}
+
+
+/******************** OPEN CACHE FILE **********************/
+//
+// Opens a cache file and checks that its header matches what the caller wants.
+// On success, the file is positioned at the start of the payload.
+// The caller must hold the file lock, and close the file if this returns true.
+//
+
+static bool OpenCacheFile(const char* name, uint32_t payloadVersion, const uint64_t* sourceHashes, int numSourceHashes, short* outRefNum, CacheFileHeader* outHeader)
+{
+OSErr			iErr;
+FSSpec			spec;
+short			refNum;
+long			count;
+long			eof = 0;
+
+	GAME_ASSERT(numSourceHashes <= CACHE_MAX_SOURCE_HASHES);
+
+	for (int i = 0; i < numSourceHashes; i++)						// can't validate the cache without all source hashes
+	{
+		if (sourceHashes[i] == 0)
+			return false;
+	}
+
+	if (MakeCacheFSSpec(name, false, &spec) != noErr)
+		return false;
+
+	iErr = FSpOpenDF(&spec, fsRdPerm, &refNum);
+	if (iErr)
+		return false;
+
+	GetEOF(refNum, &eof);
+
+	count = sizeof(*outHeader);
+	iErr = FSRead(refNum, &count, (Ptr) outHeader);
+	if (iErr
+		|| count != sizeof(*outHeader)
+		|| 0 != SDL_memcmp(outHeader->magic, kCacheMagic, sizeof(kCacheMagic))
+		|| outHeader->byteOrderMark != CACHE_BYTE_ORDER_MARK
+		|| outHeader->formatVersion != CACHE_FORMAT_VERSION
+		|| outHeader->payloadVersion != payloadVersion
+		|| outHeader->numSourceHashes != (uint32_t) numSourceHashes
+		|| 0 != SDL_memcmp(outHeader->sourceHashes, sourceHashes, numSourceHashes * sizeof(uint64_t))
+		|| outHeader->payloadSize != (uint64_t) (eof - (long) sizeof(*outHeader)))
+	{
+		FSClose(refNum);
+		return false;
+	}
+
+	*outRefNum = refNum;
+	return true;
+}
+
+
+/******************** LOAD CACHE FILE **********************/
+
+Ptr Cache_Load(const char* name, uint32_t payloadVersion, const uint64_t* sourceHashes, int numSourceHashes, long* outPayloadSize)
+{
+OSErr			iErr;
+short			refNum;
+long			count;
+CacheFileHeader	header;
+
+	Jobs_LockFiles();
+
+	if (!OpenCacheFile(name, payloadVersion, sourceHashes, numSourceHashes, &refNum, &header))
+	{
+		Jobs_UnlockFiles();
+		return nil;
+	}
+
+				/* READ PAYLOAD IN ONE GO */
+
+	Ptr payload = NewPtr(header.payloadSize);
+	GAME_ASSERT(payload);
+
+	count = header.payloadSize;
+	iErr = FSRead(refNum, &count, payload);
+	FSClose(refNum);
+	Jobs_UnlockFiles();
+
+	if (iErr
+		|| count != (long) header.payloadSize
+		|| header.payloadHash != HashBytes(FNV1A_64_OFFSET_BASIS, payload, count))
+	{
+		DisposePtr(payload);
+		return nil;
+	}
+
+	*outPayloadSize = count;
+	return payload;
+}
+
+
+/******************** LOAD CACHE FILE INTO HANDLE **********************/
+
+Handle Cache_LoadHandle(const char* name, uint32_t payloadVersion, const uint64_t* sourceHashes, int numSourceHashes, void* outPrefix, long prefixSize)
+{
+OSErr			iErr;
+short			refNum;
+long			count;
+CacheFileHeader	header;
+Handle			payload = nil;
+
+	GAME_ASSERT(prefixSize % 8 == 0);								// so the payload hash comes out the same in two pieces
+
+	Jobs_LockFiles();
+
+	if (!OpenCacheFile(name, payloadVersion, sourceHashes, numSourceHashes, &refNum, &header))
+	{
+		Jobs_UnlockFiles();
+		return nil;
+	}
+
+	if (header.payloadSize < (uint64_t) prefixSize)
+		goto bail;
+
+				/* READ PREFIX, THEN THE REST STRAIGHT INTO THE HANDLE */
+
+	count = prefixSize;
+	iErr = FSRead(refNum, &count, (Ptr) outPrefix);
+	if (iErr || count != prefixSize)
+		goto bail;
+
+	long handleSize = header.payloadSize - prefixSize;
+
+	payload = NewHandle(handleSize);
+	GAME_ASSERT(payload);
+
+	count = handleSize;
+	iErr = FSRead(refNum, &count, *payload);
+	FSClose(refNum);
+	Jobs_UnlockFiles();
+
+	uint64_t hash = HashBytes(FNV1A_64_OFFSET_BASIS, outPrefix, prefixSize);
+	hash = HashBytes(hash, *payload, count);
+
+	if (iErr
+		|| count != handleSize
+		|| header.payloadHash != hash)
+	{
+		DisposeHandle(payload);
+		return nil;
+	}
+
+	return payload;
+
+bail:
+	FSClose(refNum);
+	Jobs_UnlockFiles();
+	return nil;
+}
+
+
+/******************** SAVE CACHE FILE **********************/
+
+void Cache_Save(const char* name, uint32_t payloadVersion, const uint64_t* sourceHashes, int numSourceHashes, const void* payload, long payloadSize)
+{
+OSErr			iErr;
+FSSpec			spec;
+short			refNum;
+long			count;
+CacheFileHeader	header;
+
+	GAME_ASSERT(numSourceHashes <= CACHE_MAX_SOURCE_HASHES);
+
+	for (int i = 0; i < numSourceHashes; i++)						// don't save a cache we could never validate
+	{
+		if (sourceHashes[i] == 0)
+			return;
+	}
+
+	SDL_memset(&header, 0, sizeof(header));
+	SDL_memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+	header.byteOrderMark	= CACHE_BYTE_ORDER_MARK;
+	header.formatVersion	= CACHE_FORMAT_VERSION;
+	header.payloadVersion	= payloadVersion;
+	header.numSourceHashes	= numSourceHashes;
+	SDL_memcpy(header.sourceHashes, sourceHashes, numSourceHashes * sizeof(uint64_t));
+	header.payloadSize		= payloadSize;
+	header.payloadHash		= HashBytes(FNV1A_64_OFFSET_BASIS, payload, payloadSize);
+
+				/* CREATE FILE */
+
+	Jobs_LockFiles();
+
+	MakeCacheFSSpec(name, true, &spec);
+	FSpDelete(&spec);												// delete any stale file
+	iErr = FSpCreate(&spec, 'BalZ', 'Cach', smSystemScript);
+	if (iErr)
+		goto bail;
+
+	iErr = FSpOpenDF(&spec, fsRdWrPerm, &refNum);
+	if (iErr)
+	{
+		FSpDelete(&spec);
+		goto bail;
+	}
+
+				/* WRITE HEADER & PAYLOAD */
+
+	count = sizeof(header);
+	iErr = FSWrite(refNum, &count, (Ptr) &header);
+
+	if (!iErr)
+	{
+		count = payloadSize;
+		iErr = FSWrite(refNum, &count, (Ptr) payload);
+	}
+
+	FSClose(refNum);
+
+	if (iErr)														// don't leave a truncated file around
+		FSpDelete(&spec);
+
+bail:
+	Jobs_UnlockFiles();
+}
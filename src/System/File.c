@@ -18,7 +18,12 @@
 /****************************/
 
 static void ReadDataFromSkeletonFile(SkeletonDefType *skeleton, const FSSpec* fsSpec3DMF);
+static Boolean LoadSkeletonCache(SkeletonDefType *skeleton, const char* modelName, const FSSpec* fsSpec3DMF, const uint64_t* sourceHashes);
+static void SaveSkeletonCache(const SkeletonDefType *skeleton, const char* modelName, const uint64_t* sourceHashes);
 static void ReadDataFromPlayfieldFile(void);
+static void QueueLevelArt(void);
+static void QueuePlayfieldLoad(const FSSpec *spec);
+static void LoadPlayfield_Work(void* userData);
 
 
 /****************************/
@@ -31,6 +36,9 @@ static void ReadDataFromPlayfieldFile(void);
 
 #define	SKELETON_FILE_VERS_NUM	0x0110			// v1.1
 
+#define	SKELETON_CACHE_VERSION	1				// bump when the skeleton cache payload or the decomposition changes
+#define	NUM_SKELETON_SOURCE_HASHES	2			// skeleton rez fork, 3DMF
+
 #define	SAVE_GAME_VERSION	0x00000120			// Bugdom v1.2
 
 #define PREFS_HEADER_LENGTH 16
@@ -39,7 +47,7 @@ static void ReadDataFromPlayfieldFile(void);
 
 // Bump this every time prefs struct changes
 // Note: this will reset user prefs!
-const char PREFS_HEADER_STRING[PREFS_HEADER_LENGTH+1] = "NewBugdomPrefs06";
+const char PREFS_HEADER_STRING[PREFS_HEADER_LENGTH+1] = "NewBugdomPrefs07";
 
 
 		/* PLAYFIELD HEADER */
@@ -76,6 +84,38 @@ typedef struct
 } File_FenceDefType;
 
 
+		/* SKELETON CACHE PAYLOAD */
+		//
+		// Position-independent: each block is located by its byte offset from the start of the payload.
+		// Variable-length lists are stored back to back in bone/anim order.
+		//
+
+typedef struct
+{
+	int32_t		numBones;
+	int32_t		numAnims;
+	int32_t		numDecomposedTriMeshes;
+	int32_t		numDecomposedPoints;
+	int32_t		numDecomposedNormals;
+	uint32_t	bonesOffset;						// SkeletonCacheBone[numBones]
+	uint32_t	boneIndicesOffset;					// u_short: each bone's point indices, then its normal indices
+	uint32_t	numAnimEventsOffset;				// Byte[numAnims]
+	uint32_t	animEventsOffset;					// AnimEventType: each anim's events
+	uint32_t	numKeyFramesOffset;					// signed char[numBones][numAnims]
+	uint32_t	keyFramesOffset;					// JointKeyframeType: each joint's keyframes for each anim
+	uint32_t	decomposedPointsOffset;				// DecomposedPointType[numDecomposedPoints]
+	uint32_t	decomposedNormalsOffset;			// TQ3Vector3D[numDecomposedNormals]
+}SkeletonCacheHeader;
+
+typedef struct
+{
+	int32_t		parentBone;
+	TQ3Point3D	coord;
+	uint16_t	numPointsAttachedToBone;
+	uint16_t	numNormalsAttachedToBone;
+}SkeletonCacheBone;
+
+
 /**********************/
 /*     VARIABLES      */
 /**********************/
@@ -84,6 +124,9 @@ float	g3DTileSize, g3DMinY, g3DMaxY;
 
 int		gCurrentSaveSlot = -1;
 
+static FSSpec	gPendingPlayfieldSpec;					// file for QueuePlayfieldLoad
+static Boolean	gPreloadingLevelArt = false;			// true from StartPreloadingLevelArt until LoadLevelArt
+
 /******************* LOAD SKELETON *******************/
 //
 // Loads a skeleton file & creates storage for it.
@@ -91,6 +134,9 @@ int		gCurrentSaveSlot = -1;
 // NOTE: Skeleton types 0..NUM_CHARACTERS-1 are reserved for player character skeletons.
 //		Skeleton types NUM_CHARACTERS and over are for other skeleton entities.
 //
+// Doesn't touch OpenGL, so it may run on a worker thread. The skeleton's textures
+// are uploaded when it's registered by LoadASkeleton.
+//
 // OUTPUT:	Ptr to skeleton data
 //
 
@@ -137,38 +183,62 @@ char		pathBuf[128];
 
 
 
+	Jobs_LockFiles();
+
 	SDL_snprintf(pathBuf, sizeof(pathBuf), ":Skeletons:%s.skeleton", modelName);
 	FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, pathBuf, &fsSpecSkeleton);
 
 	SDL_snprintf(pathBuf, sizeof(pathBuf), ":Skeletons:%s.3dmf", modelName);
 	FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, pathBuf, &fsSpec3DMF);
 
+	Jobs_UnlockFiles();
 
 
-			/* OPEN THE FILE'S REZ FORK */
-
-	fRefNum = FSpOpenResFile(&fsSpecSkeleton, fsRdPerm);
-	GAME_ASSERT(fRefNum != -1);
-
-	UseResFile(fRefNum);
-	GAME_ASSERT(noErr == ResError());
-
-			
 			/* ALLOC MEMORY FOR SKELETON INFO STRUCTURE */
 			
 	skeleton = (SkeletonDefType *)AllocPtr(sizeof(SkeletonDefType));
 	GAME_ASSERT(skeleton);
 
 
-			/* READ SKELETON RESOURCES */
-			
-	ReadDataFromSkeletonFile(skeleton, &fsSpec3DMF);
-	PrimeBoneData(skeleton);
-	
-			/* CLOSE REZ FILE */
-			
-	CloseResFile(fRefNum);
+			/* TRY THE PRECOMPILED CACHE FIRST */
+
+	const uint64_t sourceHashes[NUM_SKELETON_SOURCE_HASHES] =
+	{
+		Cache_HashFile(&fsSpecSkeleton, true),
+		Cache_HashFile(&fsSpec3DMF, false),
+	};
+
+	if (!LoadSkeletonCache(skeleton, modelName, &fsSpec3DMF, sourceHashes))
+	{
+				/* OPEN THE FILE'S REZ FORK */
+				//
+				// The resource manager has a single current rez file, so hold the lock until we're done with it.
+				//
+
+		Jobs_LockFiles();
+
+		fRefNum = FSpOpenResFile(&fsSpecSkeleton, fsRdPerm);
+		GAME_ASSERT(fRefNum != -1);
+
+		UseResFile(fRefNum);
+		GAME_ASSERT(noErr == ResError());
+
+				/* READ SKELETON RESOURCES */
+
+		ReadDataFromSkeletonFile(skeleton, &fsSpec3DMF);
 
+				/* CLOSE REZ FILE */
+
+		CloseResFile(fRefNum);
+
+		Jobs_UnlockFiles();
+
+				/* SAVE CACHE FOR NEXT TIME */
+
+		SaveSkeletonCache(skeleton, modelName, sourceHashes);
+	}
+
+	PrimeBoneData(skeleton);
 
 	return(skeleton);
 }
@@ -227,7 +297,7 @@ SkeletonFile_AnimHeader_Type	*animHeaderPtr;
 #if 1
 	// Source port change: original game used to resolve path to 3DMF via alias resource within skeleton rez fork.
 	// Instead, we're forcing the 3DMF's filename (sans extension) to match the skeleton's.
-	LoadBonesReferenceModel(fsSpec3DMF, skeleton);
+	LoadBonesReferenceModel(fsSpec3DMF, skeleton, true);
 #else
 	AliasHandle				alias;
 	FSSpec					target;
@@ -236,7 +306,7 @@ SkeletonFile_AnimHeader_Type	*animHeaderPtr;
 	{
 		iErr = ResolveAlias(fsSpec, alias, &target, &wasChanged);	// try to resolve alias
 		GAME_ASSERT_MESSAGE(noErr == iErr, "Cannot find Skeleton's 3DMF file!");
-		LoadBonesReferenceModel(&target,skeleton);
+		LoadBonesReferenceModel(&target,skeleton,true);
 		ReleaseResource((Handle)alias);
 	}
 #endif
@@ -401,6 +471,299 @@ SkeletonFile_AnimHeader_Type	*animHeaderPtr;
 	
 }
 
+#pragma mark -
+
+/************* RESERVE SKELETON CACHE BLOCK *******************/
+//
+// Returns the offset of a new block at the end of the payload (8-byte aligned).
+//
+
+static uint32_t ReserveSkeletonCacheBlock(uint32_t* payloadSize, size_t blockSize)
+{
+	uint32_t offset = (*payloadSize + 7) & ~7u;
+	*payloadSize = offset + (uint32_t) blockSize;
+	return offset;
+}
+
+
+/************* SKELETON CACHE BLOCK FITS *******************/
+
+static Boolean SkeletonCacheBlockFits(uint32_t offset, long count, size_t elementSize, long payloadSize)
+{
+	return count >= 0
+		&& offset >= sizeof(SkeletonCacheHeader)
+		&& (offset & 7) == 0
+		&& (uint64_t) offset + (uint64_t) count * elementSize <= (uint64_t) payloadSize;
+}
+
+
+/************* SAVE SKELETON CACHE *******************/
+//
+// Flattens a freshly-loaded skeleton so that LoadSkeletonCache can restore it
+// without touching the rez fork or decomposing the reference model.
+//
+
+static void SaveSkeletonCache(const SkeletonDefType *skeleton, const char* modelName, const uint64_t* sourceHashes)
+{
+SkeletonCacheHeader	header;
+long				numBones = skeleton->NumBones;
+long				numAnims = skeleton->NumAnims;
+long				numBoneIndices = 0;
+long				numAnimEvents = 0;
+long				numKeyFrames = 0;
+uint32_t			payloadSize = sizeof(SkeletonCacheHeader);
+char				cacheName[64];
+
+	for (int j = 0; j < numBones; j++)
+	{
+		numBoneIndices += skeleton->Bones[j].numPointsAttachedToBone;
+		numBoneIndices += skeleton->Bones[j].numNormalsAttachedToBone;
+
+		for (int i = 0; i < numAnims; i++)
+			numKeyFrames += skeleton->JointKeyframes[j].numKeyFrames[i];
+	}
+
+	for (int i = 0; i < numAnims; i++)
+		numAnimEvents += skeleton->NumAnimEvents[i];
+
+			/* LAY OUT THE PAYLOAD */
+
+	SDL_memset(&header, 0, sizeof(header));
+	header.numBones					= numBones;
+	header.numAnims					= numAnims;
+	header.numDecomposedTriMeshes	= skeleton->numDecomposedTriMeshes;
+	header.numDecomposedPoints		= skeleton->numDecomposedPoints;
+	header.numDecomposedNormals		= skeleton->numDecomposedNormals;
+	header.bonesOffset				= ReserveSkeletonCacheBlock(&payloadSize, numBones * sizeof(SkeletonCacheBone));
+	header.boneIndicesOffset		= ReserveSkeletonCacheBlock(&payloadSize, numBoneIndices * sizeof(u_short));
+	header.numAnimEventsOffset		= ReserveSkeletonCacheBlock(&payloadSize, numAnims * sizeof(Byte));
+	header.animEventsOffset			= ReserveSkeletonCacheBlock(&payloadSize, numAnimEvents * sizeof(AnimEventType));
+	header.numKeyFramesOffset		= ReserveSkeletonCacheBlock(&payloadSize, numBones * numAnims * sizeof(signed char));
+	header.keyFramesOffset			= ReserveSkeletonCacheBlock(&payloadSize, numKeyFrames * sizeof(JointKeyframeType));
+	header.decomposedPointsOffset	= ReserveSkeletonCacheBlock(&payloadSize, skeleton->numDecomposedPoints * sizeof(DecomposedPointType));
+	header.decomposedNormalsOffset	= ReserveSkeletonCacheBlock(&payloadSize, skeleton->numDecomposedNormals * sizeof(TQ3Vector3D));
+
+	Ptr payload = NewPtrClear(payloadSize);
+	GAME_ASSERT(payload);
+
+	SDL_memcpy(payload, &header, sizeof(header));
+
+			/* BONES */
+
+	SkeletonCacheBone* cacheBone = (SkeletonCacheBone*) (payload + header.bonesOffset);
+	u_short* indexPtr = (u_short*) (payload + header.boneIndicesOffset);
+
+	for (int j = 0; j < numBones; j++)
+	{
+		const BoneDefinitionType* bone = &skeleton->Bones[j];
+
+		cacheBone[j].parentBone					= bone->parentBone;
+		cacheBone[j].coord						= bone->coord;
+		cacheBone[j].numPointsAttachedToBone	= bone->numPointsAttachedToBone;
+		cacheBone[j].numNormalsAttachedToBone	= bone->numNormalsAttachedToBone;
+
+		SDL_memcpy(indexPtr, bone->pointList, bone->numPointsAttachedToBone * sizeof(u_short));
+		indexPtr += bone->numPointsAttachedToBone;
+
+		SDL_memcpy(indexPtr, bone->normalList, bone->numNormalsAttachedToBone * sizeof(u_short));
+		indexPtr += bone->numNormalsAttachedToBone;
+	}
+
+			/* ANIM EVENTS */
+
+	SDL_memcpy(payload + header.numAnimEventsOffset, skeleton->NumAnimEvents, numAnims * sizeof(Byte));
+
+	AnimEventType* animEventPtr = (AnimEventType*) (payload + header.animEventsOffset);
+	for (int i = 0; i < numAnims; i++)
+	{
+		SDL_memcpy(animEventPtr, skeleton->AnimEventsList[i], skeleton->NumAnimEvents[i] * sizeof(AnimEventType));
+		animEventPtr += skeleton->NumAnimEvents[i];
+	}
+
+			/* KEYFRAMES */
+
+	signed char* numKeyFramesPtr = (signed char*) (payload + header.numKeyFramesOffset);
+	JointKeyframeType* keyFramePtr = (JointKeyframeType*) (payload + header.keyFramesOffset);
+
+	for (int j = 0; j < numBones; j++)
+	{
+		for (int i = 0; i < numAnims; i++)
+		{
+			int n = skeleton->JointKeyframes[j].numKeyFrames[i];
+			*numKeyFramesPtr++ = n;
+			SDL_memcpy(keyFramePtr, skeleton->JointKeyframes[j].keyFrames[i], n * sizeof(JointKeyframeType));
+			keyFramePtr += n;
+		}
+	}
+
+			/* DECOMPOSED POINTS & NORMALS */
+
+	SDL_memcpy(payload + header.decomposedPointsOffset, skeleton->decomposedPointList, skeleton->numDecomposedPoints * sizeof(DecomposedPointType));
+	SDL_memcpy(payload + header.decomposedNormalsOffset, skeleton->decomposedNormalsList, skeleton->numDecomposedNormals * sizeof(TQ3Vector3D));
+
+			/* WRITE IT OUT */
+
+	SDL_snprintf(cacheName, sizeof(cacheName), "Skeleton-%s", modelName);
+	Cache_Save(cacheName, SKELETON_CACHE_VERSION, sourceHashes, NUM_SKELETON_SOURCE_HASHES, payload, payloadSize);
+
+	DisposePtr(payload);
+}
+
+
+/************* LOAD SKELETON CACHE *******************/
+//
+// Restores a skeleton from its cache file, if it's up to date with the rez fork & 3DMF.
+// The reference model still gets loaded (its trimeshes & textures are needed to draw the skeleton),
+// but it isn't decomposed again.
+//
+// OUTPUT:	true if the skeleton was restored from the cache.
+//
+
+static Boolean LoadSkeletonCache(SkeletonDefType *skeleton, const char* modelName, const FSSpec* fsSpec3DMF, const uint64_t* sourceHashes)
+{
+char			cacheName[64];
+long			payloadSize = 0;
+long			numBones, numAnims;
+long			numBoneIndices = 0;
+long			numAnimEvents = 0;
+long			numKeyFrames = 0;
+
+	SDL_snprintf(cacheName, sizeof(cacheName), "Skeleton-%s", modelName);
+
+	Ptr payload = Cache_Load(cacheName, SKELETON_CACHE_VERSION, sourceHashes, NUM_SKELETON_SOURCE_HASHES, &payloadSize);
+	if (!payload)
+		return false;
+
+			/* VALIDATE THE LAYOUT BEFORE TOUCHING THE SKELETON */
+
+	const SkeletonCacheHeader* header = (const SkeletonCacheHeader*) payload;
+
+	if (payloadSize < (long) sizeof(SkeletonCacheHeader))
+		goto stale;
+
+	numBones = header->numBones;
+	numAnims = header->numAnims;
+
+	if (numBones <= 0 || numBones > MAX_JOINTS
+		|| numAnims < 0 || numAnims > MAX_ANIMS
+		|| header->numDecomposedPoints < 0 || header->numDecomposedPoints > MAX_DECOMPOSED_POINTS
+		|| header->numDecomposedNormals < 0 || header->numDecomposedNormals > MAX_DECOMPOSED_NORMALS
+		|| !SkeletonCacheBlockFits(header->bonesOffset, numBones, sizeof(SkeletonCacheBone), payloadSize)
+		|| !SkeletonCacheBlockFits(header->numAnimEventsOffset, numAnims, sizeof(Byte), payloadSize)
+		|| !SkeletonCacheBlockFits(header->numKeyFramesOffset, numBones * numAnims, sizeof(signed char), payloadSize)
+		|| !SkeletonCacheBlockFits(header->decomposedPointsOffset, header->numDecomposedPoints, sizeof(DecomposedPointType), payloadSize)
+		|| !SkeletonCacheBlockFits(header->decomposedNormalsOffset, header->numDecomposedNormals, sizeof(TQ3Vector3D), payloadSize))
+	{
+		goto stale;
+	}
+
+	const SkeletonCacheBone* cacheBone = (const SkeletonCacheBone*) (payload + header->bonesOffset);
+	const Byte* numAnimEventsPtr = (const Byte*) (payload + header->numAnimEventsOffset);
+	const signed char* numKeyFramesPtr = (const signed char*) (payload + header->numKeyFramesOffset);
+
+	for (int j = 0; j < numBones; j++)
+	{
+		numBoneIndices += cacheBone[j].numPointsAttachedToBone;
+		numBoneIndices += cacheBone[j].numNormalsAttachedToBone;
+	}
+
+	for (int i = 0; i < numAnims; i++)
+	{
+		if (numAnimEventsPtr[i] > MAX_ANIM_EVENTS)
+			goto stale;
+		numAnimEvents += numAnimEventsPtr[i];
+	}
+
+	for (int k = 0; k < numBones * numAnims; k++)
+	{
+		if (numKeyFramesPtr[k] < 0 || numKeyFramesPtr[k] > MAX_KEYFRAMES)
+			goto stale;
+		numKeyFrames += numKeyFramesPtr[k];
+	}
+
+	if (!SkeletonCacheBlockFits(header->boneIndicesOffset, numBoneIndices, sizeof(u_short), payloadSize)
+		|| !SkeletonCacheBlockFits(header->animEventsOffset, numAnimEvents, sizeof(AnimEventType), payloadSize)
+		|| !SkeletonCacheBlockFits(header->keyFramesOffset, numKeyFrames, sizeof(JointKeyframeType), payloadSize))
+	{
+		goto stale;
+	}
+
+			/* ALLOC MEMORY & LOAD THE REFERENCE MODEL WITHOUT DECOMPOSING IT */
+
+	skeleton->NumBones = numBones;
+	skeleton->NumAnims = numAnims;
+	AllocSkeletonDefinitionMemory(skeleton);
+
+	LoadBonesReferenceModel(fsSpec3DMF, skeleton, false);
+	GAME_ASSERT(skeleton->numDecomposedTriMeshes == header->numDecomposedTriMeshes);	// 3DMF hash matched, so this can't change
+
+	skeleton->numDecomposedPoints = header->numDecomposedPoints;
+	skeleton->numDecomposedNormals = header->numDecomposedNormals;
+	SDL_memcpy(skeleton->decomposedPointList, payload + header->decomposedPointsOffset, skeleton->numDecomposedPoints * sizeof(DecomposedPointType));
+	SDL_memcpy(skeleton->decomposedNormalsList, payload + header->decomposedNormalsOffset, skeleton->numDecomposedNormals * sizeof(TQ3Vector3D));
+
+			/* BONES */
+
+	const u_short* indexPtr = (const u_short*) (payload + header->boneIndicesOffset);
+
+	for (int j = 0; j < numBones; j++)
+	{
+		BoneDefinitionType* bone = &skeleton->Bones[j];
+
+		bone->parentBone				= cacheBone[j].parentBone;
+		bone->coord						= cacheBone[j].coord;
+		bone->numPointsAttachedToBone	= cacheBone[j].numPointsAttachedToBone;
+		bone->numNormalsAttachedToBone	= cacheBone[j].numNormalsAttachedToBone;
+
+		bone->pointList = (u_short *)AllocPtr(sizeof(u_short) * (int)bone->numPointsAttachedToBone);
+		GAME_ASSERT(bone->pointList);
+		SDL_memcpy(bone->pointList, indexPtr, bone->numPointsAttachedToBone * sizeof(u_short));
+		indexPtr += bone->numPointsAttachedToBone;
+
+		bone->normalList = (u_short *)AllocPtr(sizeof(u_short) * (int)bone->numNormalsAttachedToBone);
+		GAME_ASSERT(bone->normalList);
+		SDL_memcpy(bone->normalList, indexPtr, bone->numNormalsAttachedToBone * sizeof(u_short));
+		indexPtr += bone->numNormalsAttachedToBone;
+	}
+
+			/* ANIM EVENTS */
+
+	const AnimEventType* animEventPtr = (const AnimEventType*) (payload + header->animEventsOffset);
+
+	for (int i = 0; i < numAnims; i++)
+	{
+		skeleton->NumAnimEvents[i] = numAnimEventsPtr[i];
+		SDL_memcpy(skeleton->AnimEventsList[i], animEventPtr, numAnimEventsPtr[i] * sizeof(AnimEventType));
+		animEventPtr += numAnimEventsPtr[i];
+	}
+
+			/* KEYFRAMES */
+
+	const JointKeyframeType* keyFramePtr = (const JointKeyframeType*) (payload + header->keyFramesOffset);
+
+	for (int j = 0; j < numBones; j++)
+	{
+		Alloc_2d_array(JointKeyframeType, skeleton->JointKeyframes[j].keyFrames, numAnims, MAX_KEYFRAMES);
+		GAME_ASSERT((skeleton->JointKeyframes[j].keyFrames) && (skeleton->JointKeyframes[j].keyFrames[0]));
+
+		for (int i = 0; i < numAnims; i++)
+		{
+			int n = *numKeyFramesPtr++;
+			skeleton->JointKeyframes[j].numKeyFrames[i] = n;
+			SDL_memcpy(skeleton->JointKeyframes[j].keyFrames[i], keyFramePtr, n * sizeof(JointKeyframeType));
+			keyFramePtr += n;
+		}
+	}
+
+	DisposePtr(payload);
+	return true;
+
+stale:
+	DisposePtr(payload);
+	return false;
+}
+
+
 #pragma mark -
 
 /**************** OPEN GAME FILE **********************/
@@ -520,6 +883,12 @@ PrefsType	prefBuffer;
 		prefBlock->mouseSensitivityLevel = DEFAULT_MOUSE_SENSITIVITY_LEVEL;
 	}
 
+	if (prefBuffer.viewDistance >= NUM_VIEW_DISTANCES)
+	{
+		DoAlert("Illegal view distance in prefs!");
+		prefBuffer.viewDistance = VIEW_DISTANCE_NORMAL;
+	}
+
 				/* PREFS ARE OK */
 
 	*prefBlock = prefBuffer;
@@ -750,6 +1119,7 @@ short	fRefNum;
 			
 				/* OPEN THE REZ-FORK */
 			
+	Jobs_LockFiles();
 	fRefNum = FSpOpenResFile(specPtr,fsRdPerm);
 	GAME_ASSERT(fRefNum != -1);
 	UseResFile(fRefNum);
@@ -763,6 +1133,7 @@ short	fRefNum;
 			/* CLOSE REZ FILE */
 			
 	CloseResFile(fRefNum);
+	Jobs_UnlockFiles();
 
 
 				/***********************/
@@ -1151,23 +1522,82 @@ short					**xlateTableHand,*xlateTbl;
 #pragma mark -
 
 /************************** LOAD LEVEL ART ***************************/
+//
+// Loads all of the level's assets. If StartPreloadingLevelArt was called (during the level intro),
+// this just waits for whatever is left of the preload.
+//
 
 void LoadLevelArt(void)
+{
+	if (!gPreloadingLevelArt)
+	{
+		QueueLevelArt();
+		Jobs_Start();
+	}
+
+	Jobs_WaitAll();
+	gPreloadingLevelArt = false;
+
+	Render_FlushAllTextureUploads();						// don't let the level's textures trickle into the first frames of gameplay
+
+			/* CAST SHADOWS NOW THAT THE PLAYFIELD IS IN */
+			//
+			// This needs the game view's lights, so it can't be part of the preload.
+			//
+
+	DoItemShadowCasting();
+}
+
+
+/************************** START PRELOADING LEVEL ART ***************************/
+//
+// Starts loading the level's assets in the background while a screen is shown before the level.
+// The files are parsed on worker threads; the screen's frame loop must call Jobs_Pump
+// so that the textures get uploaded bit by bit.
+//
+// The screen must not free any of the level's assets when it's done (see IsPreloadingLevelArt).
+//
+
+void StartPreloadingLevelArt(void)
+{
+	GAME_ASSERT(!gPreloadingLevelArt);
+
+	QueueLevelArt();
+	Jobs_Start();
+
+	gPreloadingLevelArt = true;
+}
+
+
+/************************** IS PRELOADING LEVEL ART ***************************/
+
+Boolean IsPreloadingLevelArt(void)
+{
+	return gPreloadingLevelArt;
+}
+
+
+/************************** QUEUE LEVEL ART ***************************/
+//
+// Queues up all of the level's assets as jobs.
+//
+
+static void QueueLevelArt(void)
 {
 FSSpec	spec;
 
 			/* LOAD GLOBAL STUFF */
 
 	FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:Global_Models1.3dmf", &spec);
-	LoadGrouped3DMF(&spec,MODEL_GROUP_GLOBAL1);	
+	QueueGrouped3DMFLoad(&spec,MODEL_GROUP_GLOBAL1);	
 	FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:Global_Models2.3dmf", &spec);
-	LoadGrouped3DMF(&spec,MODEL_GROUP_GLOBAL2);	
+	QueueGrouped3DMFLoad(&spec,MODEL_GROUP_GLOBAL2);	
 
-	LoadSoundBank(SOUNDBANK_MAIN);
+	QueueSoundBankLoad(SOUNDBANK_MAIN);
 
-	LoadASkeleton(SKELETON_TYPE_ME);			
-	LoadASkeleton(SKELETON_TYPE_LADYBUG);			
-	LoadASkeleton(SKELETON_TYPE_BUDDY);			
+	QueueSkeletonLoad(SKELETON_TYPE_ME);			
+	QueueSkeletonLoad(SKELETON_TYPE_LADYBUG);			
+	QueueSkeletonLoad(SKELETON_TYPE_BUDDY);			
 	
 			/*****************************/
 			/* LOAD LEVEL SPECIFIC STUFF */
@@ -1185,25 +1615,25 @@ FSSpec	spec;
 				else
 					FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Terrain:Lawn.ter", &spec);
 				
-				LoadPlayfield(&spec);
+				QueuePlayfieldLoad(&spec);
 
 				/* LOAD MODELS */
 						
 				FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:Lawn_Models1.3dmf", &spec);
-				LoadGrouped3DMF(&spec,MODEL_GROUP_LEVELSPECIFIC);	
+				QueueGrouped3DMFLoad(&spec,MODEL_GROUP_LEVELSPECIFIC);	
 				FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:Lawn_Models2.3dmf", &spec);
-				LoadGrouped3DMF(&spec,MODEL_GROUP_LEVELSPECIFIC2);	
+				QueueGrouped3DMFLoad(&spec,MODEL_GROUP_LEVELSPECIFIC2);	
 				
 				
 				/* LOAD SKELETON FILES */
 				
-				LoadASkeleton(SKELETON_TYPE_BOXERFLY);			
-				LoadASkeleton(SKELETON_TYPE_SLUG);			
-				LoadASkeleton(SKELETON_TYPE_ANT);			
+				QueueSkeletonLoad(SKELETON_TYPE_BOXERFLY);			
+				QueueSkeletonLoad(SKELETON_TYPE_SLUG);			
+				QueueSkeletonLoad(SKELETON_TYPE_ANT);			
 
 				/* LOAD SOUNDS */
 
-				LoadSoundBank(SOUNDBANK_LAWN);
+				QueueSoundBankLoad(SOUNDBANK_LAWN);
 				break;
 
 
@@ -1213,26 +1643,26 @@ FSSpec	spec;
 				
 		case	LEVEL_TYPE_POND:
 				FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Terrain:Pond.ter", &spec);
-				LoadPlayfield(&spec);
+				QueuePlayfieldLoad(&spec);
 
 				/* LOAD MODELS */
 						
 				FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:Pond_Models.3dmf", &spec);
-				LoadGrouped3DMF(&spec,MODEL_GROUP_LEVELSPECIFIC);	
+				QueueGrouped3DMFLoad(&spec,MODEL_GROUP_LEVELSPECIFIC);	
 				
 				
 				/* LOAD SKELETON FILES */
 				
-				LoadASkeleton(SKELETON_TYPE_MOSQUITO);			
-				LoadASkeleton(SKELETON_TYPE_WATERBUG);			
-				LoadASkeleton(SKELETON_TYPE_PONDFISH);			
-				LoadASkeleton(SKELETON_TYPE_SKIPPY);			
-				LoadASkeleton(SKELETON_TYPE_SLUG);			
+				QueueSkeletonLoad(SKELETON_TYPE_MOSQUITO);			
+				QueueSkeletonLoad(SKELETON_TYPE_WATERBUG);			
+				QueueSkeletonLoad(SKELETON_TYPE_PONDFISH);			
+				QueueSkeletonLoad(SKELETON_TYPE_SKIPPY);			
+				QueueSkeletonLoad(SKELETON_TYPE_SLUG);			
 
 
 				/* LOAD SOUNDS */
 
-				LoadSoundBank(SOUNDBANK_POND);
+				QueueSoundBankLoad(SOUNDBANK_POND);
 				break;
 
 
@@ -1245,27 +1675,27 @@ FSSpec	spec;
 					FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Terrain:Beach.ter", &spec);
 				else
 					FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Terrain:Flight.ter", &spec);
-				LoadPlayfield(&spec);
+				QueuePlayfieldLoad(&spec);
 
 				/* LOAD MODELS */
 						
 				FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:Forest_Models.3dmf", &spec);
-				LoadGrouped3DMF(&spec,MODEL_GROUP_LEVELSPECIFIC);	
+				QueueGrouped3DMFLoad(&spec,MODEL_GROUP_LEVELSPECIFIC);	
 				
 				
 				/* LOAD SKELETON FILES */
 				
-				LoadASkeleton(SKELETON_TYPE_DRAGONFLY);			
-				LoadASkeleton(SKELETON_TYPE_FOOT);	
-				LoadASkeleton(SKELETON_TYPE_SPIDER);	
-				LoadASkeleton(SKELETON_TYPE_CATERPILLER);	
-				LoadASkeleton(SKELETON_TYPE_BAT);	
-				LoadASkeleton(SKELETON_TYPE_FLYINGBEE);			
-				LoadASkeleton(SKELETON_TYPE_ANT);			
+				QueueSkeletonLoad(SKELETON_TYPE_DRAGONFLY);			
+				QueueSkeletonLoad(SKELETON_TYPE_FOOT);	
+				QueueSkeletonLoad(SKELETON_TYPE_SPIDER);	
+				QueueSkeletonLoad(SKELETON_TYPE_CATERPILLER);	
+				QueueSkeletonLoad(SKELETON_TYPE_BAT);	
+				QueueSkeletonLoad(SKELETON_TYPE_FLYINGBEE);			
+				QueueSkeletonLoad(SKELETON_TYPE_ANT);			
 				
 				/* LOAD SOUNDS */
 
-				LoadSoundBank(SOUNDBANK_FOREST);
+				QueueSoundBankLoad(SOUNDBANK_FOREST);
 
 				break;
 
@@ -1280,25 +1710,25 @@ FSSpec	spec;
 					FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Terrain:BeeHive.ter", &spec);
 				else
 					FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Terrain:QueenBee.ter", &spec);
-				LoadPlayfield(&spec);
+				QueuePlayfieldLoad(&spec);
 
 				/* LOAD MODELS */
 						
 				FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:BeeHive_Models.3dmf", &spec);
-				LoadGrouped3DMF(&spec,MODEL_GROUP_LEVELSPECIFIC);	
+				QueueGrouped3DMFLoad(&spec,MODEL_GROUP_LEVELSPECIFIC);	
 				
 				
 				/* LOAD SKELETON FILES */
 				
-				LoadASkeleton(SKELETON_TYPE_LARVA);			
-				LoadASkeleton(SKELETON_TYPE_FLYINGBEE);			
-				LoadASkeleton(SKELETON_TYPE_WORKERBEE);			
-				LoadASkeleton(SKELETON_TYPE_QUEENBEE);			
+				QueueSkeletonLoad(SKELETON_TYPE_LARVA);			
+				QueueSkeletonLoad(SKELETON_TYPE_FLYINGBEE);			
+				QueueSkeletonLoad(SKELETON_TYPE_WORKERBEE);			
+				QueueSkeletonLoad(SKELETON_TYPE_QUEENBEE);			
 
 				
 				/* LOAD SOUNDS */
 
-				LoadSoundBank(SOUNDBANK_HIVE);
+				QueueSoundBankLoad(SOUNDBANK_HIVE);
 
 				break;
 
@@ -1309,27 +1739,27 @@ FSSpec	spec;
 				
 		case	LEVEL_TYPE_NIGHT:
 				FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Terrain:Night.ter", &spec);
-				LoadPlayfield(&spec);
+				QueuePlayfieldLoad(&spec);
 
 				/* LOAD MODELS */
 						
 				FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:Night_Models.3dmf", &spec);
-				LoadGrouped3DMF(&spec,MODEL_GROUP_LEVELSPECIFIC);	
+				QueueGrouped3DMFLoad(&spec,MODEL_GROUP_LEVELSPECIFIC);	
 				
 				
 				/* LOAD SKELETON FILES */
 				
-				LoadASkeleton(SKELETON_TYPE_FIREANT);			
-				LoadASkeleton(SKELETON_TYPE_FIREFLY);			
-				LoadASkeleton(SKELETON_TYPE_CATERPILLER);	
-				LoadASkeleton(SKELETON_TYPE_SLUG);	
-				LoadASkeleton(SKELETON_TYPE_ROACH);	
-				LoadASkeleton(SKELETON_TYPE_ANT);	
+				QueueSkeletonLoad(SKELETON_TYPE_FIREANT);			
+				QueueSkeletonLoad(SKELETON_TYPE_FIREFLY);			
+				QueueSkeletonLoad(SKELETON_TYPE_CATERPILLER);	
+				QueueSkeletonLoad(SKELETON_TYPE_SLUG);	
+				QueueSkeletonLoad(SKELETON_TYPE_ROACH);	
+				QueueSkeletonLoad(SKELETON_TYPE_ANT);	
 
 				
 				/* LOAD SOUNDS */
 
-				LoadSoundBank(SOUNDBANK_NIGHT);
+				QueueSoundBankLoad(SOUNDBANK_NIGHT);
 				break;
 
 	
@@ -1342,36 +1772,46 @@ FSSpec	spec;
 					FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Terrain:AntHill.ter", &spec);
 				else
 					FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Terrain:AntKing.ter", &spec);
-				LoadPlayfield(&spec);
+				QueuePlayfieldLoad(&spec);
 
 				/* LOAD MODELS */
 						
 				FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, ":Models:AntHill_Models.3dmf", &spec);
-				LoadGrouped3DMF(&spec,MODEL_GROUP_LEVELSPECIFIC);	
+				QueueGrouped3DMFLoad(&spec,MODEL_GROUP_LEVELSPECIFIC);	
 				
 				
 				/* LOAD SKELETON FILES */
 				
 				if (gRealLevel == LEVEL_NUM_ANTKING)
-					LoadASkeleton(SKELETON_TYPE_KINGANT);			
+					QueueSkeletonLoad(SKELETON_TYPE_KINGANT);			
 					
-				LoadASkeleton(SKELETON_TYPE_SLUG);			
-				LoadASkeleton(SKELETON_TYPE_ANT);			
-				LoadASkeleton(SKELETON_TYPE_FIREANT);			
-				LoadASkeleton(SKELETON_TYPE_ROOTSWING);			
-				LoadASkeleton(SKELETON_TYPE_ROACH);	
+				QueueSkeletonLoad(SKELETON_TYPE_SLUG);			
+				QueueSkeletonLoad(SKELETON_TYPE_ANT);			
+				QueueSkeletonLoad(SKELETON_TYPE_FIREANT);			
+				QueueSkeletonLoad(SKELETON_TYPE_ROOTSWING);			
+				QueueSkeletonLoad(SKELETON_TYPE_ROACH);	
 
 				/* LOAD SOUNDS */
 
-				LoadSoundBank(SOUNDBANK_ANTHILL);
+				QueueSoundBankLoad(SOUNDBANK_ANTHILL);
 				break;
 
 		default:
-				DoFatalAlert("LoadLevelArt: unsupported level #");
+				DoFatalAlert("QueueLevelArt: unsupported level #");
 	}
-	
-	
-			/* CAST SHADOWS */
-			
-	DoItemShadowCasting();
+}
+
+
+/************************** QUEUE PLAYFIELD LOAD ***************************/
+
+static void QueuePlayfieldLoad(const FSSpec *spec)
+{
+	gPendingPlayfieldSpec = *spec;
+	Jobs_Add(LoadPlayfield_Work, NULL, NULL, 0, NULL);
+}
+
+static void LoadPlayfield_Work(void* userData)
+{
+	(void) userData;
+	LoadPlayfield(&gPendingPlayfieldSpec);
 }
@@ -0,0 +1,493 @@
+// JOBS.C
+// This file is part of Bugdom. https://github.com/jorio/bugdom
+
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+#include <setjmp.h>
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	MAX_JOBS			128
+#define	MAX_JOB_WORKERS		8
+#define	MAX_JOB_ALERT_LEN	256
+
+enum
+{
+	JOB_QUEUED,
+	JOB_WORKING,				// work proc running on a worker thread
+	JOB_WORKED,					// waiting for the main thread to run the finish proc
+	JOB_FINISHING,				// finish proc running on the main thread
+	JOB_FINISHED
+};
+
+
+/****************************/
+/*    TYPES                 */
+/****************************/
+
+struct Job
+{
+	JobProc		workProc;
+	JobProc		finishProc;
+	void*		userData;
+	int			numDependencies;
+	Job*		dependencies[MAX_JOB_DEPENDENCIES];
+	int			state;
+	bool		hasAlert;								// alert raised by the work proc, shown on the main thread
+	bool		alertIsFatal;
+	char		alertMessage[MAX_JOB_ALERT_LEN];
+};
+
+typedef struct JobWorker
+{
+	SDL_Thread*	thread;
+	Job*		job;									// job whose work proc is running on this worker
+	int			filesLockDepth;							// how many times this worker holds gFilesMutex
+	jmp_buf		abortWork;								// where a fatal alert in the work proc jumps to
+} JobWorker;
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static Job* FindReadyJob(void);
+static int JobWorkerThread(void* workerPtr);
+static void ShowJobAlert(Job* job);
+static void RunAllJobsOnMainThread(void);
+static void RunFinishProcs(bool waitForAll, float timeBudgetMS);
+static void RetireJobWorkers(void);
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+static Job				gJobs[MAX_JOBS];
+static int				gNumJobs = 0;
+static int				gNumFinishedJobs = 0;
+static bool				gJobsRunning = false;
+static bool				gQuitJobWorkers = false;
+
+static JobWorker		gJobWorkers[MAX_JOB_WORKERS];
+static int				gNumJobWorkers = 0;
+static SDL_TLSID		gJobWorkerTLS;					// current thread's JobWorker; NULL on the main thread
+
+static SDL_Mutex*		gJobsMutex = NULL;				// guards the job states
+static SDL_Condition*	gJobsWorkCondition = NULL;		// signaled when a job may have become ready
+static SDL_Condition*	gJobsMainCondition = NULL;		// signaled when a job's work proc is done
+
+static SDL_Mutex*		gFilesMutex = NULL;
+
+
+/********************** INIT JOBS ***********************/
+
+void Jobs_Init(void)
+{
+	gJobsMutex = SDL_CreateMutex();
+	gJobsWorkCondition = SDL_CreateCondition();
+	gJobsMainCondition = SDL_CreateCondition();
+	gFilesMutex = SDL_CreateMutex();
+
+	GAME_ASSERT(gJobsMutex && gJobsWorkCondition && gJobsMainCondition && gFilesMutex);
+}
+
+
+/********************** FILE LOCK ***********************/
+
+void Jobs_LockFiles(void)
+{
+	if (gFilesMutex)
+	{
+		SDL_LockMutex(gFilesMutex);
+
+		JobWorker* worker = (JobWorker*) SDL_GetTLS(&gJobWorkerTLS);
+		if (worker)
+			worker->filesLockDepth++;
+	}
+}
+
+void Jobs_UnlockFiles(void)
+{
+	if (gFilesMutex)
+	{
+		JobWorker* worker = (JobWorker*) SDL_GetTLS(&gJobWorkerTLS);
+		if (worker)
+			worker->filesLockDepth--;
+
+		SDL_UnlockMutex(gFilesMutex);
+	}
+}
+
+
+/********************** REPORT ALERT ***********************/
+//
+// SDL video calls (message boxes, fullscreen toggling) must run on the main thread,
+// so alerts raised by a work proc are stored in its job and shown once the main thread gets to it.
+// A fatal alert also abandons the work proc: we release the file lock and jump back to the worker loop.
+//
+
+bool Jobs_ReportAlert(const char* message, bool fatal)
+{
+	JobWorker* worker = (JobWorker*) SDL_GetTLS(&gJobWorkerTLS);
+
+	if (!worker || !worker->job)							// main thread: the caller shows the alert itself
+		return false;
+
+	Job* job = worker->job;
+
+	if (!job->hasAlert || (fatal && !job->alertIsFatal))	// keep the first alert, unless this one is worse
+	{
+		SDL_snprintf(job->alertMessage, sizeof(job->alertMessage), "%s", message);
+		job->alertIsFatal = fatal;
+		job->hasAlert = true;
+	}
+
+	if (fatal)
+	{
+		while (worker->filesLockDepth > 0)
+		{
+			worker->filesLockDepth--;
+			SDL_UnlockMutex(gFilesMutex);
+		}
+
+		longjmp(worker->abortWork, 1);
+	}
+
+	return true;
+}
+
+
+/********************** SHOW JOB ALERT ***********************/
+
+static void ShowJobAlert(Job* job)
+{
+	if (!job->hasAlert)
+		return;
+
+	if (job->alertIsFatal)
+		DoFatalAlert("%s", job->alertMessage);
+	else
+		DoAlert("%s", job->alertMessage);
+
+	job->hasAlert = false;
+}
+
+
+/********************** ADD JOB ***********************/
+
+Job* Jobs_Add(JobProc workProc, JobProc finishProc, void* userData, int numDependencies, Job* const* dependencies)
+{
+	GAME_ASSERT(!gJobsRunning);
+	GAME_ASSERT(gNumJobs < MAX_JOBS);
+	GAME_ASSERT(numDependencies <= MAX_JOB_DEPENDENCIES);
+
+	Job* job = &gJobs[gNumJobs++];
+
+	SDL_memset(job, 0, sizeof(Job));
+	job->workProc		= workProc;
+	job->finishProc		= finishProc;
+	job->userData		= userData;
+	job->state			= JOB_QUEUED;
+
+	for (int i = 0; i < numDependencies; i++)
+	{
+		if (!dependencies[i])									// allow optional dependencies
+			continue;
+
+		GAME_ASSERT(dependencies[i] >= gJobs && dependencies[i] < job);	// jobs can only depend on earlier jobs, so there are no cycles
+		job->dependencies[job->numDependencies++] = dependencies[i];
+	}
+
+	return job;
+}
+
+
+/********************** IS RUNNING ***********************/
+
+bool Jobs_IsRunning(void)
+{
+	return gJobsRunning;
+}
+
+
+/********************** FIND READY JOB ***********************/
+//
+// Returns the first queued job whose dependencies are all finished.
+// The caller must hold gJobsMutex.
+//
+
+static Job* FindReadyJob(void)
+{
+	for (int i = 0; i < gNumJobs; i++)
+	{
+		Job* job = &gJobs[i];
+
+		if (job->state != JOB_QUEUED)
+			continue;
+
+		bool ready = true;
+		for (int d = 0; ready && d < job->numDependencies; d++)
+			ready = job->dependencies[d]->state == JOB_FINISHED;
+
+		if (ready)
+			return job;
+	}
+
+	return NULL;
+}
+
+
+/********************** JOB WORKER THREAD ***********************/
+
+static int JobWorkerThread(void* workerPtr)
+{
+	JobWorker* worker = (JobWorker*) workerPtr;
+
+	SDL_SetTLS(&gJobWorkerTLS, worker, NULL);
+
+	SDL_LockMutex(gJobsMutex);
+
+	while (!gQuitJobWorkers)
+	{
+		Job* job = FindReadyJob();
+		if (!job)
+		{
+			SDL_WaitCondition(gJobsWorkCondition, gJobsMutex);
+			continue;
+		}
+
+		job->state = JOB_WORKING;
+		SDL_UnlockMutex(gJobsMutex);
+
+		worker->job = job;
+		worker->filesLockDepth = 0;
+
+		if (job->workProc)
+		{
+			if (setjmp(worker->abortWork) == 0)				// a fatal alert in the work proc lands back here
+				job->workProc(job->userData);
+		}
+
+		worker->job = NULL;
+
+		SDL_LockMutex(gJobsMutex);
+		job->state = JOB_WORKED;
+		SDL_SignalCondition(gJobsMainCondition);
+	}
+
+	SDL_UnlockMutex(gJobsMutex);
+	return 0;
+}
+
+
+/********************** RUN ALL JOBS ON MAIN THREAD ***********************/
+//
+// Fallback if we can't spawn any workers. Dependencies always precede their dependents,
+// so queue order is a valid order.
+//
+
+static void RunAllJobsOnMainThread(void)
+{
+	for (int i = 0; i < gNumJobs; i++)
+	{
+		Job* job = &gJobs[i];
+
+		if (job->workProc)
+			job->workProc(job->userData);
+		if (job->finishProc)
+			job->finishProc(job->userData);
+
+		job->state = JOB_FINISHED;
+	}
+}
+
+
+/********************** START JOBS ***********************/
+//
+// Spawns the workers and returns right away.
+// The finish procs only run when the main thread calls Jobs_Pump or Jobs_WaitAll.
+//
+
+void Jobs_Start(void)
+{
+	GAME_ASSERT(!gJobsRunning);
+	GAME_ASSERT(gJobsMutex);
+
+	if (gNumJobs == 0)
+		return;
+
+	gJobsRunning = true;
+	gQuitJobWorkers = false;
+	gNumFinishedJobs = 0;
+	gNumJobWorkers = 0;
+
+			/* SPAWN WORKERS */
+
+	int wantWorkers = SDL_clamp(SDL_GetNumLogicalCPUCores() - 1, 1, MAX_JOB_WORKERS);	// leave a core for the main thread's GL uploads
+	wantWorkers = SDL_min(wantWorkers, gNumJobs);
+
+	for (int i = 0; i < wantWorkers; i++)
+	{
+		JobWorker* worker = &gJobWorkers[gNumJobWorkers];
+		SDL_memset(worker, 0, sizeof(JobWorker));
+
+		worker->thread = SDL_CreateThread(JobWorkerThread, "JobWorker", worker);
+		if (worker->thread)
+			gNumJobWorkers++;
+	}
+
+	if (gNumJobWorkers == 0)
+	{
+		RunAllJobsOnMainThread();
+		RetireJobWorkers();
+	}
+}
+
+
+/********************** PUMP JOBS ***********************/
+//
+// Runs the finish procs of the jobs whose work is done, until we're out of time for this frame.
+// Call once per frame while the jobs are running.
+//
+
+void Jobs_Pump(float timeBudgetMS)
+{
+	if (!gJobsRunning)
+		return;
+
+	RunFinishProcs(false, timeBudgetMS);
+}
+
+
+/********************** WAIT FOR ALL JOBS ***********************/
+
+void Jobs_WaitAll(void)
+{
+	if (!gJobsRunning)
+		return;
+
+	RunFinishProcs(true, 0);
+}
+
+
+/********************** CANCEL JOBS ***********************/
+//
+// Drops the jobs that haven't started yet and waits for the ones in progress.
+// The finish procs of the jobs whose work got done still run, so their results
+// belong to the game and the usual teardown code can free them.
+// Call this before tearing down anything the workers may touch.
+//
+
+void Jobs_Cancel(void)
+{
+	if (!gJobsRunning)
+		return;
+
+	SDL_LockMutex(gJobsMutex);
+
+	for (int i = 0; i < gNumJobs; i++)
+	{
+		if (gJobs[i].state == JOB_QUEUED)
+		{
+			gJobs[i].state = JOB_FINISHED;
+			gNumFinishedJobs++;
+		}
+	}
+
+	SDL_UnlockMutex(gJobsMutex);
+
+	RunFinishProcs(true, 0);
+}
+
+
+/********************** RUN ALL JOBS ***********************/
+
+void Jobs_RunAll(void)
+{
+	Jobs_Start();
+	Jobs_WaitAll();
+}
+
+
+/********************** RUN FINISH PROCS ***********************/
+//
+// Runs finish procs as work comes in. If waitForAll is false, returns as soon as
+// there's no finished work left or the time budget is spent.
+// Retires the workers once every job is finished.
+//
+
+static void RunFinishProcs(bool waitForAll, float timeBudgetMS)
+{
+	const Uint64 startTime = SDL_GetPerformanceCounter();
+	const Uint64 timeBudget = (Uint64) (SDL_GetPerformanceFrequency() * (timeBudgetMS / 1000.0f));
+
+	SDL_LockMutex(gJobsMutex);
+
+	while (gNumFinishedJobs < gNumJobs)
+	{
+		if (!waitForAll && SDL_GetPerformanceCounter() - startTime > timeBudget)	// out of time for this frame
+			break;
+
+		Job* job = NULL;
+		for (int i = 0; !job && i < gNumJobs; i++)
+		{
+			if (gJobs[i].state == JOB_WORKED)
+				job = &gJobs[i];
+		}
+
+		if (!job)
+		{
+			if (!waitForAll)
+				break;
+
+			SDL_WaitCondition(gJobsMainCondition, gJobsMutex);
+			continue;
+		}
+
+		job->state = JOB_FINISHING;
+		SDL_UnlockMutex(gJobsMutex);
+
+		ShowJobAlert(job);										// doesn't return if the work proc hit a fatal error
+
+		if (job->finishProc)
+			job->finishProc(job->userData);
+
+		SDL_LockMutex(gJobsMutex);
+		job->state = JOB_FINISHED;
+		gNumFinishedJobs++;
+		SDL_BroadcastCondition(gJobsWorkCondition);				// dependents may be ready now
+	}
+
+	bool allFinished = gNumFinishedJobs == gNumJobs;
+
+	SDL_UnlockMutex(gJobsMutex);
+
+	if (allFinished)
+		RetireJobWorkers();
+}
+
+
+/********************** RETIRE JOB WORKERS ***********************/
+
+static void RetireJobWorkers(void)
+{
+	SDL_LockMutex(gJobsMutex);
+	gQuitJobWorkers = true;
+	SDL_BroadcastCondition(gJobsWorkCondition);
+	SDL_UnlockMutex(gJobsMutex);
+
+	for (int i = 0; i < gNumJobWorkers; i++)
+		SDL_WaitThread(gJobWorkers[i].thread, NULL);
+
+	gNumJobWorkers = 0;
+	gNumJobs = 0;
+	gJobsRunning = false;
+}
@@ -109,14 +109,15 @@ static const bool	gLevelHasCeiling[NUM_LEVEL_TYPES] =
 	true						// anthill
 };
 
-static const Byte	gLevelSuperTileActiveRange[NUM_LEVEL_TYPES] =
+static const Byte	gLevelSuperTileActiveRange[NUM_LEVEL_TYPES][NUM_VIEW_DISTANCES] =
 {
-	5,						// garden
-	4,						// boat
-	5,						// dragonfly
-	4,						// hive
-	4,						// night
-	4						// anthill
+//	normal	far	very far
+	{ 5,	7,	9 },			// garden
+	{ 4,	6,	8 },			// boat
+	{ 5,	7,	9 },			// dragonfly
+	{ 4,	4,	5 },			// hive (enclosed, little to gain)
+	{ 4,	6,	8 },			// night
+	{ 4,	4,	5 },			// anthill (enclosed, little to gain)
 };
 
 static const float	gLevelFogStart[NUM_LEVEL_TYPES] =
@@ -244,6 +245,7 @@ void InitPrefs(void)
 	gGamePrefs.vsync				= true;
 	gGamePrefs.antialiasingLevel	= 0;
 	gGamePrefs.displayNumMinus1		= 0;
+	gGamePrefs.viewDistance			= VIEW_DISTANCE_NORMAL;
 #if __APPLE__
 	gGamePrefs.appleKeyboardControls= true;
 #else
@@ -294,6 +296,7 @@ static void PlayGame(void)
 
 		gLevelType = gLevelTable[gRealLevel].levelType;
 		gAreaNum = gLevelTable[gRealLevel].areaNum;
+		gDoCeiling = gLevelHasCeiling[gLevelType];		// the intro preloads the playfield, which needs to know this
 		
 
 			/* PLAY THIS AREA */
@@ -334,6 +337,8 @@ game_over:
 		DoLoseScreen();
 
 	ShowHighScoresScreen(gScore);
+
+	PurgeSoundCache();									// the menus won't need the levels' sounds
 }
 
 
@@ -394,7 +399,7 @@ float fps;
 
 		QD3D_CalcFramesPerSecond();
 		DoSDLMaintenance();
-		gDisableHiccupTimer = false;
+		gPrimingTerrain = false;
 
 			/* SEE IF PAUSE GAME */
 
@@ -462,7 +467,7 @@ QD3DSetupInputType	viewDef;
 	gDrawLensFlare			= !gGamePrefs.lowDetail && gLevelHasLensFlare[gLevelType];
 
 	gDoCeiling				= gLevelHasCeiling[gLevelType];
-	gSuperTileActiveRange	= gLevelSuperTileActiveRange[gLevelType];
+	gSuperTileActiveRange	= gLevelSuperTileActiveRange[gLevelType][gGamePrefs.lowDetail ? VIEW_DISTANCE_NORMAL : gGamePrefs.viewDistance];
 	
 		
 	gAmbientColor 			= gLevelLightColors[gLevelType][0];
@@ -474,16 +479,7 @@ QD3DSetupInputType	viewDef;
 	gBestCheckPoint			= -1;								// no checkpoint yet
 
 		
-	if (gSuperTileActiveRange == 5)								// set yon clipping value
-	{
-		gCurrentYon = YON_DISTANCE + 1700;
-		gCycScale = 81;
-	}
-	else
-	{
-		gCurrentYon = YON_DISTANCE;
-		gCycScale = 50;
-	}
+	GetViewForSuperTileActiveRange(gSuperTileActiveRange, &gCurrentYon, &gCycScale);	// set yon clipping value
 
 
 
@@ -599,6 +595,7 @@ QD3DSetupInputType	viewDef;
 
 	QD3D_InitShards();
 	InitParticleSystem();
+	InitEffectPools();
 	InitItemsManager();
 
 		
@@ -630,6 +627,7 @@ static void CleanupLevel(void)
 
 	StopAllEffectChannels();
  	EmptySplineObjectList();
+	DisposeEffectPools();
 	DeleteAllObjects();
 	gCyclorama = nil;
 	FreeAllSkeletonFiles(-1);
@@ -740,6 +738,12 @@ static void CheckForCheats(void)
 		if (GetKeyState_SDL(SDL_SCANCODE_F7))		// hurt player
 			PlayerGotHurt(NULL, 1/60.0f, 1.0f, false, true, 1/60.0f);
 
+		if (GetNewKeyState_SDL(SDL_SCANCODE_PAGEUP))	// see further
+			SetSuperTileActiveRange(gSuperTileActiveRange + 1);
+
+		if (GetNewKeyState_SDL(SDL_SCANCODE_PAGEDOWN))	// see nearer
+			SetSuperTileActiveRange(gSuperTileActiveRange - 1);
+
 	}
 }
 
@@ -781,6 +785,12 @@ static void CheckDebugShortcutKeysOnBoot(void)
 		return;
 	}
 
+	if (GetKeyState_SDL(SDL_SCANCODE_F5))
+	{
+		BenchmarkTGADecoding();
+		return;
+	}
+
 	for (int i = 0; i < 10; i++)
 	{
 		if (GetKeyState_SDL(levelKeys[i]))
@@ -817,6 +827,7 @@ unsigned long	someLong;
 
 			/* INIT SOME OF MY STUFF */
 
+	Jobs_Init();
 	Render_CreateContext();
 	InitWindowStuff();
 	InitTerrainManager();
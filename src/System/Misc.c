@@ -41,15 +41,18 @@ static uint32_t seed0 = 0x2a80ce30, seed1 = 0, seed2 = 0;
 
 void DoAlert(const char* format, ...)
 {
-	if (gSDLWindow)
-		SDL_SetWindowFullscreen(gSDLWindow, 0);
-
 	char message[1024];
 	va_list args;
 	va_start(args, format);
 	SDL_vsnprintf(message, sizeof(message), format, args);
 	va_end(args);
 
+	if (Jobs_ReportAlert(message, false))				// on a worker thread: the main thread will show it
+		return;
+
+	if (gSDLWindow)
+		SDL_SetWindowFullscreen(gSDLWindow, 0);
+
 	SDL_Log("BUGDOM ALERT: %s\n", message);
 	SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Bugdom", message, gSDLWindow);
 }
@@ -59,15 +62,17 @@ void DoAlert(const char* format, ...)
 
 void DoFatalAlert(const char* format, ...)
 {
-	if (gSDLWindow)
-		SDL_SetWindowFullscreen(gSDLWindow, 0);
-
 	char message[1024];
 	va_list args;
 	va_start(args, format);
 	SDL_vsnprintf(message, sizeof(message), format, args);
 	va_end(args);
 
+	Jobs_ReportAlert(message, true);					// on a worker thread, this abandons the job & doesn't return
+
+	if (gSDLWindow)
+		SDL_SetWindowFullscreen(gSDLWindow, 0);
+
 	SDL_Log("BUGDOM FATAL ALERT: %s\n", message);
 	SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Bugdom", message, gSDLWindow);
 	ExitToShell();
@@ -80,6 +85,8 @@ void CleanQuit(void)
 {
 static Boolean beenHere = false;
 
+	Jobs_Cancel();									// stop any level preload before freeing what its workers write to
+
 	if (!beenHere)
 	{
 		GammaFadeOut(true);
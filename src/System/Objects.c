@@ -18,6 +18,8 @@
 
 static void FlushObjectDeleteQueue(int queueID);
 static void DisposeObjNodeMemory(ObjNode* node);
+static void InitObjNode(ObjNode* node, const NewObjectDefinitionType* newObjDef);
+static void CalcDisplayGroupBoundingSphere(ObjNode* theNode, Byte group, Byte type);
 
 
 /****************************/
@@ -105,34 +107,13 @@ void InitObjectManager(void)
 }
 
 
-/*********************** MAKE NEW OBJECT ******************/
-//
-// MAKE NEW OBJECT & RETURN PTR TO IT
+/*********************** INIT OBJNODE ******************/
 //
-// The linked list is sorted from smallest to largest!
+// Fills in a node from the template & the object definition.
 //
 
-ObjNode	*MakeNewObject(NewObjectDefinitionType *newObjDef)
+static void InitObjNode(ObjNode* newNodePtr, const NewObjectDefinitionType* newObjDef)
 {
-	ObjNode	*newNodePtr = NULL;
-
-		/* TRY TO GET AN OBJECT FROM THE POOL */
-
-	int pooledIndex = Pool_AllocateIndex(gObjNodePool);
-	if (pooledIndex >= 0)
-	{
-		newNodePtr = &gObjNodeMemory[pooledIndex];
-	}
-	else
-	{
-		// pool full, alloc new node on heap
-		newNodePtr = (ObjNode*) AllocPtr(sizeof(ObjNode));
-	}
-
-		/* MAKE SURE WE GOT ONE */
-
-	GAME_ASSERT(newNodePtr);
-
 		/* MAKE SURE SCALE != 0 */
 
 	float scale = newObjDef->scale;
@@ -167,6 +148,40 @@ ObjNode	*MakeNewObject(NewObjectDefinitionType *newObjDef)
 		newNodePtr->SplineMoveCall = newObjDef->moveCall;	// save spline move routine
 	else
 		newNodePtr->MoveCall = newObjDef->moveCall;			// save move routine
+}
+
+
+/*********************** MAKE NEW OBJECT ******************/
+//
+// MAKE NEW OBJECT & RETURN PTR TO IT
+//
+// The linked list is sorted from smallest to largest!
+//
+
+ObjNode	*MakeNewObject(NewObjectDefinitionType *newObjDef)
+{
+	ObjNode	*newNodePtr = NULL;
+
+		/* TRY TO GET AN OBJECT FROM THE POOL */
+
+	int pooledIndex = Pool_AllocateIndex(gObjNodePool);
+	if (pooledIndex >= 0)
+	{
+		newNodePtr = &gObjNodeMemory[pooledIndex];
+	}
+	else
+	{
+		// pool full, alloc new node on heap
+		newNodePtr = (ObjNode*) AllocPtr(sizeof(ObjNode));
+	}
+
+		/* MAKE SURE WE GOT ONE */
+
+	GAME_ASSERT(newNodePtr);
+
+		/* INITIALIZE NEW NODE */
+
+	InitObjNode(newNodePtr, newObjDef);
 
 				/* INSERT NODE INTO LINKED LIST */
 
@@ -215,16 +230,101 @@ Byte	group,type;
 
 
 			/* CALC RADIUS */
-			
-	newObj->BoundingSphere.origin.x = gObjectGroupRadiusList[group][type].origin.x * newObj->Scale.x;	
-	newObj->BoundingSphere.origin.y = gObjectGroupRadiusList[group][type].origin.y * newObj->Scale.y;	
-	newObj->BoundingSphere.origin.z = gObjectGroupRadiusList[group][type].origin.z * newObj->Scale.z;	
-	newObj->BoundingSphere.radius = gObjectGroupRadiusList[group][type].radius * newObj->Scale.x;
+
+	CalcDisplayGroupBoundingSphere(newObj, group, type);
 
 	return(newObj);
 }
 
 
+/************* CALC DISPLAY GROUP BOUNDING SPHERE *************/
+
+static void CalcDisplayGroupBoundingSphere(ObjNode* theNode, Byte group, Byte type)
+{
+	theNode->BoundingSphere.origin.x = gObjectGroupRadiusList[group][type].origin.x * theNode->Scale.x;
+	theNode->BoundingSphere.origin.y = gObjectGroupRadiusList[group][type].origin.y * theNode->Scale.y;
+	theNode->BoundingSphere.origin.z = gObjectGroupRadiusList[group][type].origin.z * theNode->Scale.z;
+	theNode->BoundingSphere.radius = gObjectGroupRadiusList[group][type].radius * theNode->Scale.x;
+}
+
+
+/************* PARK DISPLAY GROUP OBJECT *************/
+//
+// Takes an object out of the linked list without deleting it, so that it can be
+// brought back later with ReviveDisplayGroupObject (see the effect pools in Effects.c).
+// A parked object isn't moved, drawn or collided against, but it keeps its
+// geometry & collision box memory. It must still be deleted with DeleteObject eventually.
+//
+
+void ParkDisplayGroupObject(ObjNode *theNode)
+{
+	GAME_ASSERT(theNode->Genre == DISPLAY_GROUP_GENRE);
+	GAME_ASSERT(theNode->CType != INVALID_NODE_FLAG);
+	GAME_ASSERT_MESSAGE(!theNode->ChainNode && !theNode->ShadowNode, "can't park an object with a chain or shadow");
+
+	StopObjectStreamEffect(theNode);
+	DetachObject(theNode);
+}
+
+
+/************* REVIVE DISPLAY GROUP OBJECT *************/
+//
+// Reinitializes a parked object from a new object definition, as if it had just been made
+// by MakeNewDisplayGroupObject, and puts it back in the linked list.
+// The object's geometry is NOT reattached: the definition's group & type must be the
+// same as when the object was first made.
+//
+
+ObjNode *ReviveDisplayGroupObject(ObjNode *theNode, NewObjectDefinitionType *newObjDef)
+{
+	GAME_ASSERT(theNode->Genre == DISPLAY_GROUP_GENRE);
+	GAME_ASSERT(theNode->StatusBits & STATUS_BIT_DETACHED);
+	GAME_ASSERT(theNode->Group == newObjDef->group);
+	GAME_ASSERT(theNode->Type == newObjDef->type);
+
+			/* KEEP GEOMETRY & COLLISION BOXES */
+
+	int					numMeshes = theNode->NumMeshes;
+	TQ3TriMeshData*		meshList[MAX_DECOMPOSED_TRIMESHES];
+	bool				ownsMeshMemory[MAX_DECOMPOSED_TRIMESHES];
+	bool				ownsMeshTexture[MAX_DECOMPOSED_TRIMESHES];
+	CollisionBoxType*	collisionBoxes = theNode->CollisionBoxes;
+	CollisionBoxType*	oldCollisionBoxes = theNode->OldCollisionBoxes;
+	Byte				numCollisionBoxes = theNode->NumCollisionBoxes;
+
+	SDL_memcpy(meshList, theNode->MeshList, sizeof(meshList));
+	SDL_memcpy(ownsMeshMemory, theNode->OwnsMeshMemory, sizeof(ownsMeshMemory));
+	SDL_memcpy(ownsMeshTexture, theNode->OwnsMeshTexture, sizeof(ownsMeshTexture));
+
+			/* REINIT NODE */
+
+	newObjDef->genre = DISPLAY_GROUP_GENRE;
+	InitObjNode(theNode, newObjDef);
+
+	theNode->NumMeshes = numMeshes;
+	SDL_memcpy(theNode->MeshList, meshList, sizeof(meshList));
+	SDL_memcpy(theNode->OwnsMeshMemory, ownsMeshMemory, sizeof(ownsMeshMemory));
+	SDL_memcpy(theNode->OwnsMeshTexture, ownsMeshTexture, sizeof(ownsMeshTexture));
+	theNode->CollisionBoxes = collisionBoxes;
+	theNode->OldCollisionBoxes = oldCollisionBoxes;
+	theNode->NumCollisionBoxes = numCollisionBoxes;
+
+	theNode->RenderModifiers.drawOrder = newObjDef->drawOrder;
+
+	UpdateObjectTransforms(theNode);
+	CalcDisplayGroupBoundingSphere(theNode, newObjDef->group, newObjDef->type);
+
+			/* PUT IT BACK IN THE LINKED LIST */
+
+	theNode->StatusBits |= STATUS_BIT_DETACHED;
+	AttachObject(theNode);
+
+	gMostRecentlyAddedNode = theNode;
+
+	return(theNode);
+}
+
+
 /************* MAKE NEW CUSTOM DRAW OBJECT *************/
 
 ObjNode *MakeNewCustomDrawObject(NewObjectDefinitionType *newObjDef, TQ3BoundingSphere *cullSphere, void drawFunc(ObjNode *))
@@ -585,7 +685,7 @@ void DeleteObject(ObjNode	*theNode)
 		// If the node has ownership of this mesh's OpenGL texture name, delete it
 		if (theNode->MeshList[i]->glTextureName && theNode->OwnsMeshTexture[i])
 		{
-			glDeleteTextures(1, &theNode->MeshList[i]->glTextureName);
+			Render_DeleteTextures(1, &theNode->MeshList[i]->glTextureName);
 			theNode->MeshList[i]->glTextureName = 0;
 		}
 
@@ -41,6 +41,11 @@
 
 void AllocateCollisionBoxMemory(ObjNode *theNode, short numBoxes)
 {
+			/* SEE IF CAN REUSE EXISTING MEMORY */
+
+	if (theNode->CollisionBoxes && theNode->NumCollisionBoxes == numBoxes)
+		return;
+
 			/* FREE OLD STUFF */
 			
 	if (theNode->CollisionBoxes)
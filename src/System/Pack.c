@@ -0,0 +1,296 @@
+// PACK.C
+// This file is part of Bugdom. https://github.com/jorio/bugdom
+
+
+/***************/
+/* EXTERNALS   */
+/***************/
+
+#include "game.h"
+
+
+/****************************/
+/*    CONSTANTS             */
+/****************************/
+
+#define	PACK_FORMAT_VERSION		1					// must match packaging/make_data_pack.py
+#define	PACK_MAX_PATH			64
+
+#define	PACK_FLAG_LZ4			(1 << 0)			// entry is an LZ4 block
+
+#define	LZ4_MIN_MATCH			4
+
+
+/****************************/
+/*    TYPES                 */
+/****************************/
+
+		/* PACK FILE LAYOUT */
+		//
+		// All integers are little-endian.
+		// The header is followed by the index, sorted by path (case-insensitive),
+		// then by the file data. Each file starts on a 16-byte boundary.
+		//
+
+typedef struct
+{
+	char		magic[4];
+	uint32_t	formatVersion;
+	uint32_t	numEntries;
+	uint32_t	pad;
+} PackHeader;
+
+typedef struct
+{
+	char		path[PACK_MAX_PATH];		// relative to the Data folder, colon-separated, nul-terminated
+	uint64_t	offset;						// from the start of the pack
+	uint32_t	size;						// uncompressed
+	uint32_t	packedSize;					// as stored in the pack
+	uint32_t	flags;
+	uint32_t	pad;
+} PackEntry;
+
+
+/****************************/
+/*    PROTOTYPES            */
+/****************************/
+
+static const PackEntry* FindPackEntry(const char* path);
+static Boolean DecompressLZ4(const Byte* in, long inSize, Byte* out, long outSize);
+
+
+/*********************/
+/*    VARIABLES      */
+/*********************/
+
+static const char kPackMagic[4] = {'B','P','a','k'};
+
+static SDL_IOStream*	gPackFile = NULL;
+static PackEntry*		gPackIndex = nil;
+static int				gNumPackEntries = 0;
+
+
+/******************** OPEN PACK **********************/
+
+void Pack_Open(const char* hostPath)
+{
+PackHeader	header;
+
+	GAME_ASSERT(!gPackFile);
+
+	SDL_IOStream* file = SDL_IOFromFile(hostPath, "rb");
+	if (!file)
+		return;
+
+	Sint64 packSize = SDL_GetIOSize(file);
+
+			/* READ & CHECK HEADER */
+
+	if (sizeof(header) != SDL_ReadIO(file, &header, sizeof(header))
+		|| 0 != SDL_memcmp(header.magic, kPackMagic, sizeof(kPackMagic))
+		|| SDL_Swap32LE(header.formatVersion) != PACK_FORMAT_VERSION)
+	{
+		goto bail;
+	}
+
+	int numEntries = SDL_Swap32LE(header.numEntries);
+	if (numEntries <= 0 || (Sint64) (sizeof(header) + numEntries * sizeof(PackEntry)) > packSize)
+		goto bail;
+
+			/* READ INDEX */
+
+	PackEntry* index = (PackEntry*) NewPtr(numEntries * sizeof(PackEntry));
+	GAME_ASSERT(index);
+
+	if (numEntries * sizeof(PackEntry) != SDL_ReadIO(file, index, numEntries * sizeof(PackEntry)))
+	{
+		DisposePtr((Ptr) index);
+		goto bail;
+	}
+
+	for (int i = 0; i < numEntries; i++)
+	{
+		PackEntry* entry = &index[i];
+
+		entry->offset		= SDL_Swap64LE(entry->offset);
+		entry->size			= SDL_Swap32LE(entry->size);
+		entry->packedSize	= SDL_Swap32LE(entry->packedSize);
+		entry->flags		= SDL_Swap32LE(entry->flags);
+
+		if (entry->path[PACK_MAX_PATH-1] != '\0'								// reject the whole pack if anything is off
+			|| (Sint64) (entry->offset + entry->packedSize) > packSize
+			|| (!(entry->flags & PACK_FLAG_LZ4) && entry->packedSize != entry->size)
+			|| (i > 0 && SDL_strcasecmp(index[i-1].path, entry->path) >= 0))
+		{
+			DisposePtr((Ptr) index);
+			goto bail;
+		}
+	}
+
+	gPackFile = file;
+	gPackIndex = index;
+	gNumPackEntries = numEntries;
+
+	SDL_Log("Opened asset pack: %d files\n", numEntries);
+	return;
+
+bail:
+	SDL_Log("Ignoring invalid asset pack %s\n", hostPath);
+	SDL_CloseIO(file);
+}
+
+
+/******************** FIND PACK ENTRY **********************/
+//
+// Binary search in the index.
+//
+
+static const PackEntry* FindPackEntry(const char* path)
+{
+	int lo = 0;
+	int hi = gNumPackEntries - 1;
+
+	while (lo <= hi)
+	{
+		int mid = lo + (hi - lo) / 2;
+		int cmp = SDL_strcasecmp(path, gPackIndex[mid].path);
+
+		if (cmp == 0)
+			return &gPackIndex[mid];
+		else if (cmp < 0)
+			hi = mid - 1;
+		else
+			lo = mid + 1;
+	}
+
+	return nil;
+}
+
+
+/******************** HAS FILE **********************/
+
+bool Pack_HasFile(const char* path)
+{
+	return gPackFile && FindPackEntry(path);
+}
+
+
+/******************** LOAD FILE FROM PACK **********************/
+
+Ptr Pack_LoadFile(const char* path, long* outSize)
+{
+	if (!gPackFile)
+		return nil;
+
+	const PackEntry* entry = FindPackEntry(path);
+	if (!entry)
+		return nil;
+
+	Ptr packed = NewPtr(SDL_max(entry->packedSize, 1u));
+	GAME_ASSERT(packed);
+
+			/* READ IT IN ONE GO */
+
+	Jobs_LockFiles();													// the pack's stream is shared by all threads
+	bool readOK = SDL_SeekIO(gPackFile, entry->offset, SDL_IO_SEEK_SET) >= 0
+		&& entry->packedSize == SDL_ReadIO(gPackFile, packed, entry->packedSize);
+	Jobs_UnlockFiles();
+
+	GAME_ASSERT_MESSAGE(readOK, path);
+
+			/* DECOMPRESS IT */
+
+	if (entry->flags & PACK_FLAG_LZ4)
+	{
+		Ptr unpacked = NewPtr(SDL_max(entry->size, 1u));
+		GAME_ASSERT(unpacked);
+
+		Boolean unpackOK = DecompressLZ4((const Byte*) packed, entry->packedSize, (Byte*) unpacked, entry->size);
+		GAME_ASSERT_MESSAGE(unpackOK, path);
+
+		DisposePtr(packed);
+		packed = unpacked;
+	}
+
+	*outSize = entry->size;
+	return packed;
+}
+
+
+/******************** DECOMPRESS LZ4 **********************/
+//
+// Decodes a raw LZ4 block (no frame header).
+// Returns false if the block is malformed or doesn't decode to exactly outSize bytes.
+//
+
+static Boolean DecompressLZ4(const Byte* in, long inSize, Byte* out, long outSize)
+{
+	const Byte* const inEnd = in + inSize;
+	Byte* const outStart = out;
+	Byte* const outEnd = out + outSize;
+
+	while (in < inEnd)
+	{
+		Byte token = *in++;
+
+				/* LITERALS */
+
+		long literalLength = token >> 4;
+		if (literalLength == 15)
+		{
+			Byte b;
+			do
+			{
+				if (in >= inEnd)
+					return false;
+				b = *in++;
+				literalLength += b;
+			} while (b == 255);
+		}
+
+		if (literalLength > inEnd - in || literalLength > outEnd - out)
+			return false;
+
+		SDL_memcpy(out, in, literalLength);
+		in += literalLength;
+		out += literalLength;
+
+		if (in == inEnd)												// the last sequence only has literals
+			break;
+
+				/* MATCH */
+
+		if (inEnd - in < 2)
+			return false;
+
+		long offset = in[0] | (in[1] << 8);
+		in += 2;
+
+		if (offset == 0 || offset > out - outStart)
+			return false;
+
+		long matchLength = token & 15;
+		if (matchLength == 15)
+		{
+			Byte b;
+			do
+			{
+				if (in >= inEnd)
+					return false;
+				b = *in++;
+				matchLength += b;
+			} while (b == 255);
+		}
+		matchLength += LZ4_MIN_MATCH;
+
+		if (matchLength > outEnd - out)
+			return false;
+
+		const Byte* match = out - offset;
+		for (long i = 0; i < matchLength; i++)							// byte by byte: the match may overlap what we're writing
+			out[i] = match[i];
+		out += matchLength;
+	}
+
+	return out == outEnd;
+}
@@ -19,6 +19,13 @@
 
 static void SongCompletionProc(SndChannelPtr chan);
 static short FindSilentChannel(void);
+static void ReadSoundEffect(int effectNum);
+static Boolean LoadDecodedSoundEffect(int effectNum, uint64_t sourceHash);
+static void SaveDecodedSoundEffect(int effectNum, uint64_t sourceHash);
+static void LoadSoundEffect_Work(void* userData);
+static Boolean RestoreCachedSoundEffect(int effectNum);
+static void CacheSoundEffect(int effectNum);
+static void TrimSoundCache(long maxBytes);
 static void Calc3DEffectVolume(short effectNum, TQ3Point3D *where, float volAdjust, u_long *leftVolOut, u_long *rightVolOut);
 
 
@@ -28,6 +35,10 @@ static void Calc3DEffectVolume(short effectNum, TQ3Point3D *where, float volAdju
 
 #define		MAX_CHANNELS			14
 
+#define		SOUND_CACHE_BUDGET		(16 * 1024 * 1024)		// max bytes of decompressed sounds kept around after their bank is disposed
+
+#define		DECODED_SOUND_VERSION	1						// bump when the decoded sound payload or Pomme's decompressor output changes
+
 
 typedef struct
 {
@@ -45,6 +56,34 @@ typedef struct
 	u_long			lastLoudness;
 } LoadedEffect;
 
+		/* SOUND CACHE */
+		//
+		// When a bank is disposed, its decompressed effects are kept here
+		// so the next level that needs them doesn't have to reload them.
+		//
+
+typedef struct
+{
+	SndListHandle	sndHandle;
+	long			sndOffset;
+	long			size;
+	uint32_t		lastUsed;				// gSoundCacheClock when the effect was last disposed
+} CachedEffect;
+
+		/* DECODED SOUND FILE */
+		//
+		// Payload of an effect's decoded copy in the on-disk cache:
+		// this header, followed by the decompressed 'snd ' resource.
+		//
+
+typedef struct
+{
+	int32_t			sndOffset;
+	uint32_t		pad;
+} DecodedSoundHeader;
+
+_Static_assert(sizeof(DecodedSoundHeader) % 8 == 0, "Cache_LoadHandle needs the prefix to be a multiple of 8 bytes");
+
 
 #define	VOLUME_DISTANCE_FACTOR	.004f		// bigger == sound decays FASTER with dist, smaller = louder far away
 
@@ -76,6 +115,12 @@ static	TQ3Vector3D			gEyeVector;
 
 static	LoadedEffect		gLoadedEffects[NUM_EFFECTS];
 
+static	CachedEffect		gCachedEffects[NUM_EFFECTS];
+static	long				gSoundCacheBytes = 0;
+static	uint32_t			gSoundCacheClock = 0;
+static	int					gSoundCacheHits = 0;
+static	int					gSoundCacheMisses = 0;
+
 static	SndChannelPtr		gSndChannel[MAX_CHANNELS];
 static	ChannelInfoType		gChannelInfo[MAX_CHANNELS];
 
@@ -165,6 +210,7 @@ OSErr		iErr;
 			/* INIT BANK INFO */
 
 	SDL_memset(gLoadedEffects, 0, sizeof(gLoadedEffects));
+	SDL_memset(gCachedEffects, 0, sizeof(gCachedEffects));
 
 			/******************/
 			/* ALLOC CHANNELS */
@@ -190,6 +236,27 @@ OSErr		iErr;
 /******************* LOAD A SOUND EFFECT ************************/
 
 void LoadSoundEffect(int effectNum)
+{
+	if (gLoadedEffects[effectNum].sndHandle)
+	{
+		// already loaded
+		return;
+	}
+
+	if (RestoreCachedSoundEffect(effectNum))
+		return;
+
+	gSoundCacheMisses++;
+	ReadSoundEffect(effectNum);
+}
+
+/******************* READ A SOUND EFFECT ************************/
+//
+// Loads & decompresses an effect from its file, or loads its decoded copy from the on-disk cache.
+// Doesn't touch the sound cache, so it may run on a worker thread.
+//
+
+static void ReadSoundEffect(int effectNum)
 {
 char path[256];
 FSSpec spec;
@@ -199,21 +266,33 @@ OSErr err;
 	LoadedEffect* loadedSound = &gLoadedEffects[effectNum];
 	const EffectDef* effectDef = &kEffectsTable[effectNum];
 
-	if (loadedSound->sndHandle)
-	{
-		// already loaded
-		return;
-	}
-
 	SDL_snprintf(path, sizeof(path), ":Audio:%s.sounds:%s.aiff", kSoundBankNames[effectDef->bank], effectDef->filename);
 
+	Jobs_LockFiles();
 	err = FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &spec);
+	Jobs_UnlockFiles();
+
 	if (err != noErr)
 	{
 		DoAlert(path);
 		return;
 	}
 
+			/* SEE IF WE HAVE IT DECODED ALREADY */
+			//
+			// Hashing the whole AIFF would cost about as much as decoding it,
+			// so the cache entry is keyed on a cheap stamp of the file instead.
+			//
+
+	uint64_t sourceHash = Cache_StampFile(&spec, false);
+
+	if (LoadDecodedSoundEffect(effectNum, sourceHash))
+		return;
+
+			/* LOAD THE AIFF */
+
+	Jobs_LockFiles();
+
 	err = FSpOpenDF(&spec, fsRdPerm, &refNum);
 	GAME_ASSERT_MESSAGE(err == noErr, path);
 
@@ -222,6 +301,8 @@ OSErr err;
 
 	FSClose(refNum);
 
+	Jobs_UnlockFiles();
+
 			/* GET OFFSET INTO IT */
 
 	GetSoundHeaderOffset(loadedSound->sndHandle, &loadedSound->sndOffset);
@@ -229,9 +310,70 @@ OSErr err;
 			/* PRE-DECOMPRESS IT */
 
 	Pomme_DecompressSoundResource(&loadedSound->sndHandle, &loadedSound->sndOffset);
+
+	SaveDecodedSoundEffect(effectNum, sourceHash);
+}
+
+/******************* LOAD DECODED SOUND EFFECT ************************/
+//
+// Loads an effect's decompressed 'snd ' from the on-disk cache if it's up to date with the AIFF.
+//
+
+static Boolean LoadDecodedSoundEffect(int effectNum, uint64_t sourceHash)
+{
+char				cacheName[64];
+DecodedSoundHeader	header;
+
+	LoadedEffect* loadedSound = &gLoadedEffects[effectNum];
+	const EffectDef* effectDef = &kEffectsTable[effectNum];
+
+	SDL_snprintf(cacheName, sizeof(cacheName), "Sound-%s-%s", kSoundBankNames[effectDef->bank], effectDef->filename);
+
+	Handle sndHandle = Cache_LoadHandle(cacheName, DECODED_SOUND_VERSION, &sourceHash, 1, &header, sizeof(header));
+	if (!sndHandle)
+		return false;
+
+	if (header.sndOffset < 0
+		|| header.sndOffset >= GetHandleSize(sndHandle))
+	{
+		DisposeHandle(sndHandle);
+		return false;
+	}
+
+	loadedSound->sndHandle = (SndListHandle) sndHandle;				// the cache handed us the 'snd ' in its own handle, no copy needed
+	loadedSound->sndOffset = header.sndOffset;
+	return true;
+}
+
+/******************* SAVE DECODED SOUND EFFECT ************************/
+
+static void SaveDecodedSoundEffect(int effectNum, uint64_t sourceHash)
+{
+char	cacheName[64];
+
+	const LoadedEffect* loadedSound = &gLoadedEffects[effectNum];
+	const EffectDef* effectDef = &kEffectsTable[effectNum];
+
+	long sndSize = GetHandleSize((Handle) loadedSound->sndHandle);
+	long payloadSize = sizeof(DecodedSoundHeader) + sndSize;
+
+	Ptr payload = NewPtrClear(payloadSize);
+	GAME_ASSERT(payload);
+
+	DecodedSoundHeader* header = (DecodedSoundHeader*) payload;
+	header->sndOffset = (int32_t) loadedSound->sndOffset;
+	SDL_memcpy(payload + sizeof(DecodedSoundHeader), *loadedSound->sndHandle, sndSize);
+
+	SDL_snprintf(cacheName, sizeof(cacheName), "Sound-%s-%s", kSoundBankNames[effectDef->bank], effectDef->filename);
+	Cache_Save(cacheName, DECODED_SOUND_VERSION, &sourceHash, 1, payload, payloadSize);
+
+	DisposePtr(payload);
 }
 
 /******************* DISPOSE OF A SOUND EFFECT ************************/
+//
+// The effect goes to the sound cache, in case we need it again soon.
+//
 
 void DisposeSoundEffect(int effectNum)
 {
@@ -239,11 +381,108 @@ void DisposeSoundEffect(int effectNum)
 
 	if (loadedSound->sndHandle)
 	{
-		DisposeHandle((Handle) loadedSound->sndHandle);
+		CacheSoundEffect(effectNum);
 		SDL_memset(loadedSound, 0, sizeof(LoadedEffect));
 	}
 }
 
+#pragma mark -
+
+/******************* CACHE A SOUND EFFECT ************************/
+//
+// Moves a loaded effect into the sound cache,
+// then evicts the least recently used effects until the cache is within budget.
+//
+
+static void CacheSoundEffect(int effectNum)
+{
+	LoadedEffect* loadedSound = &gLoadedEffects[effectNum];
+	CachedEffect* cachedSound = &gCachedEffects[effectNum];
+
+	GAME_ASSERT(!cachedSound->sndHandle);
+
+	cachedSound->sndHandle	= loadedSound->sndHandle;
+	cachedSound->sndOffset	= loadedSound->sndOffset;
+	cachedSound->size		= GetHandleSize((Handle) loadedSound->sndHandle);
+	cachedSound->lastUsed	= ++gSoundCacheClock;
+
+	gSoundCacheBytes += cachedSound->size;
+
+	TrimSoundCache(SOUND_CACHE_BUDGET);
+}
+
+/******************* RESTORE A CACHED SOUND EFFECT ************************/
+//
+// If the effect is in the sound cache, moves it back to the loaded effects.
+//
+
+static Boolean RestoreCachedSoundEffect(int effectNum)
+{
+	LoadedEffect* loadedSound = &gLoadedEffects[effectNum];
+	CachedEffect* cachedSound = &gCachedEffects[effectNum];
+
+	if (!cachedSound->sndHandle)
+		return false;
+
+	GAME_ASSERT(!loadedSound->sndHandle);
+
+	loadedSound->sndHandle = cachedSound->sndHandle;
+	loadedSound->sndOffset = cachedSound->sndOffset;
+
+	gSoundCacheBytes -= cachedSound->size;
+	SDL_memset(cachedSound, 0, sizeof(CachedEffect));
+
+	gSoundCacheHits++;
+	return true;
+}
+
+/******************* TRIM SOUND CACHE ************************/
+//
+// Evicts the least recently used effects until the cache holds at most maxBytes.
+// Pass 0 to empty the cache.
+//
+
+static void TrimSoundCache(long maxBytes)
+{
+	while (gSoundCacheBytes > maxBytes)
+	{
+		CachedEffect* oldest = nil;
+
+		for (int i = 0; i < NUM_EFFECTS; i++)
+		{
+			CachedEffect* cachedSound = &gCachedEffects[i];
+			if (cachedSound->sndHandle
+				&& (!oldest || cachedSound->lastUsed < oldest->lastUsed))
+			{
+				oldest = cachedSound;
+			}
+		}
+
+		GAME_ASSERT(oldest);
+
+		DisposeHandle((Handle) oldest->sndHandle);
+		gSoundCacheBytes -= oldest->size;
+		SDL_memset(oldest, 0, sizeof(CachedEffect));
+	}
+}
+
+/******************* PURGE SOUND CACHE ************************/
+
+void PurgeSoundCache(void)
+{
+	TrimSoundCache(0);
+}
+
+/******************* LOG SOUND CACHE STATS ************************/
+
+void LogSoundCacheStats(void)
+{
+	SDL_Log("Sound cache: %d hits, %d misses, %ld KB cached\n",
+			gSoundCacheHits, gSoundCacheMisses, gSoundCacheBytes / 1024);
+}
+
+#pragma mark -
+
 /******************* LOAD SOUND BANK ************************/
 
 void LoadSoundBank(int bankNum)
@@ -263,6 +502,33 @@ void LoadSoundBank(int bankNum)
 	}
 }
 
+/******************* QUEUE SOUND BANK LOAD ************************/
+//
+// Same as LoadSoundBank, but each effect is loaded & decompressed by a worker thread.
+//
+
+void QueueSoundBankLoad(int bankNum)
+{
+	StopAllEffectChannels();
+
+	for (int i = 0; i < NUM_EFFECTS; i++)
+	{
+		if (kEffectsTable[i].bank != bankNum || gLoadedEffects[i].sndHandle)
+			continue;
+
+		if (RestoreCachedSoundEffect(i))						// no need to go to disk
+			continue;
+
+		gSoundCacheMisses++;
+		Jobs_Add(LoadSoundEffect_Work, NULL, (void*) (intptr_t) i, 0, NULL);
+	}
+}
+
+static void LoadSoundEffect_Work(void* userData)
+{
+	ReadSoundEffect((int) (intptr_t) userData);
+}
+
 /******************** DISPOSE SOUND BANK **************************/
 
 void DisposeSoundBank(int bankNum)
@@ -289,6 +555,10 @@ void DisposeAllSoundBanks(void)
 	{
 		DisposeSoundBank(i);
 	}
+
+#if _DEBUG
+	LogSoundCacheStats();
+#endif
 }
 
 /********************* STOP A CHANNEL **********************/
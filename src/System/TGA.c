@@ -4,222 +4,402 @@
 
 #include "game.h"
 
-static void DecompressRLE(short refNum, TGAHeader* header, uint8_t* out)
+// Pick a SIMD flavor for the row converters. Every converter has a scalar tail,
+// and there's a plain scalar fallback for other targets.
+#if (defined(__ARM_NEON) || defined(_M_ARM64)) && !defined(__ARM_BIG_ENDIAN)
+	#include <arm_neon.h>
+	#define TGA_NEON	1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define TGA_SSE2	1
+	#if defined(__SSSE3__) || defined(__AVX__)
+		#include <tmmintrin.h>
+		#define TGA_SSSE3	1
+	#endif
+#endif
+
+#define BENCHMARK_TGA_PASSES	20
+
+// How to turn a row of source pixels into a row of output pixels
+enum
 {
-	OSErr err = noErr;
-
-	// Get number of bytes until EOF
-	long pos = 0;
-	long eof = 0;
-	long compressedLength = 0;
-	GetFPos(refNum, &pos);
-	GetEOF(refNum, &eof);
-	compressedLength = eof - pos;
-
-	// Prep compressed data buffer
-	Ptr compressedData = AllocPtr(compressedLength);
-
-	// Read rest of file into compressed data buffer
-	err = FSRead(refNum, &compressedLength, compressedData);
+	TGA_ROW_COPY,				// output has the same layout as the source
+	TGA_ROW_CMAP_TO_BGR,
+	TGA_ROW_CMAP_TO_RGBA,
+	TGA_ROW_BGRA32_TO_RGBA,
+	TGA_ROW_BGR24_TO_RGBA,
+	TGA_ROW_RGB5_TO_RGBA,		// 5-5-5 color, opaque
+	TGA_ROW_A1RGB5_TO_RGBA,		// 1 alpha + 5-5-5 color
+	TGA_ROW_GRAY8_TO_RGBA,
+};
+
+// RLE decoder state. Packets may straddle rows, so this persists from one row to the next.
+typedef struct
+{
+	const uint8_t*	in;
+	const uint8_t*	eod;
+	int				bytesPerPixel;
+	int				packetPixelsLeft;
+	bool			packetIsRun;
+} TGARLEState;
 
-	GAME_ASSERT(err == noErr);
-	GAME_ASSERT(compressedLength == eof-pos);	// Ensure we got as many bytes as we asked for
+static OSErr ParseTGA(const uint8_t* fileData, long fileSize, uint8_t** outPtr, TGAHeader* outHeader, bool forceRGBA);
+static uint8_t* LoadDataFileBytes(const char* path, long* outSize);
 
-	const long bytesPerPixel	= header->bpp / 8;
-	const long pixelCount		= header->width * header->height;
-	long pixelsProcessed		= 0;
+#pragma mark - RLE
 
-	const uint8_t*			in  = (uint8_t*) compressedData;
-	const uint8_t* const	eod = in + compressedLength;
+static void DecompressRLERow(TGARLEState* rle, uint8_t* out, int pixelCount)
+{
+	const int bytesPerPixel = rle->bytesPerPixel;
 
-	while (pixelsProcessed < pixelCount)
+	while (pixelCount > 0)
 	{
-		GAME_ASSERT(in < eod);
+		if (rle->packetPixelsLeft == 0)
+		{
+			GAME_ASSERT(rle->in < rle->eod);
 
-		uint8_t packetHeader = *(in++);
-		uint8_t packetLength = 1 + (packetHeader & 0x7F);
+			uint8_t packetHeader = *(rle->in++);
+			rle->packetPixelsLeft = 1 + (packetHeader & 0x7F);
+			rle->packetIsRun = packetHeader & 0x80;
 
-		GAME_ASSERT(pixelsProcessed + packetLength <= pixelCount);
+			GAME_ASSERT(rle->in + (rle->packetIsRun ? 1 : rle->packetPixelsLeft) * bytesPerPixel <= rle->eod);
+		}
+
+		int n = SDL_min(pixelCount, rle->packetPixelsLeft);
+		long nBytes = n * bytesPerPixel;
 
-		if (packetHeader & 0x80)		// Run-length packet
+		if (rle->packetIsRun)			// Run-length packet: replicate the pixel value
 		{
-			GAME_ASSERT(in + bytesPerPixel <= eod);
-			for (int i = 0; i < packetLength; i++)
+			if (bytesPerPixel == 1)
+			{
+				SDL_memset(out, rle->in[0], n);
+			}
+			else
 			{
-				BlockMove(in, out, bytesPerPixel);
-				out += bytesPerPixel;
-				pixelsProcessed++;
+				// Seed one pixel, then keep doubling the span so long runs take a handful of wide copies
+				BlockMove(rle->in, out, bytesPerPixel);
+				for (long filled = bytesPerPixel; filled < nBytes; filled *= 2)
+					SDL_memcpy(out + filled, out, SDL_min(filled, nBytes - filled));
 			}
-			in += bytesPerPixel;
+
+			rle->packetPixelsLeft -= n;
+			if (rle->packetPixelsLeft == 0)
+				rle->in += bytesPerPixel;
 		}
 		else							// Raw packet
 		{
-			long packetBytes = packetLength * bytesPerPixel;
-			GAME_ASSERT(in + packetBytes <= eod);
-			BlockMove(in, out, packetBytes);
-			in  += packetBytes;
-			out += packetBytes;
-			pixelsProcessed += packetLength;
+			BlockMove(rle->in, out, nBytes);
+			rle->in += nBytes;
+			rle->packetPixelsLeft -= n;
 		}
-	}
 
-	DisposePtr(compressedData);
+		out += nBytes;
+		pixelCount -= n;
+	}
 }
 
-static uint8_t* ConvertColormappedToBGR(const uint8_t* in, const TGAHeader* header, const uint8_t* palette)
-{
-	const int pixelCount				= header->width * header->height;
-	const int bytesPerColor				= header->paletteBitsPerColor / 8;
-	const uint16_t paletteColorCount	= header->paletteColorCountLo	| ((uint16_t)header->paletteColorCountHi	<< 8);
+#pragma mark - Row converters
 
-	uint8_t* remapped = (uint8_t*) AllocPtr(pixelCount * (header->paletteBitsPerColor / 8));
-	uint8_t* out = remapped;
+static inline uint8_t Expand5To8(uint16_t x)
+{
+	return (x * 255) / 31;
+}
 
-	GAME_ASSERT(bytesPerColor == 3);
+static void ConvertRowBGRA32ToRGBA(const uint8_t* in, uint8_t* out, int n)
+{
+	int i = 0;
 
-	for (int i = 0; i < pixelCount; i++)
+#if TGA_NEON
+	for (; i + 16 <= n; i += 16)
+	{
+		uint8x16x4_t px = vld4q_u8(in + i*4);
+		uint8x16_t b = px.val[0];
+		px.val[0] = px.val[2];
+		px.val[2] = b;
+		vst4q_u8(out + i*4, px);
+	}
+#elif TGA_SSE2
+	const __m128i agMask = _mm_set1_epi32((int) 0xFF00FF00);
+	const __m128i rbMask = _mm_set1_epi32((int) 0x00FF00FF);
+	for (; i + 4 <= n; i += 4)
 	{
-		uint8_t colorIndex = *in;
+		__m128i v  = _mm_loadu_si128((const __m128i*) (in + i*4));
+		__m128i ag = _mm_and_si128(v, agMask);
+		__m128i rb = _mm_and_si128(v, rbMask);
+		rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));		// swap B & R within each pixel
+		_mm_storeu_si128((__m128i*) (out + i*4), _mm_or_si128(ag, rb));
+	}
+#endif
 
-		GAME_ASSERT(colorIndex < paletteColorCount);
+	for (; i < n; i++)
+	{
+		const uint8_t* p = in + i*4;
+		uint8_t* q = out + i*4;
+		q[0] = p[2];
+		q[1] = p[1];
+		q[2] = p[0];
+		q[3] = p[3];
+	}
+}
 
-		out[0] = palette[colorIndex*3+0];	// TGA stores its palette as BGR!
-		out[1] = palette[colorIndex*3+1];
-		out[2] = palette[colorIndex*3+2];
+static void ConvertRowBGR24ToRGBA(const uint8_t* in, uint8_t* out, int n)
+{
+	int i = 0;
 
-		in++;
-		out += bytesPerColor;
+#if TGA_NEON
+	for (; i + 16 <= n; i += 16)
+	{
+		uint8x16x3_t bgr = vld3q_u8(in + i*3);
+		uint8x16x4_t rgba = {{ bgr.val[2], bgr.val[1], bgr.val[0], vdupq_n_u8(0xFF) }};
+		vst4q_u8(out + i*4, rgba);
+	}
+#elif TGA_SSSE3
+	const __m128i shuffle = _mm_setr_epi8(2,1,0,-128, 5,4,3,-128, 8,7,6,-128, 11,10,9,-128);
+	const __m128i alpha = _mm_set1_epi32((int) 0xFF000000);
+	for (; i + 6 <= n; i += 4)					// the 16-byte load reads 4 bytes past the 4 pixels we convert
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*) (in + i*3));
+		v = _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha);
+		_mm_storeu_si128((__m128i*) (out + i*4), v);
 	}
+#endif
 
-	return remapped;
+	for (; i < n; i++)
+	{
+		const uint8_t* p = in + i*3;
+		uint8_t* q = out + i*4;
+		q[0] = p[2];
+		q[1] = p[1];
+		q[2] = p[0];
+		q[3] = 0xFF;
+	}
 }
 
-static uint8_t* ConvertToRGBA(const uint8_t* in, const TGAHeader* header)
+// Targa source data is A1RGB5 packed into a little-endian 16-bit word.
+// The SIMD paths expand 5-bit channels with 8x + (x*1855 >> 13), which equals (x*255)/31 for x in [0;31].
+static void ConvertRow16ToRGBA(const uint8_t* in, uint8_t* out, int n, bool hasAlpha)
 {
-	uint8_t* converted = (uint8_t*) AllocPtr(header->width * header->height * 4);
+	int i = 0;
 
-	struct TargetPixel { uint8_t r, g, b, a; } *outPixel = (struct TargetPixel*) converted;
+#if TGA_NEON
+	const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+	for (; i + 8 <= n; i += 8)
+	{
+		uint16x8_t v = vld1q_u16((const uint16_t*) (in + i*2));
+		uint16x8_t r = vandq_u16(vshrq_n_u16(v, 10), mask5);
+		uint16x8_t g = vandq_u16(vshrq_n_u16(v, 5), mask5);
+		uint16x8_t b = vandq_u16(v, mask5);
+		r = vaddq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(vmulq_n_u16(r, 1855), 13));
+		g = vaddq_u16(vshlq_n_u16(g, 3), vshrq_n_u16(vmulq_n_u16(g, 1855), 13));
+		b = vaddq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(vmulq_n_u16(b, 1855), 13));
+
+		uint8x8x4_t rgba;
+		rgba.val[0] = vmovn_u16(r);
+		rgba.val[1] = vmovn_u16(g);
+		rgba.val[2] = vmovn_u16(b);
+		rgba.val[3] = hasAlpha ? vmovn_u16(vmulq_n_u16(vshrq_n_u16(v, 15), 0xFF)) : vdup_n_u8(0xFF);
+		vst4_u8(out + i*4, rgba);
+	}
+#elif TGA_SSE2
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i mul = _mm_set1_epi16(1855);
+	const __m128i opaque = _mm_set1_epi16(0xFF);
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*) (in + i*2));
+		__m128i r = _mm_and_si128(_mm_srli_epi16(v, 10), mask5);
+		__m128i g = _mm_and_si128(_mm_srli_epi16(v, 5), mask5);
+		__m128i b = _mm_and_si128(v, mask5);
+		r = _mm_add_epi16(_mm_slli_epi16(r, 3), _mm_srli_epi16(_mm_mullo_epi16(r, mul), 13));
+		g = _mm_add_epi16(_mm_slli_epi16(g, 3), _mm_srli_epi16(_mm_mullo_epi16(g, mul), 13));
+		b = _mm_add_epi16(_mm_slli_epi16(b, 3), _mm_srli_epi16(_mm_mullo_epi16(b, mul), 13));
+		__m128i a = hasAlpha ? _mm_and_si128(_mm_srai_epi16(v, 15), opaque) : opaque;
+
+		__m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_packus_epi16(g, g));
+		__m128i ba = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(a, a));
+		_mm_storeu_si128((__m128i*) (out + i*4),      _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128((__m128i*) (out + i*4 + 16), _mm_unpackhi_epi16(rg, ba));
+	}
+#endif
 
-	const int pixelCount = header->width * header->height;
+	for (; i < n; i++)
+	{
+		uint16_t inRGB16 = UnpackU16LE(in + i*2);
+		uint8_t* q = out + i*4;
+		q[0] = Expand5To8((inRGB16 >> 10) & 0b11111);
+		q[1] = Expand5To8((inRGB16 >> 5) & 0b11111);
+		q[2] = Expand5To8((inRGB16 >> 0) & 0b11111);
+		q[3] = (!hasAlpha || (inRGB16 & 0x8000)) ? 0xFF : 0x00;
+	}
+}
+
+static void ConvertRowGray8ToRGBA(const uint8_t* in, uint8_t* out, int n)
+{
+	int i = 0;
 
-	switch (header->bpp)
+#if TGA_NEON
+	for (; i + 16 <= n; i += 16)
 	{
-		case 32:	// Targa source data is BGRA
-		{
-			for (int p = 0; p < pixelCount; p++)
-			{
-				*outPixel = (struct TargetPixel) { .r = in[2], .g = in[1], .b = in[0], .a = in[3] };
-				outPixel++;
-				in += 4;
-			}
-			break;
-		}
+		uint8x16_t gray = vld1q_u8(in + i);
+		uint8x16x4_t rgba = {{ gray, gray, gray, vdupq_n_u8(0xFF) }};
+		vst4q_u8(out + i*4, rgba);
+	}
+#elif TGA_SSE2
+	const __m128i opaque = _mm_set1_epi8((char) 0xFF);
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i gray = _mm_loadu_si128((const __m128i*) (in + i));
+		__m128i gg = _mm_unpacklo_epi8(gray, gray);
+		__m128i ga = _mm_unpacklo_epi8(gray, opaque);
+		_mm_storeu_si128((__m128i*) (out + i*4),      _mm_unpacklo_epi16(gg, ga));
+		_mm_storeu_si128((__m128i*) (out + i*4 + 16), _mm_unpackhi_epi16(gg, ga));
+		gg = _mm_unpackhi_epi8(gray, gray);
+		ga = _mm_unpackhi_epi8(gray, opaque);
+		_mm_storeu_si128((__m128i*) (out + i*4 + 32), _mm_unpacklo_epi16(gg, ga));
+		_mm_storeu_si128((__m128i*) (out + i*4 + 48), _mm_unpackhi_epi16(gg, ga));
+	}
+#endif
 
-		case 24:	// Targa source data is BGR
-		{
-			for (int p = 0; p < pixelCount; p++)
-			{
-				*outPixel = (struct TargetPixel){ .r = in[2], .g = in[1], .b = in[0], .a = 0xFF };
-				outPixel++;
-				in += 3;
-			}
-			break;
-		}
+	for (; i < n; i++)
+	{
+		uint8_t gray = in[i];
+		uint8_t* q = out + i*4;
+		q[0] = gray;
+		q[1] = gray;
+		q[2] = gray;
+		q[3] = 0xFF;
+	}
+}
 
-		case 16:	// Targa source data is A1RGB5 (packed into a little-endian 16-bit word)
-		{
-			const uint16_t* inPtr16 = (const uint16_t*) in;
+// The palette LUT is already in the output pixel layout (BGR or RGBA), so this is a straight lookup.
+static void ConvertRowColormapped(const uint8_t* in, uint8_t* out, int n, const uint8_t* paletteLUT, int paletteColorCount, int outBytesPerPixel)
+{
+	for (int i = 0; i < n; i++)
+	{
+		uint8_t colorIndex = in[i];
 
-			if (header->imageDescriptor & 1)	// 1 alpha + 5-5-5 color
-			{
-				for (int p = 0; p < pixelCount; p++)
-				{
-					uint16_t inRGB16 = UnpackI16LE(inPtr16);
-					outPixel->r = (((inRGB16 >> 10) & 0b11111) * 255) / 31;
-					outPixel->g = (((inRGB16 >> 5) & 0b11111) * 255) / 31;
-					outPixel->b = (((inRGB16 >> 0) & 0b11111) * 255) / 31;
-					outPixel->a = (inRGB16 & 0x8000) ? (0xFF) : (0x00);
-
-					outPixel++;
-					inPtr16++;
-				}
-			}
-			else	// 5-5-5 color without alpha
-			{
-				for (int p = 0; p < pixelCount; p++)
-				{
-					uint16_t inRGB16 = UnpackI16LE(inPtr16);
-					outPixel->r = (((inRGB16 >> 10) & 0b11111) * 255) / 31;
-					outPixel->g = (((inRGB16 >> 5) & 0b11111) * 255) / 31;
-					outPixel->b = (((inRGB16 >> 0) & 0b11111) * 255) / 31;
-					outPixel->a = 0xFF;
-
-					outPixel++;
-					inPtr16++;
-				}
-			}
-			break;
-		}
+		GAME_ASSERT(colorIndex < paletteColorCount);
 
-		case 8:		// Grayscale (note: for 8-bit indexed-color data, call ConvertColormappedToBGR first)
-		{
-			for (int p = 0; p < pixelCount; p++)
-			{
-				uint8_t gray = *in;
-				*outPixel = (struct TargetPixel){ .r = gray, .g = gray, .b = gray, .a = 0xFF };
-				outPixel++;
-				in++;
-			}
-			break;
-		}
+		SDL_memcpy(out, paletteLUT + colorIndex*4, outBytesPerPixel);
+		out += outBytesPerPixel;
+	}
+}
 
+static void ConvertRow(int conversion, const uint8_t* in, uint8_t* out, int n, const TGAHeader* header, const uint8_t* paletteLUT, int paletteColorCount)
+{
+	switch (conversion)
+	{
+		case TGA_ROW_COPY:				BlockMove(in, out, n * (header->bpp / 8));			break;
+		case TGA_ROW_CMAP_TO_BGR:		ConvertRowColormapped(in, out, n, paletteLUT, paletteColorCount, 3);	break;
+		case TGA_ROW_CMAP_TO_RGBA:		ConvertRowColormapped(in, out, n, paletteLUT, paletteColorCount, 4);	break;
+		case TGA_ROW_BGRA32_TO_RGBA:	ConvertRowBGRA32ToRGBA(in, out, n);					break;
+		case TGA_ROW_BGR24_TO_RGBA:		ConvertRowBGR24ToRGBA(in, out, n);					break;
+		case TGA_ROW_RGB5_TO_RGBA:		ConvertRow16ToRGBA(in, out, n, false);				break;
+		case TGA_ROW_A1RGB5_TO_RGBA:	ConvertRow16ToRGBA(in, out, n, true);				break;
+		case TGA_ROW_GRAY8_TO_RGBA:		ConvertRowGray8ToRGBA(in, out, n);					break;
 		default:
-			GAME_ASSERT_MESSAGE(false, "TGA: Unsupported bpp for conversion to RGBA");
+			GAME_ASSERT_MESSAGE(false, "TGA: Unsupported row conversion");
 			break;
 	}
-
-	return converted;
 }
 
-static void FlipPixelData(uint8_t* data, TGAHeader* header)
+#pragma mark - Read
+
+static uint8_t* LoadDataFileBytes(const char* path, long* outSize)
 {
-	int rowBytes = header->width * (header->bpp / 8);
+	FSSpec		spec;
+	short		refNum;
+	long		fileSize = 0;
 
-	uint8_t* topRow = data;
-	uint8_t* bottomRow = topRow + rowBytes * (header->height - 1);
-	uint8_t* topRowCopy = (uint8_t*) AllocPtr(rowBytes);
-	while (topRow < bottomRow)
+	// Look in the asset pack first
+	uint8_t* fileData = (uint8_t*) Pack_LoadFile(path, outSize);
+	if (fileData)
+		return fileData;
+
+	// Otherwise, read the loose file
+	if (noErr != FSMakeFSSpec(gDataSpec.vRefNum, gDataSpec.parID, path, &spec)
+		|| noErr != FSpOpenDF(&spec, fsRdPerm, &refNum))
 	{
-		BlockMove(topRow, topRowCopy, rowBytes);
-		BlockMove(bottomRow, topRow, rowBytes);
-		BlockMove(topRowCopy, bottomRow, rowBytes);
-		topRow += rowBytes;
-		bottomRow -= rowBytes;
+		return nil;
 	}
-	DisposePtr((Ptr) topRowCopy);
+
+	GetEOF(refNum, &fileSize);
+
+	fileData = (uint8_t*) AllocPtr(SDL_max(fileSize, 1));
+	long readCount = fileSize;
+	OSErr err = FSRead(refNum, &readCount, (Ptr) fileData);
+	FSClose(refNum);
+
+	if (err != noErr || readCount != fileSize)
+	{
+		DisposePtr((Ptr) fileData);
+		return nil;
+	}
+
+	*outSize = fileSize;
+	return fileData;
 }
 
 OSErr ReadTGA(const FSSpec* spec, uint8_t** outPtr, TGAHeader* outHeader, bool forceRGBA)
 {
 	short		refNum;
 	OSErr		err;
-	long		readCount;
-	TGAHeader	header;
-	uint8_t*	pixelData;
+	long		fileSize = 0;
 
 	// Open data fork
 	err = FSpOpenDF(spec, fsRdPerm, &refNum);
 	if (err != noErr)
 		return err;
 
+	// Read entire file in one go
+	GetEOF(refNum, &fileSize);
+
+	uint8_t* fileData = (uint8_t*) AllocPtr(SDL_max(fileSize, 1));
+	long readCount = fileSize;
+	err = FSRead(refNum, &readCount, (Ptr) fileData);
+
+	// Close file -- we don't need it anymore
+	FSClose(refNum);
+
+	if (err == noErr && readCount != fileSize)
+		err = eofErr;
+
+	if (err == noErr)
+		err = ParseTGA(fileData, fileSize, outPtr, outHeader, forceRGBA);
+
+	DisposePtr((Ptr) fileData);
+	return err;
+}
+
+OSErr ReadDataTGA(const char* path, uint8_t** outPtr, TGAHeader* outHeader, bool forceRGBA)
+{
+	long fileSize = 0;
+
+	uint8_t* fileData = LoadDataFileBytes(path, &fileSize);
+	if (!fileData)
+		return fnfErr;
+
+	OSErr err = ParseTGA(fileData, fileSize, outPtr, outHeader, forceRGBA);
+	DisposePtr((Ptr) fileData);
+	return err;
+}
+
+// Decodes, converts and flips the image in a single pass:
+// each output row is written exactly once, directly in top-down orientation.
+static OSErr ParseTGA(const uint8_t* fileData, long fileSize, uint8_t** outPtr, TGAHeader* outHeader, bool forceRGBA)
+{
+	TGAHeader	header;
+	uint8_t*	pixelData;
+
+	const uint8_t* in = fileData;
+	const uint8_t* const eof = fileData + fileSize;
+
 	// Read header
-	readCount = sizeof(TGAHeader);
-	err = FSRead(refNum, &readCount, (Ptr) &header);
-	if (err != noErr || readCount != sizeof(TGAHeader))
-	{
-		FSClose(refNum);
-		return err;
-	}
+	if (fileSize < (long) sizeof(TGAHeader))
+		return badFormat;
+
+	SDL_memcpy(&header, in, sizeof(TGAHeader));
+	in += sizeof(TGAHeader);
 
 	// Byteswap it on on big-endian systems (TGA is a little-endian format)
 	UnpackStructs("<8B4H2B", sizeof(TGAHeader), 1, &header);
@@ -235,97 +415,230 @@ OSErr ReadTGA(const FSSpec* spec, uint8_t** outPtr, TGAHeader* outHeader, bool f
 		case TGA_IMAGETYPE_RLE_GRAYSCALE:
 			break;
 		default:
-			FSClose(refNum);
 			return badFormat;
 	}
 
 	// Extract some info from the header
-	Boolean compressed		= header.imageType & 8;
-	Boolean needFlip		= 0 == (header.imageDescriptor & (1u << 5u));
-	long pixelDataLength	= header.width * header.height * (header.bpp / 8);
+	const Boolean compressed		= header.imageType & 8;
+	const Boolean colormapped		= (header.imageType & ~8) == TGA_IMAGETYPE_RAW_CMAP;
+	const Boolean needFlip			= 0 == (header.imageDescriptor & (1u << 5u));
+	const int width					= header.width;
+	const int height				= header.height;
+	const int srcBytesPerPixel		= header.bpp / 8;
+	const long srcRowBytes			= width * srcBytesPerPixel;
 
 	// Ensure there's no identification field -- we don't support that
 	GAME_ASSERT(header.idFieldLength == 0);
 
-	// If there's palette data, load it in
-	uint8_t* palette = nil;
-	if (header.imageType == TGA_IMAGETYPE_RAW_CMAP || header.imageType == TGA_IMAGETYPE_RLE_CMAP)
+	// If there's palette data, turn it into a lookup table in the output pixel layout
+	uint8_t paletteLUT[256 * 4];
+	int paletteColorCount = 0;
+	if (colormapped)
 	{
-		uint16_t paletteColorCount	= header.paletteColorCountLo | ((uint16_t)header.paletteColorCountHi << 8);
-		const long paletteBytes		= paletteColorCount * (header.paletteBitsPerColor / 8);
+		paletteColorCount			= header.paletteColorCountLo | ((uint16_t)header.paletteColorCountHi << 8);
+		const int bytesPerColor		= header.paletteBitsPerColor / 8;
+		const long paletteBytes		= paletteColorCount * bytesPerColor;
 
 		GAME_ASSERT(8 == header.bpp);
+		GAME_ASSERT(3 == bytesPerColor);
 		GAME_ASSERT(header.paletteOriginLo == 0 && header.paletteOriginHi == 0);
 		GAME_ASSERT(paletteColorCount <= 256);
+		GAME_ASSERT(paletteBytes <= eof - in);
+
+		for (int i = 0; i < paletteColorCount; i++)
+		{
+			const uint8_t* bgr = in + i*3;			// TGA stores its palette as BGR!
+			uint8_t* entry = paletteLUT + i*4;
+
+			if (forceRGBA)
+			{
+				entry[0] = bgr[2];
+				entry[1] = bgr[1];
+				entry[2] = bgr[0];
+				entry[3] = 0xFF;
+			}
+			else
+			{
+				entry[0] = bgr[0];
+				entry[1] = bgr[1];
+				entry[2] = bgr[2];
+				entry[3] = 0;
+			}
+		}
 
-		palette = (uint8_t*) AllocPtr(paletteBytes);
+		in += paletteBytes;
 
-		readCount = paletteBytes;
-		FSRead(refNum, &readCount, (Ptr) palette);
-		GAME_ASSERT(readCount == paletteBytes);
+		// Update header to make it a BGR image
+		header.imageType = TGA_IMAGETYPE_RAW_BGR;
+		header.bpp = header.paletteBitsPerColor;
+	}
+
+	// Pick the row conversion
+	int conversion = TGA_ROW_COPY;
+	if (colormapped)
+	{
+		conversion = forceRGBA ? TGA_ROW_CMAP_TO_RGBA : TGA_ROW_CMAP_TO_BGR;
+	}
+	else if (forceRGBA)
+	{
+		switch (header.bpp)
+		{
+			case 32:	conversion = TGA_ROW_BGRA32_TO_RGBA;	break;		// Targa source data is BGRA
+			case 24:	conversion = TGA_ROW_BGR24_TO_RGBA;		break;		// Targa source data is BGR
+			case 16:	conversion = (header.imageDescriptor & 1) ? TGA_ROW_A1RGB5_TO_RGBA : TGA_ROW_RGB5_TO_RGBA;	break;
+			case 8:		conversion = TGA_ROW_GRAY8_TO_RGBA;		break;		// Grayscale
+			default:
+				GAME_ASSERT_MESSAGE(false, "TGA: Unsupported bpp for conversion to RGBA");
+				break;
+		}
 	}
 
+	// Finalize output header
+	header.imageType &= ~8;						// clear compressed bit
+	header.imageDescriptor |= (1u << 5u);		// set top-left origin bit
+	if (forceRGBA)
+	{
+		header.imageType = TGA_IMAGETYPE_CONVERTED_RGBA;
+		header.bpp = 32;
+	}
+
+	const long dstRowBytes = width * (header.bpp / 8);
+
 	// Allocate pixel data
-	pixelData = (uint8_t*) AllocPtr(pixelDataLength);
+	pixelData = (uint8_t*) AllocPtr(SDL_max(dstRowBytes * height, 1));
+
+	// RLE data that needs converting gets decompressed into a scratch row first
+	TGARLEState rle = { .in = in, .eod = eof, .bytesPerPixel = srcBytesPerPixel };
+	uint8_t* scratchRow = nil;
 
-	// Read pixel data; decompress it if needed
 	if (compressed)
 	{
-		DecompressRLE(refNum, &header, pixelData);
-		header.imageType &= ~8;		// flip compressed bit
+		if (conversion != TGA_ROW_COPY)
+			scratchRow = (uint8_t*) AllocPtr(SDL_max(srcRowBytes, 1));
 	}
 	else
 	{
-		readCount = pixelDataLength;
-		err = FSRead(refNum, &readCount, (Ptr) pixelData);
-		GAME_ASSERT(readCount == pixelDataLength);
-		GAME_ASSERT(err == noErr);
+		GAME_ASSERT(srcRowBytes * height <= eof - in);
 	}
 
-	// Close file -- we don't need it anymore
-	FSClose(refNum);
-
-	// If pixel data is stored bottom-up, flip it vertically.
-	if (needFlip)
+	// Process rows in file order, storing each one at its final position
+	for (int y = 0; y < height; y++)
 	{
-		FlipPixelData(pixelData, &header);
+		uint8_t* dstRow = pixelData + (needFlip ? (height - 1 - y) : y) * dstRowBytes;
 
-		// Set top-left origin bit
-		header.imageDescriptor |= (1u << 5u);
+		if (!compressed)
+		{
+			ConvertRow(conversion, in + y * srcRowBytes, dstRow, width, &header, paletteLUT, paletteColorCount);
+		}
+		else if (!scratchRow)
+		{
+			DecompressRLERow(&rle, dstRow, width);
+		}
+		else
+		{
+			DecompressRLERow(&rle, scratchRow, width);
+			ConvertRow(conversion, scratchRow, dstRow, width, &header, paletteLUT, paletteColorCount);
+		}
 	}
 
-	// If the image is color-mapped, map pixel data back to BGR
-	if (palette)
+	GAME_ASSERT(rle.packetPixelsLeft == 0);		// no packet may run past the last pixel
+
+	if (scratchRow)
+		DisposePtr((Ptr) scratchRow);
+
+	// Store result
+	if (outHeader != nil)
+		*outHeader = header;
+	*outPtr = pixelData;
+
+	return noErr;
+}
+
+#pragma mark - Benchmark
+
+typedef struct
+{
+	int			numFiles;
+	uint64_t	numPixels;
+	Uint64		ticks;
+} TGABenchmarkStats;
+
+static void BenchmarkTGAFile(const char* path, TGABenchmarkStats* stats)
+{
+	long fileSize = 0;
+	uint8_t* fileData = LoadDataFileBytes(path, &fileSize);
+	if (!fileData)
+		return;
+
+	uint8_t imageType = fileSize > 2 ? fileData[2] : 0;
+	GAME_ASSERT(imageType <= TGA_IMAGETYPE_RLE_GRAYSCALE);
+	stats += imageType;
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for (int pass = 0; pass < BENCHMARK_TGA_PASSES; pass++)
 	{
-		uint8_t* remapped = ConvertColormappedToBGR(pixelData, &header, palette);
+		uint8_t* pixelData = nil;
+		TGAHeader header;
 
-		DisposePtr((Ptr) palette);
-		palette = nil;
+		OSErr err = ParseTGA(fileData, fileSize, &pixelData, &header, true);
+		GAME_ASSERT(err == noErr);
+
+		if (pass == 0)
+			stats->numPixels += header.width * header.height;
 
 		DisposePtr((Ptr) pixelData);
-		pixelData = remapped;
+	}
+	stats->ticks += SDL_GetPerformanceCounter() - start;
+	stats->numFiles++;
 
-		// Update header to make it an BGR image
-		header.imageType = TGA_IMAGETYPE_RAW_BGR;
-		header.bpp = header.paletteBitsPerColor;
+	DisposePtr((Ptr) fileData);
+}
+
+// Times ParseTGA over every TGA in Data/Images and logs the throughput per image type.
+// Files are loaded up front so that only decoding is measured.
+void BenchmarkTGADecoding(void)
+{
+	TGABenchmarkStats stats[TGA_IMAGETYPE_RLE_GRAYSCALE + 1];
+	char path[128];
+
+	SDL_memset(stats, 0, sizeof(stats));
+
+	for (int id = 0; id < 10000; id++)
+	{
+		SDL_snprintf(path, sizeof(path), ":Images:Textures:%d.tga", id);
+		BenchmarkTGAFile(path, stats);
 	}
 
-	// Convert to RGBA if required
-	if (forceRGBA)
+	for (int id = 0; id < 1000; id++)
 	{
-		uint8_t* converted = ConvertToRGBA(pixelData, &header);
+		SDL_snprintf(path, sizeof(path), ":Images:Infobar:%d.tga", id);
+		BenchmarkTGAFile(path, stats);
+	}
 
-		header.imageType = TGA_IMAGETYPE_CONVERTED_RGBA;
-		header.bpp = 32;
+	BenchmarkTGAFile(":Images:Infobar:NitroGauge.tga", stats);
 
-		DisposePtr((Ptr) pixelData);
-		pixelData = converted;
+			/* REPORT */
+
+	const double freq = (double) SDL_GetPerformanceFrequency();
+	int totalFiles = 0;
+	uint64_t totalPixels = 0;
+	Uint64 totalTicks = 0;
+
+	for (int type = 0; type <= TGA_IMAGETYPE_RLE_GRAYSCALE; type++)
+	{
+		if (!stats[type].numFiles)
+			continue;
+
+		double seconds = stats[type].ticks / freq / BENCHMARK_TGA_PASSES;
+		SDL_Log("TGA type %2d: %3d files, %8.3f ms, %7.1f Mpix/s",
+				type, stats[type].numFiles, seconds * 1000.0, stats[type].numPixels / seconds / 1e6);
+
+		totalFiles	+= stats[type].numFiles;
+		totalPixels	+= stats[type].numPixels;
+		totalTicks	+= stats[type].ticks;
 	}
 
-	// Store result
-	if (outHeader != nil)
-		*outHeader = header;
-	*outPtr = pixelData;
-	
-	return noErr;
+	double seconds = totalTicks / freq / BENCHMARK_TGA_PASSES;
+	SDL_Log("TGA total:   %3d files, %8.3f ms, %7.1f Mpix/s (average of %d passes, RGBA output)",
+			totalFiles, seconds * 1000.0, seconds > 0 ? totalPixels / seconds / 1e6 : 0.0, BENCHMARK_TGA_PASSES);
 }
@@ -139,7 +139,7 @@ void DisposeFences(void)
 	{
 		if (gFenceTypeTextures[i])
 		{
-			glDeleteTextures(1, &gFenceTypeTextures[i]);
+			Render_DeleteTextures(1, &gFenceTypeTextures[i]);
 			gFenceTypeTextures[i] = 0;
 		}
 	}
@@ -12,6 +12,24 @@
 #include "game.h"
 
 
+/****************************/
+/*    TYPES                 */
+/****************************/
+
+typedef struct
+{
+	float	minY[MAX_LAYERS];
+	float	maxY[MAX_LAYERS];
+} TerrainQuadtreeNode;
+
+typedef struct
+{
+	long		top, bottom, left, right;			// supertile rows/cols to consider (inclusive/exclusive)
+	float		fogEndDistance;						// 0 if fully fogged supertiles must still be drawn
+	TQ3Point3D	cameraCoord;
+} TerrainCullInfo;
+
+
 /****************************/
 /*  PROTOTYPES             */
 /****************************/
@@ -23,6 +41,8 @@ static void ScrollTerrainRight(long superCol, long superRow, long tileCol, long
 static short GetFreeSuperTileMemory(void);
 static inline void ReleaseSuperTileObject(int32_t superTileNum);
 static void CalcNewItemDeleteWindow(void);
+static void PrefetchSuperTiles(float dx, float dz);
+static void ReleaseStalePrefetchedSuperTiles(void);
 static short	BuildTerrainSuperTile(long	startCol, long startRow);
 static Boolean IsSuperTileVisible(int32_t superTileNum, Byte layer);
 static void DrawTileIntoMipmap(uint16_t tile, int row, int col, uint16_t* buffer);
@@ -31,6 +51,22 @@ static void	ShrinkSuperTileTextureMap(const u_short *srcPtr,u_short *destPtr);
 static void ShrinkHalf(const uint16_t* input, uint16_t* output, int outputSize);
 static inline void ReleaseAllSuperTiles(void);
 static void BuildSuperTileLOD(SuperTileMemoryType *superTilePtr, short lod);
+static void BuildTerrainGeometry(const TQ3Param2D* uvs, int numLayers);
+static void DisposeTerrainGeometry(void);
+static void BakeTerrainLighting(int numLayers);
+static void SetupTerrainTextureDetail(void);
+static long CalcSupertileBudget(int range);
+static size_t CalcTerrainMemoryUsage(long numSlots);
+static int FitSuperTileActiveRangeToBudget(int range);
+static void ResizeSuperTilePool(long newBudget);
+static void AllocSuperTileSlot(SuperTileMemoryType* superTile);
+static void FreeSuperTileSlot(SuperTileMemoryType* superTile);
+static void ApplySuperTileActiveRangeToView(void);
+static void BuildTerrainQuadtree(int numLayers);
+static void DisposeTerrainQuadtree(void);
+static void CullTerrainQuadtreeNode(int level, long nodeRow, long nodeCol, int layer, const TerrainCullInfo* cull);
+static void SubmitSuperTile(int32_t superTileNum, int layer, const TQ3Point3D* cameraCoord);
+static void BuildSuperTileGeometry(long startCol, long startRow, int layer, SuperTileGeometryType* geom);
 
 
 /****************************/
@@ -40,6 +76,12 @@ static void BuildSuperTileLOD(SuperTileMemoryType *superTilePtr, short lod);
 #define	ITEM_WINDOW		1			// # supertiles for item add window (must be integer)
 #define	OUTER_SIZE		0.6f		// size of border out of add window for delete window (can be float)
 
+#define	PREFETCH_LOOKAHEAD_TIME		0.6f	// how many seconds ahead of the camera we predict the active area
+#define	PREFETCH_TIME_BUDGET_MS		2.0f	// max time per frame spent building supertiles ahead of time
+#define	MAX_PREFETCHED_SUPERTILES	(MAX_SUPERTILES_WIDE + MAX_SUPERTILES_DEEP)
+
+#define	MAX_TERRAIN_QUADTREE_LEVELS	8		// enough for MAX_SUPERTILES_WIDE/DEEP (80 -> 40 -> 20 -> 10 -> 5 -> 3 -> 2 -> 1)
+
 #define TILE_TEXTURE_INTERNAL_FORMAT	GL_RGB
 #define TILE_TEXTURE_FORMAT				GL_BGRA_EXT
 #define TILE_TEXTURE_TYPE				GL_UNSIGNED_SHORT_1_5_5_5_REV
@@ -53,12 +95,10 @@ static int		gTerrainTextureDetail = SUPERTILE_DETAIL_BEST;
 int				gSuperTileActiveRange;
 
 Boolean			gDoCeiling;
-Boolean			gDisableHiccupTimer = false;
+Boolean			gPrimingTerrain = false;						// supertiles are drawn even if their texture upload is pending
 
 static int		gNumLODs = 0;
 
-static u_char	gHiccupEliminator = 0;
-
 u_short	**gTileDataHandle;
 
 u_short	**gFloorMap = nil;								// 2 dimensional array of u_shorts (allocated below)
@@ -77,7 +117,8 @@ int32_t	gTerrainScrollBuffer[MAX_SUPERTILES_DEEP][MAX_SUPERTILES_WIDE];		// 2D a
 
 long	gNumFreeSupertiles = 0;
 long	gSupertileBudget = 0;
-static	SuperTileMemoryType		gSuperTileMemoryList[MAX_SUPERTILES];
+static	SuperTileMemoryType*	gSuperTileMemoryList = nil;				// pool of supertile slots (grows & shrinks with the active range)
+static	long					gSuperTileMemoryListCapacity = 0;
 Boolean gSuperTileMemoryListExists = false;
 
 float	gTerrainItemDeleteWindow_Near,gTerrainItemDeleteWindow_Far,
@@ -87,6 +128,26 @@ static int		gTextureSizePerLOD[MAX_LODS] = { 0, 0, 0 };
 
 static RenderModifiers gTerrainRenderMods;
 
+static struct
+{
+	long	row;
+	long	col;
+}								gPrefetchedSuperTiles[MAX_PREFETCHED_SUPERTILES];	// supertiles built outside the active area
+static int						gNumPrefetchedSuperTiles = 0;
+
+static TQ3Point3D				gPrevStreamCameraCoord;
+static Boolean					gHasPrevStreamCameraCoord = false;
+
+static TQ3TriMeshData*			gTerrainGeometry = nil;			// static geometry for the entire map (floor & ceiling)
+static RenderVertexBuffer*		gTerrainVertexBuffer = nil;		// GPU copy of gTerrainGeometry
+static SuperTileGeometryType*	gSuperTileGeometry = nil;		// one per supertile in map: [superRow * gNumSuperTilesWide + superCol]
+static TerrainQuadtreeNode*		gTerrainQuadtree[MAX_TERRAIN_QUADTREE_LEVELS];		// Y extents of supertile blocks, level 0 = single supertiles
+static long						gTerrainQuadtreeWidth[MAX_TERRAIN_QUADTREE_LEVELS];
+static long						gTerrainQuadtreeDepth[MAX_TERRAIN_QUADTREE_LEVELS];
+static int						gNumTerrainQuadtreeLevels = 0;
+static TQ3Vector3D**			gTerrainVertexNormals[MAX_LAYERS] = { nil, nil };	// baked vertex normals for entire map [row][col]
+static TQ3ColorRGBA**			gTerrainVertexLighting[MAX_LAYERS] = { nil, nil };	// baked lit vertex colors for entire map [row][col]
+
 			/* TILE SPLITTING TABLES */
 			
 					
@@ -201,7 +262,8 @@ long	row,col;
 		for (col = 0; col < MAX_SUPERTILES_WIDE; col++)
 			gTerrainScrollBuffer[row][col] = EMPTY_SUPERTILE;
 			
-	gHiccupEliminator = 0;
+	gNumPrefetchedSuperTiles = 0;
+	gHasPrevStreamCameraCoord = false;
 }
 
 
@@ -305,23 +367,9 @@ int	i;
 void CreateSuperTileMemoryList(void)
 {
 long							u,v,i,numLayers;
-static 	TQ3TriMeshTriangleData	newTriangle[NUM_TRIS_IN_SUPERTILE];
 static	TQ3Param2D				uvs[NUM_VERTICES_IN_SUPERTILE];
 
 
-
-	gSupertileBudget = gSuperTileActiveRange * gSuperTileActiveRange * 4;		// calc # supertiles we will need
-
-	long upperBound = gNumSuperTilesDeep * gNumSuperTilesWide;					// if we have the budget to show the entire map at once,
-	if (gSupertileBudget > upperBound)											// cap supertile budget to # of supertiles in map
-		gSupertileBudget = upperBound;
-
-	GAME_ASSERT(gSupertileBudget <= MAX_SUPERTILES);
-
-#if _DEBUG
-	SDL_Log("Supertile budget: %ld\n", gSupertileBudget);
-#endif
-
 	if (gDoCeiling)
 		numLayers = 2;
 	else
@@ -330,7 +378,97 @@ static	TQ3Param2D				uvs[NUM_VERTICES_IN_SUPERTILE];
 
 			/* PREPARE TEXTURE DETAIL CONSTANTS ACCORDING TO USER PREFS */
 
-	// Fill out gNumLODs and textureSize[] according to user pref for texture detail (source port addition)
+	SetupTerrainTextureDetail();
+
+	
+			/* INIT UV LIST */
+	
+	i = 0;	
+	if (gTerrainTextureDetail == SUPERTILE_DETAIL_SEAMLESS)
+	{
+		for (v = 0; v <= SUPERTILE_SIZE; v++)						// sets uv's 0.0 -> 1.0 for single texture map
+		{
+			for (u = 0; u <= SUPERTILE_SIZE; u++)
+			{
+				uvs[i].u = (1.0f + u) / (2.0f + SUPERTILE_SIZE);
+				uvs[i].v = (1.0f + v) / (2.0f + SUPERTILE_SIZE);
+				i++;
+			}	
+		}
+	}
+	else
+	{
+		for (v = 0; v <= SUPERTILE_SIZE; v++)						// sets uv's 0.0 -> 1.0 for single texture map
+		{
+			for (u = 0; u <= SUPERTILE_SIZE; u++)
+			{
+				uvs[i].u = (float)u / (float)SUPERTILE_SIZE;
+				uvs[i].v = (float)v / (float)SUPERTILE_SIZE;
+				i++;
+			}	
+		}
+	}
+
+
+			/*********************************************/
+			/* BUILD STATIC GEOMETRY FOR THE ENTIRE MAP  */
+			/*********************************************/
+
+	BuildTerrainGeometry(uvs, numLayers);
+
+
+			/**********************************************/
+			/* FIT ACTIVE RANGE IN BUDGET & ALLOC THE POOL */
+			/**********************************************/
+			//
+			// The level's view distance was set up by InitArea. If we can't afford it,
+			// shrink it and pull in the yon & fog accordingly.
+			//
+
+	int range = FitSuperTileActiveRangeToBudget(gSuperTileActiveRange);
+	if (range != gSuperTileActiveRange)
+	{
+		gSuperTileActiveRange = range;
+		ApplySuperTileActiveRangeToView();
+	}
+
+	ResizeSuperTilePool(CalcSupertileBudget(gSuperTileActiveRange));
+
+	gSuperTileMemoryListExists = true;
+}
+
+
+/********************* DISPOSE SUPERTILE MEMORY LIST **********************/
+
+void DisposeSuperTileMemoryList(void)
+{
+	if (gSuperTileMemoryListExists == false)
+		return;
+
+	ClearScrollBuffer();
+	ReleaseAllSuperTiles();
+	ResizeSuperTilePool(0);												// free all supertile slots
+
+	if (gSuperTileMemoryList)
+	{
+		DisposePtr((Ptr) gSuperTileMemoryList);
+		gSuperTileMemoryList = nil;
+		gSuperTileMemoryListCapacity = 0;
+	}
+
+	DisposeTerrainGeometry();
+
+	gSuperTileMemoryListExists = false;
+}
+
+
+/*************** SETUP TERRAIN TEXTURE DETAIL ******************/
+//
+// Fill out gNumLODs and textureSize[] according to user pref for texture detail (source port addition)
+//
+
+static void SetupTerrainTextureDetail(void)
+{
 	gTerrainTextureDetail = gGamePrefs.lowDetail
 		? SUPERTILE_DETAIL_WORST
 		: SUPERTILE_DETAIL_BEST;
@@ -367,183 +505,558 @@ retryParseLODPref:
 		gTerrainTextureDetail = SUPERTILE_DETAIL_BEST;
 		goto retryParseLODPref;
 	}
+}
 
 
-	
-			/* INIT UV LIST */
-	
-	i = 0;	
-	if (gTerrainTextureDetail == SUPERTILE_DETAIL_SEAMLESS)
+#pragma mark -
+
+/****************** CALC SUPERTILE BUDGET ********************/
+//
+// Returns the # of supertile slots needed for the given active range
+// (active area + room to prefetch a row & a col).
+//
+
+static long CalcSupertileBudget(int range)
+{
+	long budget = (range*2 + SUPERTILE_PREFETCH_MARGIN) * (range*2 + SUPERTILE_PREFETCH_MARGIN);
+
+	long upperBound = gNumSuperTilesDeep * gNumSuperTilesWide;					// if we have the budget to show the entire map at once,
+	if (budget > upperBound)													// cap supertile budget to # of supertiles in map
+		budget = upperBound;
+
+	return budget;
+}
+
+
+/**************** CALC TERRAIN MEMORY USAGE *********************/
+//
+// Estimates how many bytes of texture & geometry memory the terrain needs with the given
+// # of supertile slots. Everything is counted twice: once for the CPU copy, once for the GPU copy.
+//
+
+static size_t CalcTerrainMemoryUsage(long numSlots)
+{
+	int numLayers = gDoCeiling? 2: 1;
+
+	size_t bytesPerSlot = 0;
+	for (int lod = 0; lod < gNumLODs; lod++)
+		bytesPerSlot += gTextureSizePerLOD[lod] * gTextureSizePerLOD[lod] * sizeof(uint16_t);
+	bytesPerSlot *= numLayers;
+
+	size_t geometryBytes = 0;
+	if (gTerrainGeometry)
 	{
-		for (v = 0; v <= SUPERTILE_SIZE; v++)						// sets uv's 0.0 -> 1.0 for single texture map
+		geometryBytes += gTerrainGeometry->numPoints * (sizeof(TQ3Point3D) + sizeof(TQ3Vector3D) + sizeof(TQ3Param2D) + sizeof(TQ3ColorRGBA));
+		geometryBytes += gTerrainGeometry->numTriangles * sizeof(TQ3TriMeshTriangleData);
+	}
+
+	return 2 * (geometryBytes + numSlots * bytesPerSlot);
+}
+
+
+/************** FIT SUPERTILE ACTIVE RANGE TO BUDGET ******************/
+//
+// Returns the largest active range up to the requested one whose terrain textures & geometry
+// (CPU + GPU) fit in the memory budget for the current detail level.
+//
+
+static int FitSuperTileActiveRangeToBudget(int range)
+{
+	const size_t memoryBudget = gGamePrefs.lowDetail ? TERRAIN_MEMORY_BUDGET_LOW : TERRAIN_MEMORY_BUDGET_HIGH;
+
+	if (range > MAX_SUPERTILE_ACTIVE_RANGE)
+		range = MAX_SUPERTILE_ACTIVE_RANGE;
+
+	while (range > MIN_SUPERTILE_ACTIVE_RANGE
+		&& CalcTerrainMemoryUsage(CalcSupertileBudget(range)) > memoryBudget)
+	{
+		range--;
+	}
+
+	if (range < MIN_SUPERTILE_ACTIVE_RANGE)
+		range = MIN_SUPERTILE_ACTIVE_RANGE;
+
+	return range;
+}
+
+
+/****************** RESIZE SUPERTILE POOL ********************/
+//
+// Grows or shrinks the pool of supertile slots (and their textures).
+// All supertiles must have been released beforehand.
+//
+
+static void ResizeSuperTilePool(long newBudget)
+{
+	GAME_ASSERT(gNumFreeSupertiles == gSupertileBudget);
+
+			/* GROW THE ARRAY IF NEEDED */
+
+	if (newBudget > gSuperTileMemoryListCapacity)
+	{
+		SuperTileMemoryType* newList = (SuperTileMemoryType*) NewPtrClear(newBudget * sizeof(SuperTileMemoryType));
+		GAME_ASSERT(newList);
+
+		if (gSuperTileMemoryList)
 		{
-			for (u = 0; u <= SUPERTILE_SIZE; u++)
-			{
-				uvs[i].u = (1.0f + u) / (2.0f + SUPERTILE_SIZE);
-				uvs[i].v = (1.0f + v) / (2.0f + SUPERTILE_SIZE);
-				i++;
-			}	
+			SDL_memcpy(newList, gSuperTileMemoryList, gSupertileBudget * sizeof(SuperTileMemoryType));
+			DisposePtr((Ptr) gSuperTileMemoryList);
 		}
+
+		gSuperTileMemoryList = newList;
+		gSuperTileMemoryListCapacity = newBudget;
 	}
-	else
+
+			/* ALLOC NEW SLOTS */
+
+	for (long i = gSupertileBudget; i < newBudget; i++)
+		AllocSuperTileSlot(&gSuperTileMemoryList[i]);
+
+			/* FREE EXCESS SLOTS */
+
+	for (long i = newBudget; i < gSupertileBudget; i++)
+		FreeSuperTileSlot(&gSuperTileMemoryList[i]);
+
+	gSupertileBudget = newBudget;
+	gNumFreeSupertiles = newBudget;
+
+#if _DEBUG
+	SDL_Log("Supertile budget: %ld (range %d, ~%zu KB)\n",
+			gSupertileBudget, gSuperTileActiveRange, CalcTerrainMemoryUsage(gSupertileBudget) / 1024);
+#endif
+}
+
+
+/****************** ALLOC SUPERTILE SLOT ********************/
+
+static void AllocSuperTileSlot(SuperTileMemoryType* superTile)
+{
+	int numLayers = gDoCeiling? 2: 1;
+
+	SDL_memset(superTile, 0, sizeof(*superTile));
+	superTile->mode = SUPERTILE_MODE_FREE;										// it's free for use
+
+			/**************************************/
+			/* CREATE TEXTURE FOR FLOOR & CEILING */
+			/**************************************/
+
+	for (int layer = 0; layer < numLayers; layer++)								// do it for floor & ceiling
 	{
-		for (v = 0; v <= SUPERTILE_SIZE; v++)						// sets uv's 0.0 -> 1.0 for single texture map
+			/*****************************/
+			/* DO OUR OWN FAUX-LOD THING */
+			/*****************************/
+			//
+			// Normally there are 3 LOD's, but if we are low on memory, then we'll skip LOD #0 which
+			// is the big one, and only do the other 2 smaller ones.
+			//
+
+		for (int lod = 0; lod < gNumLODs; lod++)
 		{
-			for (u = 0; u <= SUPERTILE_SIZE; u++)
-			{
-				uvs[i].u = (float)u / (float)SUPERTILE_SIZE;
-				uvs[i].v = (float)v / (float)SUPERTILE_SIZE;
-				i++;
-			}	
+			int size = gTextureSizePerLOD[lod];									// get size of texture @ this lod
+			GAME_ASSERT_MESSAGE(size >= 0, "gTextureSizePerLOD not initialized!");
+
+					/* MAKE BLANK TEXTURE */
+
+			superTile->textureData[layer][lod] = (uint16_t*) NewPtrClear(size * size * sizeof(uint16_t));	// alloc memory for texture
+			GAME_ASSERT(superTile->textureData[layer][lod]);
+
+			superTile->glTextureName[layer][lod] = Render_LoadTexture(			// create blank texture (filled in when the supertile is built)
+					TILE_TEXTURE_INTERNAL_FORMAT,
+					size,
+					size,
+					TILE_TEXTURE_FORMAT,
+					TILE_TEXTURE_TYPE,
+					nil,
+					kRendererTextureFlags_ClampBoth
+			);
+			CHECK_GL_ERROR();
+			GAME_ASSERT(superTile->glTextureName[layer][lod]);
 		}
+
+		superTile->triMeshDataPtrs[layer] = nil;								// set when the supertile is built
 	}
+}
 
 
-#if 0
-		/* INIT COLOR LIST */
-		
-	i = 0;	
-	for (v = 0; v <= SUPERTILE_SIZE; v++)						// sets uv's 0.0 -> 1.0 for single texture map
+/****************** FREE SUPERTILE SLOT ********************/
+
+static void FreeSuperTileSlot(SuperTileMemoryType* superTile)
+{
+	for (int layer = 0; layer < MAX_LAYERS; layer++)
 	{
-		for (u = 0; u <= SUPERTILE_SIZE; u++)
+			/* NUKE TEXTURES */
+
+		for (int lod = 0; lod < MAX_LODS; lod++)
 		{
-			vertexColors[i].r = 1;
-			vertexColors[i].g = 1;
-			vertexColors[i].b = 1;
-			i++;
-		}	
+			if (superTile->textureData[layer][lod])
+			{
+				DisposePtr((Ptr) superTile->textureData[layer][lod]);
+				superTile->textureData[layer][lod] = nil;
+			}
+
+			if (superTile->glTextureName[layer][lod])
+			{
+				Render_DeleteTextures(1, &superTile->glTextureName[layer][lod]);
+				superTile->glTextureName[layer][lod] = 0;
+			}
+
+			superTile->hasLOD[lod] = false;
+		}
+
+		superTile->triMeshDataPtrs[layer] = nil;								// trimesh is a view into the static geometry
 	}
-#endif
+}
 
-			/********************************************/
-			/* FOR EACH POSSIBLE SUPERTILE ALLOC MEMORY */
-			/********************************************/
 
-	gNumFreeSupertiles = 0;
+/****************** GET VIEW FOR SUPERTILE ACTIVE RANGE ********************/
+//
+// Returns the yon distance & cyclorama scale that go with an active range.
+// Ranges up to 5 keep the original game's values.
+//
 
-	for (i = 0; i < gSupertileBudget; i++)
+void GetViewForSuperTileActiveRange(int range, float* yon, float* cycScale)
+{
+	if (range < 5)
+	{
+		*yon = YON_DISTANCE;
+		*cycScale = 50;
+	}
+	else
 	{
-		SuperTileMemoryType* superTile = &gSuperTileMemoryList[i];
+		*yon = YON_DISTANCE + 1700 + (range - 5) * TERRAIN_SUPERTILE_UNIT_SIZE;	// see further for every extra supertile
+		*cycScale = 81 * *yon / (YON_DISTANCE + 1700);							// push the cyc back as much
+	}
+}
+
+
+/****************** APPLY SUPERTILE ACTIVE RANGE TO VIEW ********************/
+//
+// Updates the camera's yon, the fog and the cyclorama after the active range changed.
+//
+
+static void ApplySuperTileActiveRangeToView(void)
+{
+	GetViewForSuperTileActiveRange(gSuperTileActiveRange, &gCurrentYon, &gCycScale);
+
+	if (!gGameViewInfoPtr)
+		return;
+
+	gGameViewInfoPtr->yon = gCurrentYon;
+
+	if (gGameViewInfoPtr->lightList.useFog)
+	{
+		Render_SetFogRange(
+				gGameViewInfoPtr->yon,
+				gGameViewInfoPtr->lightList.fogStart,
+				gGameViewInfoPtr->lightList.fogEnd);
+	}
+
+	if (gCyclorama)
+	{
+		gCyclorama->Scale.x = gCyclorama->Scale.y = gCyclorama->Scale.z = gCycScale;
+		UpdateObjectTransforms(gCyclorama);
+	}
+}
 
-		superTile->mode = SUPERTILE_MODE_FREE;									// it's free for use
-		gNumFreeSupertiles++;
 
-				/************************************************/
-				/* CREATE TEXTURE & TRIMESH FOR FLOOR & CEILING */
-				/************************************************/
+/****************** SET SUPERTILE ACTIVE RANGE ********************/
+//
+// Changes the view distance in the middle of a level.
+// The supertile pool grows or shrinks to match (within the memory budget),
+// and the terrain around the camera is rebuilt.
+//
 
-		for (int layer = 0; layer < numLayers; layer++)							// do it for floor & ceiling trimeshes
+void SetSuperTileActiveRange(int range)
+{
+	if (!gSuperTileMemoryListExists)
+	{
+		gSuperTileActiveRange = range;
+		return;
+	}
+
+	range = FitSuperTileActiveRangeToBudget(range);
+	if (range == gSuperTileActiveRange)
+		return;
+
+			/* FLUSH THE ACTIVE AREA */
+
+	ClearScrollBuffer();
+	ReleaseAllSuperTiles();
+
+			/* RESIZE THE POOL */
+
+	gSuperTileActiveRange = range;
+	ResizeSuperTilePool(CalcSupertileBudget(range));
+	ApplySuperTileActiveRangeToView();
+
+			/* REBUILD TERRAIN AROUND CAMERA */
+
+	long dummy1, dummy2;
+	long x = gGameViewInfoPtr->currentCameraCoords.x - (SUPERTILE_ACTIVE_RANGE*SUPERTILE_SIZE*TERRAIN_POLYGON_SIZE);
+	long z = gGameViewInfoPtr->currentCameraCoords.z - (SUPERTILE_ACTIVE_RANGE*SUPERTILE_SIZE*TERRAIN_POLYGON_SIZE);
+	GetSuperTileInfo(x, z, &gCurrentSuperTileCol, &gCurrentSuperTileRow, &dummy1, &dummy2);
+
+	PrimeInitialTerrain(true);
+}
+
+/****************** BUILD TERRAIN GEOMETRY *********************/
+//
+// Builds the vertices, normals, lighting & triangles of every supertile in the map
+// into a single level-wide trimesh, which is then uploaded to the GPU once.
+//
+// Each supertile layer gets its own block of vertices (borders are duplicated since
+// UVs are local to each supertile), so a supertile is drawn as a view into that mesh.
+//
+
+static void BuildTerrainGeometry(const TQ3Param2D* uvs, int numLayers)
+{
+	long numSuperTiles = gNumSuperTilesDeep * gNumSuperTilesWide;
+	long numBlocks = numSuperTiles * numLayers;
+
+	GAME_ASSERT(gTerrainGeometry == nil);
+	GAME_ASSERT(gSuperTileGeometry == nil);
+
+	gTerrainGeometry = Q3TriMeshData_New(
+			numBlocks * NUM_TRIS_IN_SUPERTILE,
+			numBlocks * NUM_VERTICES_IN_SUPERTILE,
+			kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals | kQ3TriMeshDataFeatureVertexColors
+	);
+	GAME_ASSERT(gTerrainGeometry);
+
+	gSuperTileGeometry = (SuperTileGeometryType*) NewPtrClear(numSuperTiles * sizeof(SuperTileGeometryType));
+	GAME_ASSERT(gSuperTileGeometry);
+
+	BakeTerrainLighting(numLayers);
+
+	long block = 0;
+
+	for (long superRow = 0; superRow < gNumSuperTilesDeep; superRow++)
+	{
+		for (long superCol = 0; superCol < gNumSuperTilesWide; superCol++)
 		{
-				/*****************************/
-				/* DO OUR OWN FAUX-LOD THING */
-				/*****************************/
-				//
-				// Normally there are 3 LOD's, but if we are low on memory, then we'll skip LOD #0 which
-				// is the big one, and only do the other 2 smaller ones.
-				//
+			SuperTileGeometryType* geom = &gSuperTileGeometry[superRow * gNumSuperTilesWide + superCol];
 
-			for (int lod = 0; lod < gNumLODs; lod++)
+			for (int layer = 0; layer < numLayers; layer++)
 			{
-				int size = gTextureSizePerLOD[lod];								// get size of texture @ this lod
-				GAME_ASSERT_MESSAGE(size >= 0, "gTextureSizePerLOD not initialized!");
-
-						/* MAKE BLANK TEXTURE */
-
-				superTile->textureData[layer][lod] = (uint16_t*) NewPtrClear(size * size * sizeof(uint16_t));	// alloc memory for texture
-				GAME_ASSERT(superTile->textureData[layer][lod]);
-
-				superTile->glTextureName[layer][lod] = Render_LoadTexture(		// create texture from buffer
-						TILE_TEXTURE_INTERNAL_FORMAT,
-						size,
-						size,
-						TILE_TEXTURE_FORMAT,
-						TILE_TEXTURE_TYPE,
-						superTile->textureData[layer][lod],
-						kRendererTextureFlags_ClampBoth
-				);
-				CHECK_GL_ERROR();
-				GAME_ASSERT(superTile->glTextureName[layer][lod]);
+						/* POINT THE VIEW AT ITS BLOCK IN THE LEVEL-WIDE MESH */
+
+				TQ3TriMeshData* tmd = &geom->mesh[layer];
+
+				tmd->numTriangles		= NUM_TRIS_IN_SUPERTILE;
+				tmd->triangles			= &gTerrainGeometry->triangles[block * NUM_TRIS_IN_SUPERTILE];
+				tmd->numPoints			= NUM_VERTICES_IN_SUPERTILE;
+				tmd->points				= &gTerrainGeometry->points[block * NUM_VERTICES_IN_SUPERTILE];
+				tmd->vertexNormals		= &gTerrainGeometry->vertexNormals[block * NUM_VERTICES_IN_SUPERTILE];
+				tmd->vertexUVs			= &gTerrainGeometry->vertexUVs[block * NUM_VERTICES_IN_SUPERTILE];
+				tmd->vertexColors		= &gTerrainGeometry->vertexColors[block * NUM_VERTICES_IN_SUPERTILE];
+				tmd->hasVertexNormals	= true;
+				tmd->hasVertexColors	= true;
+				tmd->texturingMode		= kQ3TexturingModeOpaque;
+				tmd->diffuseColor		= (TQ3ColorRGBA) {1,1,1,1};
+				tmd->bBox.isEmpty		= kQ3False;
+
+				SDL_memcpy(tmd->vertexUVs, uvs, sizeof(tmd->vertexUVs[0]) * NUM_VERTICES_IN_SUPERTILE);
+
+				BuildSuperTileGeometry(superCol * SUPERTILE_SIZE, superRow * SUPERTILE_SIZE, layer, geom);
+
+				block++;
 			}
+		}
+	}
 
-				/* CREATE AN EMPTY TRIMESH STRUCTURE */
+	GAME_ASSERT(block == numBlocks);
 
-			TQ3TriMeshData* tmd = Q3TriMeshData_New(
-					NUM_TRIS_IN_SUPERTILE,
-					NUM_VERTICES_IN_SUPERTILE,
-					kQ3TriMeshDataFeatureVertexUVs | kQ3TriMeshDataFeatureVertexNormals | kQ3TriMeshDataFeatureVertexColors
-			);
-			GAME_ASSERT(tmd);
+	BuildTerrainQuadtree(numLayers);
 
-			_Static_assert(sizeof(uvs) == sizeof(tmd->vertexUVs[0]) * NUM_VERTICES_IN_SUPERTILE, "supertile UV array size mismatch");
 
-			SDL_memcpy(tmd->triangles,		newTriangle,	sizeof(tmd->triangles[0]) * NUM_TRIS_IN_SUPERTILE);
-			SDL_memcpy(tmd->vertexUVs,		uvs,			sizeof(tmd->vertexUVs[0]) * NUM_VERTICES_IN_SUPERTILE);
+			/* UPLOAD IT */
 
-			tmd->bBox.isEmpty = kQ3False;										// calc bounding box
-			tmd->bBox.min.x = tmd->bBox.min.y = tmd->bBox.min.z = 0;
-			tmd->bBox.max.x = tmd->bBox.max.y = tmd->bBox.max.z = TERRAIN_SUPERTILE_UNIT_SIZE;
+	gTerrainVertexBuffer = Render_NewVertexBuffer(gTerrainGeometry);
+	GAME_ASSERT(gTerrainVertexBuffer);
 
-			tmd->glTextureName = gSuperTileMemoryList[i].glTextureName[layer][0];	// set LOD 0 texture by default
-			tmd->texturingMode = kQ3TexturingModeOpaque;
+	gTerrainRenderMods.vertexBuffer = gTerrainVertexBuffer;
+}
 
-			gSuperTileMemoryList[i].triMeshDataPtrs[layer] = tmd;
-		}
+
+/****************** DISPOSE TERRAIN GEOMETRY *********************/
+
+static void DisposeTerrainGeometry(void)
+{
+	gTerrainRenderMods.vertexBuffer = nil;
+
+	DisposeTerrainQuadtree();
+
+	if (gTerrainVertexBuffer)
+	{
+		Render_DisposeVertexBuffer(gTerrainVertexBuffer);
+		gTerrainVertexBuffer = nil;
 	}
 
-	gSuperTileMemoryListExists = true;
+	if (gSuperTileGeometry)
+	{
+		DisposePtr((Ptr) gSuperTileGeometry);
+		gSuperTileGeometry = nil;
+	}
+
+	if (gTerrainGeometry)
+	{
+		Q3TriMeshData_Dispose(gTerrainGeometry);
+		gTerrainGeometry = nil;
+	}
+
+	for (int layer = 0; layer < MAX_LAYERS; layer++)
+	{
+		if (gTerrainVertexNormals[layer])
+		{
+			Free2DArray((void**) gTerrainVertexNormals[layer]);
+			gTerrainVertexNormals[layer] = nil;
+		}
+
+		if (gTerrainVertexLighting[layer])
+		{
+			Free2DArray((void**) gTerrainVertexLighting[layer]);
+			gTerrainVertexLighting[layer] = nil;
+		}
+	}
 }
 
 
-/********************* DISPOSE SUPERTILE MEMORY LIST **********************/
+/****************** BAKE TERRAIN LIGHTING *********************/
+//
+// The lights and the heightfield are static for the whole level, so the vertex normals
+// and lit vertex colors are computed once for the entire map grid (floor & ceiling).
+// Supertiles then just copy their rows out of these grids.
+//
 
-void DisposeSuperTileMemoryList(void)
+static void BakeTerrainLighting(int numLayers)
 {
-int		numLayers;
+const QD3DLightDefType* lights = &gGameViewInfoPtr->lightList;
+float				brightness;
+float				ambientR,ambientG,ambientB;
+float				fillR0,fillG0,fillB0;
+float				fillR1,fillG1,fillB1;
+TQ3Vector3D			fillDir0,fillDir1;
+TQ3Vector3D**		tileNormals;
 
-	if (gSuperTileMemoryListExists == false)
-		return;
+	const long numRows = gTerrainTileDepth + 1;							// grid has 1 more vertex than tiles on each axis
+	const long numCols = gTerrainTileWidth + 1;
 
-	if (gDoCeiling)
-		numLayers = 2;
+
+		/* GET LIGHT DATA */
+
+	brightness = lights->ambientBrightness;								// get ambient brightness
+	ambientR = lights->ambientColor.r * brightness;						// calc ambient color
+	ambientG = lights->ambientColor.g * brightness;
+	ambientB = lights->ambientColor.b * brightness;
+
+	brightness = lights->fillBrightness[0];								// get fill brightness 0
+	fillR0 = lights->fillColor[0].r * brightness;						// calc fill color
+	fillG0 = lights->fillColor[0].g * brightness;
+	fillB0 = lights->fillColor[0].b * brightness;
+	fillDir0 = lights->fillDirection[0];								// get fill direction
+
+	if (lights->numFillLights > 1)
+	{
+		brightness = lights->fillBrightness[1];							// get fill brightness 1
+		fillR1 = lights->fillColor[1].r * brightness;
+		fillG1 = lights->fillColor[1].g * brightness;
+		fillB1 = lights->fillColor[1].b * brightness;
+		fillDir1 = lights->fillDirection[1];
+	}
 	else
-		numLayers = 1;
-		
+	{
+		fillR1 = fillG1 = fillB1 = 0;									// black light contributes nothing
+		fillDir1 = (TQ3Vector3D) {0, 0, 0};
+	}
 
-			/*************************************/
-			/* FOR EACH SUPERTILE DEALLOC MEMORY */
-			/*************************************/
 
-	const int numSuperTiles = gSupertileBudget;
+		/* ALLOC TEMP TILE NORMAL GRID */
+		//
+		// Holds the sum of the 2 face normals of each tile, with a 1-tile border
+		// all around the map so that every vertex has 4 neighboring tiles.
+		//
 
-	for (int i = 0; i < numSuperTiles; i++)
+	Alloc_2d_array(TQ3Vector3D, tileNormals, gTerrainTileDepth + 2, gTerrainTileWidth + 2);
+
+	for (int layer = 0; layer < numLayers; layer++)
 	{
-		SuperTileMemoryType* superTile = &gSuperTileMemoryList[i];
+		GAME_ASSERT(gTerrainVertexNormals[layer] == nil);
+		GAME_ASSERT(gTerrainVertexLighting[layer] == nil);
 
-		for (int layer = 0; layer < numLayers; layer++)
-		{
-				/* NUKE TEXTURES */
+		Alloc_2d_array(TQ3Vector3D, gTerrainVertexNormals[layer], numRows, numCols);
+		Alloc_2d_array(TQ3ColorRGBA, gTerrainVertexLighting[layer], numRows, numCols);
 
-			for (int lod = 0; lod < gNumLODs; lod++)
+				/* CALC FACE NORMALS OF EVERY TILE */
+
+		for (long row = -1; row <= gTerrainTileDepth; row++)
+		{
+			for (long col = -1; col <= gTerrainTileWidth; col++)
 			{
-				DisposePtr((Ptr) superTile->textureData[layer][lod]);
-				superTile->textureData[layer][lod] = nil;
-				superTile->hasLOD[lod] = false;
+				TQ3Vector3D n1, n2;
+				CalcTileNormals(layer, row, col, &n1, &n2);				// returns up vectors for tiles off the map
+				tileNormals[row+1][col+1] = (TQ3Vector3D) { n1.x + n2.x, n1.y + n2.y, n1.z + n2.z };
+			}
+		}
 
-				if (superTile->glTextureName[layer][lod])
-				{
-					glDeleteTextures(1, &superTile->glTextureName[layer][lod]);
-					superTile->glTextureName[layer][lod] = 0;
-				}
+				/* AVERAGE THE 4 TILES AROUND EACH VERTEX */
+
+		for (long row = 0; row < numRows; row++)
+		{
+			const TQ3Vector3D*	back = tileNormals[row];				// tiles behind this row of vertices
+			const TQ3Vector3D*	front = tileNormals[row+1];				// tiles in front of this row of vertices
+			TQ3Vector3D*		normals = gTerrainVertexNormals[layer][row];
+
+			for (long col = 0; col < numCols; col++)
+			{
+				float x = back[col].x + back[col+1].x + front[col].x + front[col+1].x;
+				float y = back[col].y + back[col+1].y + front[col].y + front[col+1].y;
+				float z = back[col].z + back[col+1].z + front[col].z + front[col+1].z;
+				FastNormalizeVector(x, y, z, &normals[col]);
 			}
+		}
+
+				/* LIGHT EACH VERTEX */
+				//
+				// Straight-line float math over whole rows so the compiler can vectorize it.
+				//
 
-				/* NUKE TRIMESH DATA */
+		for (long row = 0; row < numRows; row++)
+		{
+			const u_short*		diffuse = gVertexColors[layer][row];
+			const TQ3Vector3D*	normals = gTerrainVertexNormals[layer][row];
+			TQ3ColorRGBA*		lit = gTerrainVertexLighting[layer][row];
 
-			Q3TriMeshData_Dispose(gSuperTileMemoryList[i].triMeshDataPtrs[layer]);
-			gSuperTileMemoryList[i].triMeshDataPtrs[layer] = nil;
+			for (long col = 0; col < numCols; col++)
+			{
+				u_short	color = diffuse[col];
+				float	r,g,b,dot0,dot1;
+
+						/* GET VERTEX DIFFUSE COLOR */
+
+				r = (float)(color>>11) * (1.0f/32.0f);
+				g = (float)((color>>5) & 0x3f) * (1.0f/64.0f);
+				b = (float)(color&0x1f) * (1.0f/32.0f);
+
+						/* APPLY LIGHTING TO THE VERTEX */
+
+				dot0 = -(normals[col].x * fillDir0.x + normals[col].y * fillDir0.y + normals[col].z * fillDir0.z);
+				dot1 = -(normals[col].x * fillDir1.x + normals[col].y * fillDir1.y + normals[col].z * fillDir1.z);
+				dot0 = dot0 > 0.0f ? dot0 : 0.0f;						// lights don't contribute to faces pointing away
+				dot1 = dot1 > 0.0f ? dot1 : 0.0f;
+
+				r *= ambientR + fillR0 * dot0 + fillR1 * dot1;			// apply final lighting to diffuse color
+				g *= ambientG + fillG0 * dot0 + fillG1 * dot1;
+				b *= ambientB + fillB0 * dot0 + fillB1 * dot1;
+
+				lit[col].r = r < 1.0f ? r : 1.0f;
+				lit[col].g = g < 1.0f ? g : 1.0f;
+				lit[col].b = b < 1.0f ? b : 1.0f;
+				lit[col].a = 1.0f;
+			}
 		}
 	}
-	
-	gSuperTileMemoryListExists = false;
+
+	Free2DArray((void**) tileNormals);
 }
 
 
@@ -577,6 +1090,96 @@ static short GetFreeSuperTileMemory(void)
 #pragma mark -
 
 
+/****************** BUILD TERRAIN QUADTREE *********************/
+//
+// Builds a pyramid of Y extents over the whole map, so that DrawTerrain can reject
+// entire blocks of supertiles with one test. Level 0 has one node per supertile,
+// and each level above it merges 2x2 nodes of the level below.
+//
+
+static void BuildTerrainQuadtree(int numLayers)
+{
+	long width = gNumSuperTilesWide;
+	long depth = gNumSuperTilesDeep;
+	int level = 0;
+
+	while (1)
+	{
+		GAME_ASSERT(level < MAX_TERRAIN_QUADTREE_LEVELS);
+
+		gTerrainQuadtree[level] = (TerrainQuadtreeNode*) AllocPtr(width * depth * sizeof(TerrainQuadtreeNode));
+		GAME_ASSERT(gTerrainQuadtree[level]);
+		gTerrainQuadtreeWidth[level] = width;
+		gTerrainQuadtreeDepth[level] = depth;
+
+		for (long row = 0; row < depth; row++)
+		{
+			for (long col = 0; col < width; col++)
+			{
+				TerrainQuadtreeNode* node = &gTerrainQuadtree[level][row * width + col];
+
+				for (int layer = 0; layer < MAX_LAYERS; layer++)
+				{
+					node->minY[layer] = 1000000;
+					node->maxY[layer] = -1000000;
+				}
+
+				for (int layer = 0; layer < numLayers; layer++)
+				{
+					if (level == 0)											// get extents from supertile geometry
+					{
+						const TQ3BoundingBox* bBox = &gSuperTileGeometry[row * width + col].mesh[layer].bBox;
+						node->minY[layer] = bBox->min.y;
+						node->maxY[layer] = bBox->max.y;
+						continue;
+					}
+
+					for (int i = 0; i < 4; i++)								// merge the 2x2 children
+					{
+						long childRow = row*2 + (i >> 1);
+						long childCol = col*2 + (i & 1);
+						long childWidth = gTerrainQuadtreeWidth[level-1];
+
+						if (childRow >= gTerrainQuadtreeDepth[level-1] || childCol >= childWidth)
+							continue;
+
+						const TerrainQuadtreeNode* child = &gTerrainQuadtree[level-1][childRow * childWidth + childCol];
+						if (child->minY[layer] < node->minY[layer])
+							node->minY[layer] = child->minY[layer];
+						if (child->maxY[layer] > node->maxY[layer])
+							node->maxY[layer] = child->maxY[layer];
+					}
+				}
+			}
+		}
+
+		level++;
+
+		if (width == 1 && depth == 1)									// reached the root
+			break;
+
+		width = (width + 1) / 2;
+		depth = (depth + 1) / 2;
+	}
+
+	gNumTerrainQuadtreeLevels = level;
+}
+
+
+/****************** DISPOSE TERRAIN QUADTREE *********************/
+
+static void DisposeTerrainQuadtree(void)
+{
+	for (int level = 0; level < gNumTerrainQuadtreeLevels; level++)
+	{
+		DisposePtr((Ptr) gTerrainQuadtree[level]);
+		gTerrainQuadtree[level] = nil;
+	}
+
+	gNumTerrainQuadtreeLevels = 0;
+}
+
+
 /******************* BUILD TERRAIN SUPERTILE *******************/
 //
 // Builds a new supertile which has scrolled on
@@ -591,22 +1194,10 @@ static short	BuildTerrainSuperTile(long	startCol, long startRow)
 {
 long	 			row,col,row2,col2;
 int32_t				superTileNum;
-float				height,miny,maxy;
-TQ3TriMeshData		*triMeshData;
-TQ3Vector3D			*vertexNormalList;
 u_short				tile;
-TQ3Point3D			*pointList;
-TQ3TriMeshTriangleData	*triangleList;
 SuperTileMemoryType	*superTilePtr;
-TQ3ColorRGBA		*vertexColorList;
-float				brightness;
-float				ambientR,ambientG,ambientB;
-float				fillR0,fillG0,fillB0;
-float				fillR1,fillG1,fillB1;
-TQ3Vector3D			*fillDir0,*fillDir1;
-Byte				numFillLights, numLayers;
-
-static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
+SuperTileGeometryType	*geom;
+Byte				numLayers;
 
 	if (gDoCeiling)
 		numLayers = 2;
@@ -617,298 +1208,33 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 	superTileNum = GetFreeSuperTileMemory();					// get memory block for the data
 	superTilePtr = &gSuperTileMemoryList[superTileNum];			// get ptr to it
 
-	if (gDisableHiccupTimer)
-		superTilePtr->hiccupTimer = 0;
-	else
-		superTilePtr->hiccupTimer = (gHiccupEliminator++ & 0x3) + 1;	// set hiccup timer to aleiviate hiccup caused by massive texture uploading
-
 	for (int lod = 0; lod < MAX_LODS; lod++)
 		superTilePtr->hasLOD[lod] = false;						// LOD isnt built yet
 
-	for (int layer = 0; layer < MAX_LAYERS; layer++)
-	{
-		superTilePtr->coord[layer] = (TQ3Point3D)				// also remember world coords
-		{
-			startCol*TERRAIN_POLYGON_SIZE + TERRAIN_SUPERTILE_UNIT_SIZE/2,
-			0,																		// y is set later
-			startRow*TERRAIN_POLYGON_SIZE + TERRAIN_SUPERTILE_UNIT_SIZE/2,
-		};
-	}
-
 	superTilePtr->left = (startCol * TERRAIN_POLYGON_SIZE);		// also save left/back coord
 	superTilePtr->back = (startRow * TERRAIN_POLYGON_SIZE);
 
+			/* GET THE PREBUILT GEOMETRY */
 
-		/* GET LIGHT DATA */
-
-	brightness = gGameViewInfoPtr->lightList.ambientBrightness;				// get ambient brightness
-	ambientR = gGameViewInfoPtr->lightList.ambientColor.r * brightness;		// calc ambient color
-	ambientG = gGameViewInfoPtr->lightList.ambientColor.g * brightness;		
-	ambientB = gGameViewInfoPtr->lightList.ambientColor.b * brightness;
+	geom = &gSuperTileGeometry[(startRow / SUPERTILE_SIZE) * gNumSuperTilesWide + (startCol / SUPERTILE_SIZE)];
 
-	brightness = gGameViewInfoPtr->lightList.fillBrightness[0];				// get fill brightness 0
-	fillR0 = gGameViewInfoPtr->lightList.fillColor[0].r * brightness;		// calc ambient color
-	fillG0 = gGameViewInfoPtr->lightList.fillColor[0].g * brightness;		
-	fillB0 = gGameViewInfoPtr->lightList.fillColor[0].b * brightness;		
-	fillDir0 = &gGameViewInfoPtr->lightList.fillDirection[0];		// get fill direction
-
-	numFillLights = gGameViewInfoPtr->lightList.numFillLights;
-	if (numFillLights > 1)
-	{
-		brightness = gGameViewInfoPtr->lightList.fillBrightness[1];			// get fill brightness 1
-		fillR1 = gGameViewInfoPtr->lightList.fillColor[1].r * brightness;	// calc ambient color
-		fillG1 = gGameViewInfoPtr->lightList.fillColor[1].g * brightness;		
-		fillB1 = gGameViewInfoPtr->lightList.fillColor[1].b * brightness;		
-		fillDir1 = &gGameViewInfoPtr->lightList.fillDirection[1];
-	}
-	else
+	for (int layer = 0; layer < MAX_LAYERS; layer++)
 	{
-		fillR1 = 0;
-		fillG1 = 0;
-		fillB1 = 0;
-		fillDir1 = nil;
+		superTilePtr->coord[layer] = geom->coord[layer];
+		superTilePtr->radius[layer] = geom->radius[layer];
 	}
 
 		/***********************************************************/
 		/*                DO FLOOR & CEILING LAYERS                */
-		/***********************************************************/
-
-	for (int layer = 0; layer < numLayers; layer++)							// do floor & ceiling
-	{
-					/*******************/
-					/* GET THE TRIMESH */
-					/*******************/
-					
-		triMeshData = gSuperTileMemoryList[superTileNum].triMeshDataPtrs[layer];	// get ptr to triMesh data
-		pointList = triMeshData->points;									// get ptr to point/vertex list
-		triangleList = triMeshData->triangles;								// get ptr to triangle index list
-		vertexColorList = triMeshData->vertexColors;						// get ptr to vertex color
-		vertexNormalList = triMeshData->vertexNormals;						// get ptr to vertex normals
-
-		miny = 1000000;														// init bbox counters
-		maxy = -miny;
-				
-	
-				/**********************************/
-				/* CREATE VERTICES FOR THIS LAYER */
-				/**********************************/
-	
-		for (row2 = 0; row2 <= SUPERTILE_SIZE; row2++)
-		{
-			row = row2 + startRow;
-			
-			for (col2 = 0; col2 <= SUPERTILE_SIZE; col2++)
-			{
-				col = col2 + startCol;
-				
-				if ((row >= gTerrainTileDepth) || (col >= gTerrainTileWidth)) // check for edge vertices (off map array)
-					height = 0;
-				else
-					height = gMapYCoords[row][col].layerY[layer];			// get pixel height here
-	
-				gWorkGrid[row2][col2].x = (col*TERRAIN_POLYGON_SIZE);
-				gWorkGrid[row2][col2].z = (row*TERRAIN_POLYGON_SIZE);
-				gWorkGrid[row2][col2].y = height;							// save height @ this tile's upper left corner
-					
-				
-				if (height > maxy)											// keep track of min/max
-					maxy = height;
-				if (height < miny)
-					miny = height;			
-			}
-		}	
-	
-				/*********************************/
-				/* CREATE TERRAIN MESH POLYGONS  */
-				/*********************************/
-
-		int i;
-						/* SET VERTEX COORDS */
-
-		i = 0;			
-		for (row = 0; row < (SUPERTILE_SIZE+1); row++)
-		{
-			for (col = 0; col < (SUPERTILE_SIZE+1); col++)
-				pointList[i++] = gWorkGrid[row][col];						// copy from other list
-		}
-	
-					/* UPDATE TRIMESH DATA WITH NEW INFO */
-#if _DEBUG
-		SDL_memset(gTempTextureBuffer, 0xFF, SUPERTILE_TEXSIZE_MAX * SUPERTILE_TEXSIZE_MAX * sizeof(uint16_t));
-#endif
-
-		i = 0;
-		for (row2 = 0; row2 < SUPERTILE_SIZE; row2++)
-		{
-			row = row2 + startRow;
-	
-			for (col2 = 0; col2 < SUPERTILE_SIZE; col2++)
-			{
-	
-				col = col2 + startCol;
-	
-						/* SET SPLITTING INFO */
-
-				const Byte* tri1;
-				const Byte* tri2;
-
-				if (gMapInfoMatrix[row][col].splitMode[layer] == SPLIT_BACKWARD)	// set coords & uv's based on splitting
-				{
-						/* \ */
-					tri1 = gTileTriangles1_B[row2][col2];
-					tri2 = gTileTriangles2_B[row2][col2];
-				}
-				else
-				{
-						/* / */
-					tri1 = gTileTriangles1_A[row2][col2];
-					tri2 = gTileTriangles2_A[row2][col2];
-				}
-
-				triangleList[i].pointIndices[0] 	= tri1[gTileTriangleWinding[layer][0]];
-				triangleList[i].pointIndices[1] 	= tri1[gTileTriangleWinding[layer][1]];
-				triangleList[i++].pointIndices[2] 	= tri1[gTileTriangleWinding[layer][2]];
-				triangleList[i].pointIndices[0] 	= tri2[gTileTriangleWinding[layer][0]];
-				triangleList[i].pointIndices[1] 	= tri2[gTileTriangleWinding[layer][1]];
-				triangleList[i++].pointIndices[2] 	= tri2[gTileTriangleWinding[layer][2]];
-			}
-		}
-
-							/* CALC FACE NORMALS */
-						
-		for (i = 0; i < NUM_TRIS_IN_SUPERTILE; i++)
-		{
-			CalcFaceNormal( &pointList[triangleList[i].pointIndices[0]],
-							&pointList[triangleList[i].pointIndices[1]],
-							&pointList[triangleList[i].pointIndices[2]],
-							&faceNormal[i]);
-		}
-
-				/******************************/
-				/* CALCULATE VERTEX NORMALS   */
-				/******************************/
-	
-		i = 0;
-		for (row = 0; row <= SUPERTILE_SIZE; row++)
-		{
-			for (col = 0; col <= (SUPERTILE_SIZE*2); col += 2)
-			{
-				TQ3Vector3D	*n1,*n2;
-				float		avX,avY,avZ;
-				TQ3Vector3D	nA,nB;
-				long		ro,co;
-				
-				/* SCAN 4 TILES AROUND THIS TILE TO CALC AVERAGE NORMAL FOR THIS VERTEX */
-				//
-				// We use the face normal already calculated for triangles inside the supertile,
-				// but for tiles/tris outside the supertile (on the borders), we need to calculate
-				// the face normals there.
-				//
-				
-				avX = avY = avZ = 0;									// init the normal	
-				
-				for (ro = -1; ro <= 0; ro++)
-				{
-					for (co = -2; co <= 0; co+=2)
-					{
-						long	cc = col + co;
-						long	rr = row + ro;
-						
-						if ((cc >= 0) && (cc < (SUPERTILE_SIZE*2)) && (rr >= 0) && (rr < SUPERTILE_SIZE)) // see if this vertex is in supertile bounds							 
-						{					
-							n1 = &faceNormal[rr * (SUPERTILE_SIZE*2) + cc];					// average 2 triangles...
-							n2 = n1+1;
-							avX += n1->x + n2->x;											// ...and average with current average
-							avY += n1->y + n2->y;
-							avZ += n1->z + n2->z;
-						}
-						else																// tile is out of supertile, so calc face normal & average
-						{
-							CalcTileNormals(layer, rr+startRow, (cc>>1)+startCol, &nA,&nB);	// calculate the 2 face normals for this tile
-							avX += nA.x + nB.x;												// average with current average
-							avY += nA.y + nB.y;
-							avZ += nA.z + nB.z;
-						}
-					}
-				}
-				FastNormalizeVector(avX, avY, avZ, &vertexNormalList[i++]);					// normalize the vertex normal	
-			}
-		}
-		
-		if (vertexColorList)
-		{
-				/*****************************/
-				/* CALCULATE VERTEX COLORS   */
-				/*****************************/
-					
-			i = 0;
-			for (row = 0; row <= SUPERTILE_SIZE; row++)
-			{
-				for (col = 0; col <= SUPERTILE_SIZE; col++)
-				{
-					u_short	color = gVertexColors[layer][row+startRow][col+startCol];
-					float	r,g,b,dot;
-					float	lr,lg,lb;
-					
-							/* GET VERTEX DIFFUSE COLOR */
-							
-					r = (float)(color>>11) * (1.0f/32.0f);
-					g = (float)((color>>5) & 0x3f) * (1.0f/64.0f);
-					b = (float)(color&0x1f) * (1.0f/32.0f);
-	
-							/* APPLY LIGHTING TO THE VERTEX */
-					
-					lr = ambientR;												// factor in the ambient
-					lg = ambientG;
-					lb = ambientB;
-					
-					dot = vertexNormalList[i].x * fillDir0->x;					// calc dot product of fill #0
-					dot += vertexNormalList[i].y * fillDir0->y;
-					dot += vertexNormalList[i].z * fillDir0->z;
-					dot = -dot;
-	
-					if (dot > 0.0f)
-					{					
-						lr += fillR0 * dot;
-						lg += fillG0 * dot;
-						lb += fillB0 * dot;					
-					}
-	
-					if (numFillLights > 1)
-					{
-						dot = vertexNormalList[i].x * fillDir1->x;				// calc dot product of fill #1
-						dot += vertexNormalList[i].y * fillDir1->y;
-						dot += vertexNormalList[i].z * fillDir1->z;
-						dot = -dot;
-						
-						if (dot > 0.0f)
-						{					
-							lr += fillR1 * dot;
-							lg += fillG1 * dot;
-							lb += fillB1 * dot;					
-						}
-					}
-					
-					r *= lr;													// apply final lighting to diffuse color
-					if (r > 1.0f)
-						r = 1.0f;
-					g *= lg;
-					if (g > 1.0f)
-						g = 1.0f;
-					b *= lb;
-					if (b > 1.0f)
-						b = 1.0f;
-										
-	
-							/* SAVE COLOR INTO LIST */
-							
-					vertexColorList[i].r = r;
-					vertexColorList[i].g = g;
-					vertexColorList[i].b = b;
-					i++;
-				}
-			}
-		}
+		/***********************************************************/
+
+	for (int layer = 0; layer < numLayers; layer++)							// do floor & ceiling
+	{
+		superTilePtr->triMeshDataPtrs[layer] = &geom->mesh[layer];			// draw straight from the static geometry
+
+#if _DEBUG
+		SDL_memset(gTempTextureBuffer, 0xFF, SUPERTILE_TEXSIZE_MAX * SUPERTILE_TEXSIZE_MAX * sizeof(uint16_t));
+#endif
 
 					/********************/
 					/* ASSEMBLE TEXTURE */
@@ -982,7 +1308,7 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 
 			superTilePtr->hasLOD[0] = true;
 
-			Render_UpdateTexture(
+			superTilePtr->textureUploadTicket = Render_UpdateTexture(		// don't draw it before the GPU has its texture
 					superTilePtr->glTextureName[layer][0],
 					0,
 					0,
@@ -993,39 +1319,174 @@ static TQ3Vector3D	faceNormal[NUM_TRIS_IN_SUPERTILE];
 					superTilePtr->textureData[layer][0],
 					0);
 		}
+	}	// j (layer)
+									
+	return(superTileNum);
+}
+
+
+/******************* BUILD SUPERTILE GEOMETRY *******************/
+//
+// Builds the vertices & triangles of one layer of a supertile,
+// and copies its normals & lighting from the level's baked lighting.
+// Called once per supertile when the level is loaded.
+//
+// INPUT: startCol = starting column in map
+//		  startRow = starting row in map
+//
 
+static void BuildSuperTileGeometry(long startCol, long startRow, int layer, SuperTileGeometryType* geom)
+{
+long	 			row,col,row2,col2;
+float				height,miny,maxy;
+TQ3TriMeshData		*triMeshData;
+TQ3Vector3D			*vertexNormalList;
+TQ3Point3D			*pointList;
+TQ3TriMeshTriangleData	*triangleList;
+TQ3ColorRGBA		*vertexColorList;
 
+	geom->coord[layer] = (TQ3Point3D)							// remember world coords
+	{
+		startCol*TERRAIN_POLYGON_SIZE + TERRAIN_SUPERTILE_UNIT_SIZE/2,
+		0,																		// y is set later
+		startRow*TERRAIN_POLYGON_SIZE + TERRAIN_SUPERTILE_UNIT_SIZE/2,
+	};
+
+				/*******************/
+				/* GET THE TRIMESH */
+				/*******************/
+
+	triMeshData = &geom->mesh[layer];									// get ptr to triMesh data
+	pointList = triMeshData->points;									// get ptr to point/vertex list
+	triangleList = triMeshData->triangles;								// get ptr to triangle index list
+	vertexColorList = triMeshData->vertexColors;						// get ptr to vertex color
+	vertexNormalList = triMeshData->vertexNormals;						// get ptr to vertex normals
+
+	miny = 1000000;														// init bbox counters
+	maxy = -miny;
+			
 
+			/**********************************/
+			/* CREATE VERTICES FOR THIS LAYER */
+			/**********************************/
 
-				/**********************/
-				/* UPDATE THE TRIMESH */
-				/**********************/
-	
-				/* SET BOUNDING BOX */
-				
-		triMeshData->bBox.min.x = gWorkGrid[0][0].x;
-		triMeshData->bBox.max.x = triMeshData->bBox.min.x+TERRAIN_SUPERTILE_UNIT_SIZE;
-		triMeshData->bBox.min.y = miny;
-		triMeshData->bBox.max.y = maxy;
-		triMeshData->bBox.min.z = gWorkGrid[0][0].z;
-		triMeshData->bBox.max.z = triMeshData->bBox.min.z + TERRAIN_SUPERTILE_UNIT_SIZE;
-
-
-				/******************************************/
-				/* CALC COORD & RADIUS FOR CULLING SPHERE */
-				/******************************************/
-
-		// Calc center Y coord as average of top & bottom.
-		// This Y coord is not used to translate since the terrain has no translation matrix.
-		// Instead, this is used by the frustum culling routine.
-		superTilePtr->coord[layer].y = (miny + maxy) * .5f;
+	for (row2 = 0; row2 <= SUPERTILE_SIZE; row2++)
+	{
+		row = row2 + startRow;
 		
-		// Calc radius of supertile bounding sphere
-		superTilePtr->radius[layer] = 0.5f * Q3Point3D_Distance(&triMeshData->bBox.min, &triMeshData->bBox.max);
+		for (col2 = 0; col2 <= SUPERTILE_SIZE; col2++)
+		{
+			col = col2 + startCol;
+			
+			if ((row >= gTerrainTileDepth) || (col >= gTerrainTileWidth)) // check for edge vertices (off map array)
+				height = 0;
+			else
+				height = gMapYCoords[row][col].layerY[layer];			// get pixel height here
 
-	}	// j (layer)
-									
-	return(superTileNum);
+			gWorkGrid[row2][col2].x = (col*TERRAIN_POLYGON_SIZE);
+			gWorkGrid[row2][col2].z = (row*TERRAIN_POLYGON_SIZE);
+			gWorkGrid[row2][col2].y = height;							// save height @ this tile's upper left corner
+				
+			
+			if (height > maxy)											// keep track of min/max
+				maxy = height;
+			if (height < miny)
+				miny = height;			
+		}
+	}	
+
+			/*********************************/
+			/* CREATE TERRAIN MESH POLYGONS  */
+			/*********************************/
+
+	int i;
+					/* SET VERTEX COORDS */
+
+	i = 0;			
+	for (row = 0; row < (SUPERTILE_SIZE+1); row++)
+	{
+		for (col = 0; col < (SUPERTILE_SIZE+1); col++)
+			pointList[i++] = gWorkGrid[row][col];						// copy from other list
+	}
+
+
+	i = 0;
+	for (row2 = 0; row2 < SUPERTILE_SIZE; row2++)
+	{
+		row = row2 + startRow;
+
+		for (col2 = 0; col2 < SUPERTILE_SIZE; col2++)
+		{
+
+			col = col2 + startCol;
+
+					/* SET SPLITTING INFO */
+
+			const Byte* tri1;
+			const Byte* tri2;
+
+			if (gMapInfoMatrix[row][col].splitMode[layer] == SPLIT_BACKWARD)	// set coords & uv's based on splitting
+			{
+					/* \ */
+				tri1 = gTileTriangles1_B[row2][col2];
+				tri2 = gTileTriangles2_B[row2][col2];
+			}
+			else
+			{
+					/* / */
+				tri1 = gTileTriangles1_A[row2][col2];
+				tri2 = gTileTriangles2_A[row2][col2];
+			}
+
+			triangleList[i].pointIndices[0] 	= tri1[gTileTriangleWinding[layer][0]];
+			triangleList[i].pointIndices[1] 	= tri1[gTileTriangleWinding[layer][1]];
+			triangleList[i++].pointIndices[2] 	= tri1[gTileTriangleWinding[layer][2]];
+			triangleList[i].pointIndices[0] 	= tri2[gTileTriangleWinding[layer][0]];
+			triangleList[i].pointIndices[1] 	= tri2[gTileTriangleWinding[layer][1]];
+			triangleList[i++].pointIndices[2] 	= tri2[gTileTriangleWinding[layer][2]];
+		}
+	}
+
+			/**************************************/
+			/* COPY BAKED VERTEX NORMALS & COLORS */
+			/**************************************/
+
+	i = 0;
+	for (row = 0; row <= SUPERTILE_SIZE; row++)
+	{
+		const TQ3Vector3D*	normalRow = &gTerrainVertexNormals[layer][row + startRow][startCol];
+		const TQ3ColorRGBA*	colorRow = &gTerrainVertexLighting[layer][row + startRow][startCol];
+
+		SDL_memcpy(&vertexNormalList[i], normalRow, sizeof(vertexNormalList[0]) * (SUPERTILE_SIZE+1));
+		SDL_memcpy(&vertexColorList[i], colorRow, sizeof(vertexColorList[0]) * (SUPERTILE_SIZE+1));
+		i += SUPERTILE_SIZE+1;
+	}
+
+			/**********************/
+			/* UPDATE THE TRIMESH */
+			/**********************/
+
+			/* SET BOUNDING BOX */
+			
+	triMeshData->bBox.min.x = gWorkGrid[0][0].x;
+	triMeshData->bBox.max.x = triMeshData->bBox.min.x+TERRAIN_SUPERTILE_UNIT_SIZE;
+	triMeshData->bBox.min.y = miny;
+	triMeshData->bBox.max.y = maxy;
+	triMeshData->bBox.min.z = gWorkGrid[0][0].z;
+	triMeshData->bBox.max.z = triMeshData->bBox.min.z + TERRAIN_SUPERTILE_UNIT_SIZE;
+
+
+			/******************************************/
+			/* CALC COORD & RADIUS FOR CULLING SPHERE */
+			/******************************************/
+
+	// Calc center Y coord as average of top & bottom.
+	// This Y coord is not used to translate since the terrain has no translation matrix.
+	// Instead, this is used by the frustum culling routine.
+	geom->coord[layer].y = (miny + maxy) * .5f;
+	
+	// Calc radius of supertile bounding sphere
+	geom->radius[layer] = 0.5f * Q3Point3D_Distance(&triMeshData->bBox.min, &triMeshData->bBox.max);
 }
 
 
@@ -1405,72 +1866,40 @@ void DrawTerrain(const QD3DSetupOutputType *setupInfo)
 	TQ3Point3D cameraCoord = setupInfo->currentCameraCoords;
 	
 
-				/* DRAW STUFF */
-
-	for (int i = 0; i < gSupertileBudget; i++)
-	{
-		if (gSuperTileMemoryList[i].mode != SUPERTILE_MODE_USED)		// if supertile is being used, then draw it
-			continue;
-		
-				/* SEE IF DO HICCUP PREVENTION */
-				
-		if (!gDisableHiccupTimer)
-		{
-			if (gSuperTileMemoryList[i].hiccupTimer != 0)				// see if this supertile is still in hiccup prevention mode
-			{
-				gSuperTileMemoryList[i].hiccupTimer--;
-				continue;
-			}
-		}
-
-		for (int j = 0; j < numLayers; j++)								// DRAW FLOOR & CEILING
-		{
-			if (!IsSuperTileVisible(i,j))								// make sure it's visible
-				continue;
-
-
-				/**************************************/
-				/* DRAW THE TRIMESH IN THIS SUPERTILE */
-				/**************************************/
-
-			int lod = 0;
-
-			if (gTerrainTextureDetail == SUPERTILE_DETAIL_PROGRESSIVE)	// the only detail level with 3 LODs
-			{
-						/* SEE WHICH LOD TO USE */
-
-				TQ3Point3D tileCoord = gSuperTileMemoryList[i].coord[j];	// get x & z coords of tile
-				float dist = CalcQuickDistance(cameraCoord.x, cameraCoord.z, tileCoord.x, tileCoord.z);
-
-				if (dist < 1300.0f)
-					lod = 0;
-				else if (dist < 1700.0f)
-					lod = 1;
-				else
-					lod = 2;
+				/* SET UP CULLING AREA */
+				//
+				// Only supertiles in the active area (plus the prefetch ring) can be in the scroll buffer.
+				//
 
-						/* MAKE SURE THE LOD IS BUILT */
+	TerrainCullInfo cull;
+	cull.top			= SDL_max(0, gCurrentSuperTileRow - SUPERTILE_PREFETCH_MARGIN);
+	cull.bottom			= SDL_min(gNumSuperTilesDeep, gCurrentSuperTileRow + SUPERTILE_DIST_DEEP + SUPERTILE_PREFETCH_MARGIN);
+	cull.left			= SDL_max(0, gCurrentSuperTileCol - SUPERTILE_PREFETCH_MARGIN);
+	cull.right			= SDL_min(gNumSuperTilesWide, gCurrentSuperTileCol + SUPERTILE_DIST_WIDE + SUPERTILE_PREFETCH_MARGIN);
+	cull.fogEndDistance	= 0;
+	cull.cameraCoord	= cameraCoord;
 
-				if (!gSuperTileMemoryList[i].hasLOD[lod])
-				{
-					GAME_ASSERT(lod != 0);	// can't build LOD 0 like that
+				/* CULL FULLY FOGGED SUPERTILES */
+				//
+				// Only if nothing is drawn behind the terrain. Otherwise, a fully fogged supertile
+				// still covers the cyclorama (or a clear color that isn't the fog color) with fog color,
+				// and culling it would open a hole onto the background.
+				//
 
-					for (int lodToBuild = 0; lodToBuild <= lod; lodToBuild++)	// any LOD requires all of the inferior LODs to be built
-					{
-						if (!gSuperTileMemoryList[i].hasLOD[lodToBuild])
-							BuildSuperTileLOD(&gSuperTileMemoryList[i], lodToBuild);
-					}
-				}
-			}
+	if (!gCyclorama && Render_FogMatchesClearColor())
+		cull.fogEndDistance = Render_GetFogEndDistance();
 
-						/* USE LOD TEXTURE */
+	if (cull.fogEndDistance > 0)											// fog end is measured from the camera, the near plane is at hither
+		cull.fogEndDistance = SDL_max(0, cull.fogEndDistance - gGameViewInfoPtr->hither);
 
-			gSuperTileMemoryList[i].triMeshDataPtrs[j]->glTextureName = gSuperTileMemoryList[i].glTextureName[j][lod];
+				/* DRAW STUFF */
 
-						/* SUBMIT FOR DRAWING */
+	if (gNumTerrainQuadtreeLevels > 0)
+	{
+		int rootLevel = gNumTerrainQuadtreeLevels - 1;
 
-			Render_SubmitMesh(gSuperTileMemoryList[i].triMeshDataPtrs[j], nil, &gTerrainRenderMods, &gSuperTileMemoryList[i].coord[j]);
-		}
+		for (int j = 0; j < numLayers; j++)								// DRAW FLOOR & CEILING
+			CullTerrainQuadtreeNode(rootLevel, 0, 0, j, &cull);
 	}
 
 		/* DRAW OBJECTS */
@@ -1513,6 +1942,150 @@ void DrawTerrain(const QD3DSetupOutputType *setupInfo)
 }
 
 
+/***************** CULL TERRAIN QUADTREE NODE ******************/
+//
+// Recursively walks the terrain quadtree, rejecting whole blocks of supertiles
+// that are outside the frustum or entirely hidden by fog.
+// Leaves are the supertiles themselves, which are submitted if they're built.
+//
+
+static void CullTerrainQuadtreeNode(int level, long nodeRow, long nodeCol, int layer, const TerrainCullInfo* cull)
+{
+	const TerrainQuadtreeNode* node = &gTerrainQuadtree[level][nodeRow * gTerrainQuadtreeWidth[level] + nodeCol];
+
+			/* GET SUPERTILES COVERED BY THIS NODE */
+
+	long top	= nodeRow << level;
+	long left	= nodeCol << level;
+	long bottom	= SDL_min(top + (1L << level), gNumSuperTilesDeep);
+	long right	= SDL_min(left + (1L << level), gNumSuperTilesWide);
+
+	if (bottom <= cull->top || top >= cull->bottom
+		|| right <= cull->left || left >= cull->right)						// outside the area that can be built
+	{
+		return;
+	}
+
+	if (node->minY[layer] > node->maxY[layer])								// no geometry in this layer
+		return;
+
+			/* CHECK BOUNDING SPHERE OF THE NODE */
+
+	if (level > 0)
+	{
+		float halfX = (right - left) * (TERRAIN_SUPERTILE_UNIT_SIZE * 0.5f);
+		float halfZ = (bottom - top) * (TERRAIN_SUPERTILE_UNIT_SIZE * 0.5f);
+		float halfY = (node->maxY[layer] - node->minY[layer]) * 0.5f;
+
+		TQ3Point3D center =
+		{
+			left * TERRAIN_SUPERTILE_UNIT_SIZE + halfX,
+			node->minY[layer] + halfY,
+			top * TERRAIN_SUPERTILE_UNIT_SIZE + halfZ,
+		};
+		float radius = sqrtf(halfX*halfX + halfY*halfY + halfZ*halfZ);
+
+		if (!IsSphereInFrustum_XZ(&center, radius))
+			return;
+
+		if (cull->fogEndDistance > 0
+			&& IsSphereBeyondNearPlaneDepth(&center, radius, cull->fogEndDistance))
+		{
+			return;
+		}
+
+				/* RECURSE INTO CHILDREN */
+
+		long childWidth = gTerrainQuadtreeWidth[level-1];
+		long childDepth = gTerrainQuadtreeDepth[level-1];
+
+		for (int i = 0; i < 4; i++)
+		{
+			long childRow = nodeRow*2 + (i >> 1);
+			long childCol = nodeCol*2 + (i & 1);
+
+			if (childRow < childDepth && childCol < childWidth)
+				CullTerrainQuadtreeNode(level-1, childRow, childCol, layer, cull);
+		}
+		return;
+	}
+
+			/* LEAF: DRAW THE SUPERTILE IF IT'S BUILT */
+
+	int32_t superTileNum = gTerrainScrollBuffer[nodeRow][nodeCol];
+
+	if (superTileNum == EMPTY_SUPERTILE)
+		return;
+
+	const SuperTileMemoryType* superTile = &gSuperTileMemoryList[superTileNum];
+
+	if (superTile->mode != SUPERTILE_MODE_USED)
+		return;
+
+	if (!gPrimingTerrain && !Render_IsTextureUploadDone(superTile->textureUploadTicket))	// texture still waiting in the upload queue
+		return;
+
+	if (!IsSuperTileVisible(superTileNum, layer))						// make sure it's visible
+		return;
+
+	if (cull->fogEndDistance > 0
+		&& IsSphereBeyondNearPlaneDepth(&superTile->coord[layer], superTile->radius[layer], cull->fogEndDistance))
+	{
+		return;
+	}
+
+	SubmitSuperTile(superTileNum, layer, &cull->cameraCoord);
+}
+
+
+/***************** SUBMIT SUPERTILE ******************/
+//
+// Picks the texture LOD for a visible supertile and submits its trimesh for drawing.
+//
+
+static void SubmitSuperTile(int32_t superTileNum, int layer, const TQ3Point3D* cameraCoord)
+{
+	SuperTileMemoryType* superTile = &gSuperTileMemoryList[superTileNum];
+	int lod = 0;
+
+	if (gTerrainTextureDetail == SUPERTILE_DETAIL_PROGRESSIVE)	// the only detail level with 3 LODs
+	{
+				/* SEE WHICH LOD TO USE */
+
+		TQ3Point3D tileCoord = superTile->coord[layer];			// get x & z coords of tile
+		float dist = CalcQuickDistance(cameraCoord->x, cameraCoord->z, tileCoord.x, tileCoord.z);
+
+		if (dist < 1300.0f)
+			lod = 0;
+		else if (dist < 1700.0f)
+			lod = 1;
+		else
+			lod = 2;
+
+				/* MAKE SURE THE LOD IS BUILT */
+
+		if (!superTile->hasLOD[lod])
+		{
+			GAME_ASSERT(lod != 0);	// can't build LOD 0 like that
+
+			for (int lodToBuild = 0; lodToBuild <= lod; lodToBuild++)	// any LOD requires all of the inferior LODs to be built
+			{
+				if (!superTile->hasLOD[lodToBuild])
+					BuildSuperTileLOD(superTile, lodToBuild);
+			}
+		}
+	}
+
+				/* USE LOD TEXTURE */
+
+	superTile->triMeshDataPtrs[layer]->glTextureName = superTile->glTextureName[layer][lod];
+
+				/* SUBMIT FOR DRAWING */
+
+	Render_SubmitMesh(superTile->triMeshDataPtrs[layer], nil, &gTerrainRenderMods, &superTile->coord[layer]);
+}
+
+
 /***************** GET TERRAIN HEIGHT AT COORD ******************/
 //
 // Given a world x/z coord, return the y coord based on height map
@@ -1680,48 +2253,185 @@ TQ3Vector2D	look;
 
 
 		// NOTE: DO VERTICAL FIRST!!!!
+		//
+		// If the camera moved by more than one supertile since the last frame (fast vehicles,
+		// frame hitches), scroll one row/col at a time until we've caught up.
+		//
 
 				/* SEE IF SCROLLED UP */
 
-	if (superRow > gCurrentSuperTileRow)
+	while (superRow > gCurrentSuperTileRow)
 	{
-		if (superRow > (gCurrentSuperTileRow+1))						// check for overload scroll
-			DoFatalAlert("DoMyTerrainUpdate: scrolled up > 1 tile!");
-		ScrollTerrainUp(superRow,superCol);
-		gCurrentSuperTileRow = superRow;
+		ScrollTerrainUp(gCurrentSuperTileRow+1, superCol);
+		gCurrentSuperTileRow++;
 	}
-	else
+
 				/* SEE IF SCROLLED DOWN */
 
-	if (superRow < gCurrentSuperTileRow)
+	while (superRow < gCurrentSuperTileRow)
 	{
-		if (superRow < (gCurrentSuperTileRow-1))						// check for overload scroll
-			DoFatalAlert("DoMyTerrainUpdate: scrolled down < -1 tile!");
-		ScrollTerrainDown(superRow,superCol);
-		gCurrentSuperTileRow = superRow;
+		ScrollTerrainDown(gCurrentSuperTileRow-1, superCol);
+		gCurrentSuperTileRow--;
 	}
 
 			/* SEE IF SCROLLED LEFT */
 
-	if (superCol > gCurrentSuperTileCol)
+	while (superCol > gCurrentSuperTileCol)
 	{
-		if (superCol > (gCurrentSuperTileCol+1))						// check for overload scroll
-			DoFatalAlert("DoMyTerrainUpdate: scrolled left > 1 tile!");
-		ScrollTerrainLeft();
+		ScrollTerrainLeft();											// increments gCurrentSuperTileCol
 	}
-	else
+
 				/* SEE IF SCROLLED RIGHT */
 
-	if (superCol < gCurrentSuperTileCol)
+	while (superCol < gCurrentSuperTileCol)
 	{
-		if (superCol < (gCurrentSuperTileCol-1))						// check for overload scroll
-			DoFatalAlert("DoMyTerrainUpdate: scrolled right < -1 tile!");
-		ScrollTerrainRight(superCol,superRow,tileCol,tileRow);
-		gCurrentSuperTileCol = superCol;
+		long newCol = gCurrentSuperTileCol-1;
+		ScrollTerrainRight(newCol, gCurrentSuperTileRow, newCol*SUPERTILE_SIZE, gCurrentSuperTileRow*SUPERTILE_SIZE);
+		gCurrentSuperTileCol = newCol;
 	}
 
 	CalcNewItemDeleteWindow();							// recalc item delete window
 
+
+			/* BUILD SUPERTILES AHEAD OF THE CAMERA */
+
+	TQ3Point3D cameraCoord = gGameViewInfoPtr->currentCameraCoords;
+
+	if (gHasPrevStreamCameraCoord)
+		PrefetchSuperTiles(cameraCoord.x - gPrevStreamCameraCoord.x, cameraCoord.z - gPrevStreamCameraCoord.z);
+
+	gPrevStreamCameraCoord = cameraCoord;
+	gHasPrevStreamCameraCoord = true;
+}
+
+
+/****************** PREFETCH SUPERTILES ********************/
+//
+// Predicts where the active area will be shortly from the camera's velocity,
+// and builds the row/col of supertiles that is about to scroll on before it's needed.
+// When the active area does get there, the scroll routines find these supertiles
+// already in the scroll buffer and skip building them.
+//
+// Building stops once the per-frame time budget is exhausted; whatever's left is
+// picked up on the next frames (or built on the spot by the scroll routines if we run late).
+//
+// INPUT: dx/dz = camera movement since last frame
+//
+
+static void PrefetchSuperTiles(float dx, float dz)
+{
+long	predictedRow, predictedCol, dummy1, dummy2;
+long	prefetchRow = -1, prefetchCol = -1;
+
+	ReleaseStalePrefetchedSuperTiles();
+
+	if (gPrimingTerrain)										// don't bother while priming
+		return;
+
+			/* PREDICT ACTIVE AREA FROM CAMERA VELOCITY */
+
+	float lookahead = PREFETCH_LOOKAHEAD_TIME * gFramesPerSecond;		// # frames to look ahead
+
+	float x = gCurrentSuperTileCol * TERRAIN_SUPERTILE_UNIT_SIZE + TERRAIN_SUPERTILE_UNIT_SIZE/2 + dx * lookahead;
+	float z = gCurrentSuperTileRow * TERRAIN_SUPERTILE_UNIT_SIZE + TERRAIN_SUPERTILE_UNIT_SIZE/2 + dz * lookahead;
+
+	GetSuperTileInfo(x, z, &predictedCol, &predictedRow, &dummy1, &dummy2);
+
+	if (predictedRow > gCurrentSuperTileRow)						// heading to bottom rows
+		prefetchRow = gCurrentSuperTileRow + SUPERTILE_DIST_DEEP;
+	else if (predictedRow < gCurrentSuperTileRow)					// heading to top rows
+		prefetchRow = gCurrentSuperTileRow - 1;
+
+	if (predictedCol > gCurrentSuperTileCol)						// heading to right cols
+		prefetchCol = gCurrentSuperTileCol + SUPERTILE_DIST_WIDE;
+	else if (predictedCol < gCurrentSuperTileCol)					// heading to left cols
+		prefetchCol = gCurrentSuperTileCol - 1;
+
+	if (prefetchRow < 0 && prefetchCol < 0)							// not moving across supertiles (or heading off map)
+		return;
+
+
+			/* BUILD WITHIN TIME BUDGET */
+
+	const Uint64 startTime = SDL_GetPerformanceCounter();
+	const Uint64 timeBudget = (Uint64) (SDL_GetPerformanceFrequency() * (PREFETCH_TIME_BUDGET_MS / 1000.0f));
+
+	for (int i = 0; i < SUPERTILE_DIST_WIDE + SUPERTILE_DIST_DEEP; i++)
+	{
+		long row, col;
+
+		if (i < SUPERTILE_DIST_WIDE)								// first, the row along the active area's width...
+		{
+			row = prefetchRow;
+			col = gCurrentSuperTileCol + i;
+		}
+		else														// ...then the col along its depth
+		{
+			row = gCurrentSuperTileRow + (i - SUPERTILE_DIST_WIDE);
+			col = prefetchCol;
+		}
+
+		if (row < 0 || row >= gNumSuperTilesDeep ||				// see if off map
+			col < 0 || col >= gNumSuperTilesWide)
+			continue;
+
+		if (gTerrainScrollBuffer[row][col] != EMPTY_SUPERTILE)		// already built
+			continue;
+
+		if (gNumFreeSupertiles <= 0 || gNumPrefetchedSuperTiles >= MAX_PREFETCHED_SUPERTILES)
+			break;
+
+		if (SDL_GetPerformanceCounter() - startTime > timeBudget)	// out of time for this frame
+			break;
+
+		gTerrainScrollBuffer[row][col] = BuildTerrainSuperTile(col * SUPERTILE_SIZE, row * SUPERTILE_SIZE);
+
+		gPrefetchedSuperTiles[gNumPrefetchedSuperTiles].row = row;
+		gPrefetchedSuperTiles[gNumPrefetchedSuperTiles].col = col;
+		gNumPrefetchedSuperTiles++;
+	}
+}
+
+
+/************** RELEASE STALE PREFETCHED SUPERTILES *****************/
+//
+// Prefetched supertiles that have scrolled into the active area are now owned by it
+// (the scroll routines will release them when they scroll off).
+// The ones that the camera turned away from are released here.
+//
+
+static void ReleaseStalePrefetchedSuperTiles(void)
+{
+	int i = 0;
+
+	while (i < gNumPrefetchedSuperTiles)
+	{
+		long row = gPrefetchedSuperTiles[i].row;
+		long col = gPrefetchedSuperTiles[i].col;
+		Boolean forget = false;
+
+		if (gTerrainScrollBuffer[row][col] == EMPTY_SUPERTILE)		// the active area scrolled over it and released it already
+		{
+			forget = true;
+		}
+		else if (row >= gCurrentSuperTileRow && row < gCurrentSuperTileRow + SUPERTILE_DIST_DEEP &&
+				col >= gCurrentSuperTileCol && col < gCurrentSuperTileCol + SUPERTILE_DIST_WIDE)
+		{
+			forget = true;											// it's in the active area now
+		}
+		else if (row < gCurrentSuperTileRow - 1 || row > gCurrentSuperTileRow + SUPERTILE_DIST_DEEP ||
+				col < gCurrentSuperTileCol - 1 || col > gCurrentSuperTileCol + SUPERTILE_DIST_WIDE)
+		{
+			ReleaseSuperTileObject(gTerrainScrollBuffer[row][col]);	// it's no longer next to the active area
+			gTerrainScrollBuffer[row][col] = EMPTY_SUPERTILE;
+			forget = true;
+		}
+
+		if (forget)
+			gPrefetchedSuperTiles[i] = gPrefetchedSuperTiles[--gNumPrefetchedSuperTiles];	// swap with last
+		else
+			i++;
+	}
 }
 
 
@@ -1773,8 +2483,6 @@ long	col,i,bottom,left,right;
 int32_t	superTileNum;
 long	tileRow,tileCol;
 
-	gHiccupEliminator = 0;															// reset this when about to make a new row/col of supertiles
-
 			/* PURGE OLD TOP ROW */
 
 	if ((gCurrentSuperTileRow < gNumSuperTilesDeep) && (gCurrentSuperTileRow >= 0))	// check if off map
@@ -1867,8 +2575,6 @@ long	col,i,row,top,left,right;
 int32_t	superTileNum;
 long	tileRow,tileCol;
 
-	gHiccupEliminator = 0;															// reset this when about to make a new row/col of supertiles
-
 			/* PURGE OLD BOTTOM ROW */
 
 	row = gCurrentSuperTileRow+SUPERTILE_DIST_DEEP-1;						// calc supertile row # for bottom row
@@ -1964,8 +2670,6 @@ int32_t	superTileNum;
 long 	tileCol,tileRow,newSuperCol;
 long	bottomRow;
 
-	gHiccupEliminator = 0;															// reset this when about to make a new row/col of supertiles
-
 	bottomRow = gCurrentSuperTileRow + SUPERTILE_DIST_DEEP;								// calc bottom row (+1)
 
 
@@ -2055,8 +2759,6 @@ long	col,i,row;
 int32_t	superTileNum;
 long	top,bottom,left;
 
-	gHiccupEliminator = 0;															// reset this when about to make a new row/col of supertiles
-
 			/* PURGE OLD RIGHT ROW */
 
 	col = gCurrentSuperTileCol+SUPERTILE_DIST_WIDE-1;						// calc supertile col # for right col
@@ -2141,7 +2843,7 @@ void PrimeInitialTerrain(Boolean justReset)
 {
 long	i,w;
 
-	gDisableHiccupTimer = true;
+	gPrimingTerrain = true;
 	
 			/* PRIME OTHER STUFF */
 			